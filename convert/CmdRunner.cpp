@@ -0,0 +1,123 @@
+#include <glog/logging.h>
+
+#include <memory>
+
+#include "clang/Tooling/Tooling.h"
+
+#include "Config.h"
+#include "ConvertAction.h"
+#include "ConvertCache.h"
+#include "EnvUpdater.h"
+#include "LogicParser.h"
+#include "ParallelRunner.h"
+#include "CmdRunner.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+using clang::tooling::ClangTool;
+using clang::tooling::newFrontendActionFactory;
+
+void CmdRunner::prepare_pch(const std::string& sample_source) {
+  auto config = GlobalConfig::Instance();
+  if (config->pch_header.size() == 0) {
+    return;
+  }
+
+  // 公共头文件只解析一次，之后每个源文件直接加载预编译头。
+  if (pch_manager_ == nullptr) {
+    pch_manager_ = std::make_unique<PchManager>(compilations_, config->pch_header, config->pch_dir);
+  }
+
+  if (auto pch_filename = pch_manager_->prepare(sample_source)) {
+    pch_adjuster_ = PchManager::get_include_pch_adjuster(*pch_filename);
+  } else {
+    pch_adjuster_ = nullptr;
+  }
+}
+
+int CmdRunner::run_convert(const std::vector<std::string>& all_source_paths, json* field_output) {
+  auto config = GlobalConfig::Instance();
+  auto cache = ConvertCache::Instance();
+  config->clear_emission_claims();
+  cache->clear_cache_hits();
+
+  // 依赖没有变化的源文件直接跳过，字段信息从缓存中获取。
+  std::vector<std::string> source_paths;
+  size_t cached_count = 0;
+  for (const std::string& path : all_source_paths) {
+    std::string abs_path = ConvertCache::to_absolute_path(path);
+    std::vector<std::string> command_line;
+    for (const auto& command : compilations_.getCompileCommands(path)) {
+      command_line.insert(command_line.end(), command.CommandLine.begin(), command.CommandLine.end());
+    }
+    cache->set_compile_command(abs_path, command_line);
+
+    if (cache->use_cached_file(abs_path)) {
+      cached_count++;
+    } else {
+      source_paths.push_back(path);
+    }
+  }
+  LOG(INFO) << "source files: " << all_source_paths.size()
+            << ", skipped by cache: " << cached_count;
+
+  int ret = 0;
+  if (config->jobs != 1) {
+    ParallelRunner runner(compilations_, source_paths, config->jobs);
+    if (pch_adjuster_) {
+      runner.append_arguments_adjuster(pch_adjuster_);
+    }
+    ret = runner.run(newFrontendActionFactory<ConvertAction>().get());
+    *field_output = runner.merge_field_output();
+  } else {
+    ClangTool convert_tool(compilations_, source_paths);
+    if (pch_adjuster_) {
+      convert_tool.appendArgumentsAdjuster(pch_adjuster_);
+    }
+    ret = convert_tool.run(newFrontendActionFactory<ConvertAction>().get());
+    *field_output = ConvertAction::gen_field_output();
+  }
+
+  // 跳过的源文件中的类以及解析时直接使用缓存的类。
+  json cached_output = cache->cached_field_output();
+  for (auto it = cached_output.begin(); it != cached_output.end(); it++) {
+    if (!field_output->contains(it.key())) {
+      (*field_output)[it.key()] = it.value();
+    }
+  }
+
+  cache->save();
+  EnvUpdaterStats::log();
+
+  if (config->check_env_updater_gate && EnvUpdaterStats::missed() > 0) {
+    LOG(ERROR) << "check env updater gate failed, missed: " << EnvUpdaterStats::missed();
+    ret = 1;
+  }
+
+  return ret;
+}
+
+int CmdRunner::run_parse_logic(const std::vector<std::string>& source_paths) {
+  auto config = GlobalConfig::Instance();
+  config->clear_emission_claims();
+
+  if (config->jobs != 1) {
+    ParallelRunner runner(compilations_, source_paths, config->jobs);
+    if (pch_adjuster_) {
+      runner.append_arguments_adjuster(pch_adjuster_);
+    }
+    return runner.run(newFrontendActionFactory<LogicParser>().get());
+  }
+
+  ClangTool logic_tool(compilations_, source_paths);
+  if (pch_adjuster_) {
+    logic_tool.appendArgumentsAdjuster(pch_adjuster_);
+  }
+  return logic_tool.run(newFrontendActionFactory<LogicParser>().get());
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
+
+#include "PchManager.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+using nlohmann::json;
+
+/// 执行 convert 和 parse_logic 命令。
+///
+/// 根据 `GlobalConfig` 中的参数决定是否使用预编译头、增量缓存以及多线程。命令行和 serve 模式共用。
+class CmdRunner {
+ public:
+  explicit CmdRunner(const clang::tooling::CompilationDatabase& compilations): compilations_(compilations) {}
+
+  /// 生成或者复用预编译头，之后的每个 `ClangTool` 都会加载预编译头。重复调用时只有编译参数或者
+  /// `--pch-header` 变化才会重新检查，见 `PchManager`。
+  void prepare_pch(const std::string& sample_source);
+
+  /// 改写特征，field_output 为所有特征的字段信息，包括从缓存中获取的。
+  int run_convert(const std::vector<std::string>& source_paths, json* field_output);
+
+  /// 解析 BS 特征逻辑。
+  int run_parse_logic(const std::vector<std::string>& source_paths);
+
+ private:
+  const clang::tooling::CompilationDatabase& compilations_;
+  std::unique_ptr<PchManager> pch_manager_;
+  clang::tooling::ArgumentsAdjuster pch_adjuster_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
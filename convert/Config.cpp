@@ -4,8 +4,13 @@ namespace ks {
 namespace ad_algorithm {
 namespace convert {
 
+thread_local std::unordered_map<std::string, FeatureInfo> GlobalConfig::feature_info;
+thread_local std::unordered_map<std::string, std::string> GlobalConfig::infer_filter_funcs;
+thread_local bool GlobalConfig::rewrite_reco_user_info = false;
+thread_local std::set<std::string> GlobalConfig::cur_file_features;
+thread_local std::set<std::string> GlobalConfig::cur_file_cached_features;
+
 FeatureInfo* GlobalConfig::feature_info_ptr(const std::string& feature_name) {
-  std::lock_guard<std::mutex> lock(mu);
   auto it = feature_info.find(feature_name);
   if (it != feature_info.end()) {
     return &(it->second);
@@ -15,6 +20,24 @@ FeatureInfo* GlobalConfig::feature_info_ptr(const std::string& feature_name) {
   return &(it->second);
 }
 
+void GlobalConfig::clear_thread_state() {
+  feature_info.clear();
+  infer_filter_funcs.clear();
+  rewrite_reco_user_info = false;
+  cur_file_features.clear();
+  cur_file_cached_features.clear();
+}
+
+bool GlobalConfig::claim_emission(const std::string& name) {
+  std::lock_guard<std::mutex> lock(emission_mutex_);
+  return emitted_names_.insert(name).second;
+}
+
+void GlobalConfig::clear_emission_claims() {
+  std::lock_guard<std::mutex> lock(emission_mutex_);
+  emitted_names_.clear();
+}
+
 }  // namespace convert
 }  // namespace ad_algorithm
 }  // namespace ks
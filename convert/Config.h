@@ -7,10 +7,10 @@
 #include <algorithm>
 #include <iostream>
 #include <list>
-#include <mutex>
 #include <set>
 #include <sstream>
 #include <map>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -45,9 +45,9 @@ class GlobalConfig final {
     return &instance;
   }
 
+  /// 返回当前线程中的 `FeatureInfo`，不存在则创建。
   FeatureInfo* feature_info_ptr(const std::string& feature_name);
 
-  std::mutex mu;
   clang::FileID file_id;
   clang::SourceManager* source_manager = nullptr;
 
@@ -59,9 +59,28 @@ class GlobalConfig final {
   std::string message_def_filename;
   std::string field_detail_filename;
   bool use_reco_user_info = false;
-  bool rewrite_reco_user_info = false;
 
-  std::string middle_node_json_file = "data/middle_node.json";
+  /// 并行处理的线程数，默认为 1，即所有源文件在一个 `ClangTool` 中顺序处理。0 表示使用所有核。
+  int jobs = 1;
+
+  /// 增量转换的缓存文件，为空表示不使用缓存。
+  std::string cache_filename;
+
+  /// 只遍历路径中包含以下任意一个的文件，以及主文件。为空表示遍历所有文件。
+  std::vector<std::string> allowed_paths;
+
+  /// 用于生成预编译头的公共头文件，为空表示不使用预编译头。
+  std::string pch_header;
+  std::string pch_dir;
+
+  /// EditLedger 默认只检查编辑范围的交叉，打开后还会读取改写后的内容，检查范围完全相同的替换是否丢掉了
+  /// 之前的改写。只用于调试，默认关闭。
+  bool check_rewrite_conflict = false;
+
+  /// 是否检查 classify_expr 跳过的 update_env_* 确实不修改 Env，只用于调试，默认关闭。
+  ///
+  /// 开启后所有 update_env_* 都会执行，结果与不跳过时相同，跳过的 update_env_* 修改了 Env 时输出错误。
+  bool check_env_updater_gate = false;
 
   json all_adlog_fields = json::object();
   json feature_def = json::object();
@@ -73,10 +92,37 @@ class GlobalConfig final {
     "teams/ad/ad_algorithm/feature/fast/impl/feature_list_complete_adlog.cc";
   std::map<std::string, std::string> feature_filename_map;
   std::map<std::string, std::string> feature_content_map;
-  std::unordered_map<std::string, FeatureInfo> feature_info;
+
+  /// 以下是解析过程中的状态，每个线程单独一份，多线程处理时互不影响，不需要加锁。
+  static thread_local std::unordered_map<std::string, FeatureInfo> feature_info;
 
   /// infer filter 函数实现，暂时先用 map 简单处理，后面再重构。
-  std::unordered_map<std::string, std::string> infer_filter_funcs;
+  static thread_local std::unordered_map<std::string, std::string> infer_filter_funcs;
+
+  /// reco_user_info 需要分两次改写，用于区分当前是哪一次。
+  static thread_local bool rewrite_reco_user_info;
+
+  /// 当前源文件中定义的类，源文件处理结束时只写入这些类的结果。
+  static thread_local std::set<std::string> cur_file_features;
+
+  /// 当前源文件中直接使用缓存结果的类，见 `ConvertCache::use_cached_feature`。
+  static thread_local std::set<std::string> cur_file_cached_features;
+
+  /// 清空当前线程的解析状态。
+  static void clear_thread_state();
+
+  /// 认领类或者文件改写结果的写入，name 是类名或者文件名，返回 false 表示已经被其他源文件写入过。
+  ///
+  /// 多线程处理时每个线程的 `is_emitted` 是单独的，公共头文件中的类会被多个线程改写，需要在写文件前
+  /// 在整个进程范围内认领，保证只写一次。
+  bool claim_emission(const std::string& name);
+
+  /// 每次转换开始前清空。
+  void clear_emission_claims();
+
+ private:
+  std::mutex emission_mutex_;
+  std::set<std::string> emitted_names_;
 };
 
 }  // namespace convert
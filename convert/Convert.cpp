@@ -1,5 +1,6 @@
 #include <glog/logging.h>
 #include <gflags/gflags.h>
+#include <absl/strings/str_split.h>
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
@@ -18,14 +19,19 @@
 #include <string>
 #include <sstream>
 #include <list>
+#include <memory>
 #include <algorithm>
 
 #include "ConvertAction.h"
+#include "ConvertCache.h"
 #include "LogicParser.h"
+#include "CmdRunner.h"
+#include "ConvertServer.h"
 
 using namespace llvm;
 using namespace clang;
 using namespace clang::tooling;
+using nlohmann::json;
 
 static llvm::cl::OptionCategory MatcherCategory("Matcher");
 
@@ -62,17 +68,64 @@ cl::opt<bool> UseRecoUserInfo("use_reco_user_info",
                              cl::desc("use reco user info"),
                              cl::init(false));
 
+cl::opt<std::string> CacheFilename("cache-filename",
+                                   cl::desc("cache file for incremental convert, empty means no cache"),
+                                   cl::init(""));
+
+cl::opt<std::string> AllowedPaths("allowed-paths",
+                                  cl::desc("comma separated path fragments to traverse besides main file, "
+                                           "a file is traversed if its path contains any of them, "
+                                           "empty means all files"),
+                                  cl::init("teams/ad/ad_algorithm/feature/fast/impl/,"
+                                           "teams/ad/ad_algorithm/bs_feature/fast/impl/,"
+                                           "teams/ad/ad_nn/utils/item_filter.h"));
+
+cl::opt<std::string> PchHeader("pch-header",
+                               cl::desc("header including the common headers of all features, "
+                                        "used to build precompiled header, empty means no pch"),
+                               cl::init(""));
+
+cl::opt<std::string> PchDir("pch-dir",
+                            cl::desc("dir to save precompiled header, reused across runs"),
+                            cl::init(".convert_pch"));
+
+cl::opt<bool> CheckRewriteConflict("check-rewrite-conflict",
+                                   cl::desc("also check same-range rewrite conflicts, for debug, default false"),
+                                   cl::init(false));
+
+cl::opt<bool> CheckEnvUpdaterGate("check-env-updater-gate",
+                                  cl::desc("run every update_env_* and log the ones skipped by the gate "
+                                           "that change env, for debug, default false"),
+                                  cl::init(false));
+
+cl::opt<std::string> SocketPath("socket-path",
+                                cl::desc("unix socket path for --cmd=serve"),
+                                cl::init("/tmp/convert.sock"));
+
+cl::opt<std::string> CompileCommandsDir("compile-commands-dir",
+                                        cl::desc("dir of compile_commands.json for --cmd=serve "
+                                                 "without source files, default current dir"),
+                                        cl::init("."));
+
+cl::opt<int> Jobs("j",
+                  cl::desc("number of threads to process source files, 0 means all cores, default 1"),
+                  cl::init(1));
+
 DECLARE_bool(logtostderr);
 
 using ks::ad_algorithm::convert::GlobalConfig;
 using ks::ad_algorithm::convert::ConvertAction;
+using ks::ad_algorithm::convert::ConvertCache;
 using ks::ad_algorithm::convert::LogicParser;
+using ks::ad_algorithm::convert::CmdRunner;
+using ks::ad_algorithm::convert::ConvertServer;
 
 int main(int argc, const char **argv) {
   google::InitGoogleLogging(argv[0]);
   FLAGS_logtostderr = 1;
 
-  auto ExpectedParser = CommonOptionsParser::create(argc, argv, MatcherCategory);
+  // serve 的源文件在请求中给出，命令行中可以没有源文件。
+  auto ExpectedParser = CommonOptionsParser::create(argc, argv, MatcherCategory, llvm::cl::ZeroOrMore);
   if (!ExpectedParser) {
     LOG(ERROR) << "ExpectedParser error, return";
     return 1;
@@ -87,18 +140,61 @@ int main(int argc, const char **argv) {
   config->field_detail_filename = FieldDetailFilename;
   config->message_def_filename = MessageDefFilename;
   config->use_reco_user_info = UseRecoUserInfo;
+  config->jobs = Jobs;
+  config->cache_filename = CacheFilename;
+  config->allowed_paths = absl::StrSplit(AllowedPaths.getValue(), ',', absl::SkipEmpty());
+  config->pch_header = PchHeader;
+  config->pch_dir = PchDir;
+  config->check_rewrite_conflict = CheckRewriteConflict;
+  config->check_env_updater_gate = CheckEnvUpdaterGate;
 
   LOG(INFO) << "Cmd: " << config->cmd;
 
-  CommonOptionsParser& op = ExpectedParser.get();
-  ClangTool Tool(op.getCompilations(), op.getSourcePathList());
-
   if (config->cmd == "hello") {
     LOG(INFO) << "hello";
-  } else if (config->cmd == "convert") {
-    return Tool.run(newFrontendActionFactory<ConvertAction>().get());
+    return 0;
+  }
+
+  // 没有源文件时 CommonOptionsParser 不会加载编译数据库，serve 从 --compile-commands-dir 中加载。
+  CommonOptionsParser& op = ExpectedParser.get();
+  std::unique_ptr<CompilationDatabase> serve_compilations;
+  if (op.getSourcePathList().size() == 0) {
+    if (config->cmd != "serve") {
+      LOG(ERROR) << "missing source files, cmd: " << config->cmd;
+      return 1;
+    }
+
+    std::string err;
+    serve_compilations = CompilationDatabase::autoDetectFromDirectory(CompileCommandsDir, err);
+    if (serve_compilations == nullptr) {
+      LOG(ERROR) << "load compilation database failed, dir: " << CompileCommandsDir << ", err: " << err;
+      return 1;
+    }
+  }
+
+  CmdRunner cmd_runner(serve_compilations != nullptr ? *serve_compilations : op.getCompilations());
+
+  if (config->cache_filename.size() > 0) {
+    ConvertCache::Instance()->load(config->cache_filename);
+  }
+
+  // 预编译头只有解析源文件的命令才需要。serve 有源文件时在启动时生成，否则在第一个请求中生成，
+  // 之后的请求直接复用。
+  if ((config->cmd == "convert" || config->cmd == "parse_logic" || config->cmd == "serve") &&
+      op.getSourcePathList().size() > 0) {
+    cmd_runner.prepare_pch(op.getSourcePathList()[0]);
+  }
+
+  if (config->cmd == "convert") {
+    json field_output = json::object();
+    int ret = cmd_runner.run_convert(op.getSourcePathList(), &field_output);
+    ConvertAction::write_field_detail(field_output, config->field_detail_filename);
+    return ret;
   } else if (config->cmd == "parse_logic") {
-    return Tool.run(newFrontendActionFactory<LogicParser>().get());
+    return cmd_runner.run_parse_logic(op.getSourcePathList());
+  } else if (config->cmd == "serve") {
+    ConvertServer server(&cmd_runner, SocketPath);
+    return server.serve();
   } else {
     LOG(ERROR) << "unsupported cmd: " << config->cmd;
   }
@@ -3,10 +3,8 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
-#include <cstdlib>
 #include <fstream>
 #include <iostream>
-#include <regex>
 #include <sstream>
 
 // Declares clang::SyntaxOnlyAction.
@@ -26,11 +24,15 @@
 #include "clang/AST/ASTConsumer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/ADT/StringRef.h"
 
 #include "Tool.h"
+#include "ExprInfoArena.h"
+#include "TypeCategory.h"
 #include "info/FeatureInfo.h"
 #include "ConvertAction.h"
+#include "ConvertCache.h"
 #include "matcher_callback/InferFilterCallback.h"
 
 namespace ks {
@@ -60,11 +62,13 @@ ConvertASTConsumer::ConvertASTConsumer(clang::Rewriter &R) :
   rewriter_(R),
   type_alias_callback_(R),
   feature_decl_callback_(R),
-  infer_filter_callback_(R) {
+  infer_filter_callback_(R),
+  deferred_feature_decl_callback_(&feature_decl_callback_),
+  deferred_infer_filter_callback_(&infer_filter_callback_) {
   // 目前只能匹配到 typeAliasDecl(), 可能会有更好的匹配。
   auto TypeAliasMatcher = decl(typeAliasDecl(),
                                    namedDecl(matchesName("Extract.*"))).bind("TypeAlias");
-  type_alias_finder_.addMatcher(TypeAliasMatcher, &type_alias_callback_);
+  match_finder_.addMatcher(TypeAliasMatcher, &type_alias_callback_);
 
   // TK_IgnoreUnlessSpelledInSource 用来忽略模板
   auto FeatureDeclMatcher = traverse(TK_IgnoreUnlessSpelledInSource,
@@ -72,22 +76,25 @@ ConvertASTConsumer::ConvertASTConsumer(clang::Rewriter &R) :
                                                    unless(isExpandedFromMacro("DISALLOW_COPY_AND_ASSIGN")),
                                                    unless(isExpandedFromMacro("REGISTER_EXTRACTOR")))).bind("FeatureDecl");
 
-  match_finder_.addMatcher(FeatureDeclMatcher, &feature_decl_callback_);
+  match_finder_.addMatcher(FeatureDeclMatcher, &deferred_feature_decl_callback_);
 
   // infer filter
   auto InferFilterMatcher = cxxRecordDecl(hasName("ItemFilter")).bind("InferFilter");
-  infer_filter_finder_.addMatcher(InferFilterMatcher, &infer_filter_callback_);
+  match_finder_.addMatcher(InferFilterMatcher, &deferred_infer_filter_callback_);
 }
 
 void ConvertASTConsumer::HandleTranslationUnit(clang::ASTContext &Context) {
-  // 解析模板参数, 这一步必须在解析 Extract 之前, 因为这些参数会被用到。
-  type_alias_finder_.matchAST(Context);
+  // 只遍历特征相关文件中的 decl。
+  tool::restrict_traversal_scope(&Context, GlobalConfig::Instance()->allowed_paths);
 
-  // 解析 Extract 逻辑并进行改写。
+  // 只遍历一次 ast, 遍历时直接解析模板参数，Extract 和 infer filter 只保存匹配结果。
   match_finder_.matchAST(Context);
 
+  // 解析 Extract 逻辑并进行改写。模板参数在遍历时已经解析完，因此必须在遍历之后。
+  deferred_feature_decl_callback_.flush();
+
   // 处理 infer filter
-  infer_filter_finder_.matchAST(Context);
+  deferred_infer_filter_callback_.flush();
 }
 
 void ConvertAction::EndSourceFileAction() {
@@ -96,17 +103,28 @@ void ConvertAction::EndSourceFileAction() {
   handle_infer_filters();
   handle_item_filters();
   handle_label_extractor();
+
+  update_cache();
+
+  // 每个类只在定义它的第一个源文件中处理一次。
+  auto config = GlobalConfig::Instance();
+  for (const std::string& name : config->cur_file_features) {
+    config->feature_info_ptr(name)->set_is_emitted(true);
+  }
+  config->cur_file_features.clear();
+  config->cur_file_cached_features.clear();
 }
 
 void ConvertAction::handle_features() {
   auto config = GlobalConfig::Instance();
   {
-    std::lock_guard<std::mutex> lock(config->mu);
-
-    // 处理特征抽取类，依次执行处理逻辑。
+    // 处理当前源文件中的特征抽取类，依次执行处理逻辑。
     std::vector<std::string> paths;
-    for (auto it = config->feature_info.begin(); it != config->feature_info.end(); it++) {
-      const std::string& extractor_name = it->first;
+    for (const std::string& extractor_name : config->cur_file_features) {
+      auto it = config->feature_info.find(extractor_name);
+      if (it == config->feature_info.end()) {
+        continue;
+      }
 
       // 跳过 `ItemFilter` 类。
       if (extractor_name == "ItemFilter") {
@@ -122,14 +140,21 @@ void ConvertAction::handle_features() {
         continue;
       }
 
-      // 跳过已经改写过的文件。
+      // 跳过已经改写过的文件。没有生成的文件，字段信息仍然需要缓存。
       if (tool::is_bs_already_rewritten(origin_file)) {
         if (!config->overwrite) {
           LOG(INFO) << tool::get_bs_correspond_path(origin_file) << "already exists, skip";
+          feature_outputs_[extractor_name];
           continue;
         }
       }
 
+      // 公共头文件中的类可能同时被其他线程改写。
+      if (!config->claim_emission(extractor_name)) {
+        LOG(INFO) << "already emitted by other source file, skip! feature_name: " << extractor_name;
+        continue;
+      }
+
       paths.push_back(feature_info.origin_file());
 
       // 读取原始文件内容。
@@ -153,65 +178,118 @@ void ConvertAction::handle_features() {
         }
       }
 
-      // format
-      std::string cmd_format(
-          "clang-format "
-          "--style=\"{BasedOnStyle: Google, ColumnLimit: 110, IndentCaseLabels: true}\" -i ");  // NOLINT
-
-      // 写入到 .h 文件
-      std::error_code ec;
-      std::ofstream wfile(new_h_filename.c_str());
-      if (wfile.is_open()) {
-        wfile << header_content;
-      }
-      wfile.close();
-      std::system((cmd_format + new_h_filename).c_str());
+      // 格式化后写入到 .h 文件
+      tool::write_formatted_file(new_h_filename, header_content);
+      feature_outputs_[extractor_name].push_back(new_h_filename);
       LOG(INFO) << "convert done,  .h: " << new_h_filename;
 
       // 写入到 .cc 文件
       if (!feature_info.is_template()) {
-        std::string new_cc_filename = std::regex_replace(new_h_filename, std::regex("\\.h"), ".cc");
+        std::string new_cc_filename = tool::get_cc_filename(new_h_filename);
         write_cc_file(feature_info, new_h_filename, new_cc_filename, bs_extractor_name);
-        std::system((cmd_format + new_cc_filename).c_str());
+        feature_outputs_[extractor_name].push_back(new_cc_filename);
         LOG(INFO) << "convert done, .cc: " << new_cc_filename;
       }
     }
 
-    LOG(INFO) << "start write bs field";
-    json field_output = json::object();
-    for (auto it_feature = config->feature_info.begin(); it_feature != config->feature_info.end();
-         it_feature++) {
-      const std::string& extractor_name = it_feature->first;
-      FeatureInfo& feature_info = it_feature->second;
+    // 需要在 ast 释放之前生成字段信息，所有源文件处理完后统一写入。
+    for (const std::string& extractor_name : config->cur_file_features) {
+      auto it = config->feature_info.find(extractor_name);
+      if (it != config->feature_info.end()) {
+        it->second.gen_output();
+      }
+    }
+
+    LOG(INFO) << "done";
+  }
+}
 
-      feature_info.gen_output();
-      field_output[extractor_name] = feature_info.output();
+void ConvertAction::update_cache() {
+  auto cache = ConvertCache::Instance();
+  if (!cache->is_enabled() || dependency_collector_ == nullptr) {
+    return;
+  }
+
+  // 有编译错误时结果可能不完整，不能缓存。
+  if (getCompilerInstance().getDiagnostics().hasErrorOccurred()) {
+    LOG(INFO) << "has error, skip update cache, file: " << getCurrentFile().str();
+    return;
+  }
+
+  auto config = GlobalConfig::Instance();
+  std::string source_path = ConvertCache::to_absolute_path(getCurrentFile().str());
+
+  // 预编译头中的头文件不会出现在 dependency_collector_ 以及 include_graph_ 中, 预编译头重新生成后需要
+  // 使缓存失效。
+  const std::string& pch_filename = getCompilerInstance().getPreprocessorOpts().ImplicitPCHInclude;
+
+  // 其他源文件写入结果的类由其他源文件更新。
+  std::vector<std::string> features;
+  for (auto it = feature_outputs_.begin(); it != feature_outputs_.end(); it++) {
+    const FeatureInfo* feature_info = config->feature_info_ptr(it->first);
+    std::vector<std::string> feature_deps =
+      include_graph_.get_transitive_includes(ConvertCache::to_absolute_path(feature_info->origin_file()));
+    if (pch_filename.size() > 0) {
+      feature_deps.push_back(pch_filename);
     }
 
-    if (config->field_detail_filename.size() > 0) {
-      std::ofstream out_bs_fields(std::string("../data/") + config->field_detail_filename);
-      out_bs_fields << field_output.dump(4);
-      out_bs_fields.close();
-      LOG(INFO) << "write field to file: data/" << config->field_detail_filename;
-    } else {
-      LOG(INFO) << "field_detail_filename is empty!";
+    cache->update_feature(it->first, source_path, feature_deps, it->second, feature_info->output());
+    features.push_back(it->first);
+  }
+
+  features.insert(features.end(),
+                  config->cur_file_cached_features.begin(),
+                  config->cur_file_cached_features.end());
+
+  std::vector<std::string> deps;
+  for (const std::string& dep : dependency_collector_->getDependencies()) {
+    deps.push_back(ConvertCache::to_absolute_path(dep));
+  }
+
+  if (pch_filename.size() > 0) {
+    deps.push_back(pch_filename);
+  }
+
+  cache->update(source_path, deps, features);
+}
+
+json ConvertAction::gen_field_output() {
+  auto config = GlobalConfig::Instance();
+  json field_output = json::object();
+  for (auto it_feature = config->feature_info.begin(); it_feature != config->feature_info.end();
+       it_feature++) {
+    if (it_feature->second.is_emitted()) {
+      field_output[it_feature->first] = it_feature->second.output();
     }
+  }
 
-    LOG(INFO) << "done";
+  return field_output;
+}
+
+void ConvertAction::write_field_detail(const json& field_output, const std::string& field_detail_filename) {
+  if (field_detail_filename.size() > 0) {
+    std::ofstream out_bs_fields(std::string("../data/") + field_detail_filename);
+    out_bs_fields << field_output.dump(4);
+    out_bs_fields.close();
+    LOG(INFO) << "write field to file: data/" << field_detail_filename;
+  } else {
+    LOG(INFO) << "field_detail_filename is empty!";
   }
 }
 
 void ConvertAction::handle_infer_filters() {
   auto config = GlobalConfig::Instance();
   {
-    std::lock_guard<std::mutex> lock(config->mu);
-    std::vector<std::string> paths;
-    for (auto it = config->feature_info.begin(); it != config->feature_info.end(); it++) {
-      const std::string& extractor_name = it->first;
+    for (const std::string& extractor_name : config->cur_file_features) {
       if (extractor_name != "ItemFilter") {
         continue;
       }
 
+      auto it = config->feature_info.find(extractor_name);
+      if (it == config->feature_info.end()) {
+        continue;
+      }
+
       const FeatureInfo& feature_info = it->second;
 
       const std::string& origin_file = feature_info.origin_file();
@@ -220,6 +298,11 @@ void ConvertAction::handle_infer_filters() {
         continue;
       }
 
+      if (!config->claim_emission(extractor_name)) {
+        LOG(INFO) << "already emitted by other source file, skip! class_name: " << extractor_name;
+        continue;
+      }
+
       const clang::FileID& file_id = feature_info.file_id();
       std::string header_content;
       llvm::raw_string_ostream raw_string(header_content);
@@ -229,40 +312,28 @@ void ConvertAction::handle_infer_filters() {
       std::string new_h_filename = "teams/ad/ad_nn/utils/bs_item_filter_auto.h";
       std::string new_cc_filename = "teams/ad/ad_nn/utils/bs_item_filter_auto.cc";
 
-      // format
-      std::string cmd_format(
-          "clang-format "
-          "--style=\"{BasedOnStyle: Google, ColumnLimit: 110, IndentCaseLabels: true}\" -i ");
-
-      // 写入到 .h 文件
-      std::error_code ec;
-      std::ofstream wfile(new_h_filename.c_str());
-      if (wfile.is_open()) {
-        wfile << header_content;
-      }
-      wfile.close();
-      std::system((cmd_format + new_h_filename).c_str());
+      // 格式化后写入到 .h 文件
+      tool::write_formatted_file(new_h_filename, header_content);
+      feature_outputs_[extractor_name].push_back(new_h_filename);
       LOG(INFO) << "convert done,  .h: " << new_h_filename;
 
       // 写入到 .cc 文件
-      std::ofstream wfile_cc(new_cc_filename.c_str());
-      if (wfile_cc.is_open()) {
-        wfile_cc << "#include \"teams/ad/ad_nn/utils/bs_item_filter.h\"\n\n";
-        wfile_cc << "namespace ks {\nnamespace ad_nn {\n\n";
-
-        auto& infer_filter_funcs = config->infer_filter_funcs;
-        for (auto it_filter = infer_filter_funcs.begin(); it_filter != infer_filter_funcs.end();
-             it_filter++) {
-          wfile_cc << "bool BSItemFilter::" << it_filter->first
-                   << "(const SampleInterface& bs, const FilterCondition& filter_condition, size_t pos) "
-                   << replace_simple_infer_filter(it_filter->second)
-                   << "\n\n";
-        }
-
-        wfile_cc << "}  // namespace ad_nn\n}  // namespace ks";
+      std::ostringstream wfile_cc;
+      wfile_cc << "#include \"teams/ad/ad_nn/utils/bs_item_filter.h\"\n\n";
+      wfile_cc << "namespace ks {\nnamespace ad_nn {\n\n";
+
+      auto& infer_filter_funcs = config->infer_filter_funcs;
+      for (auto it_filter = infer_filter_funcs.begin(); it_filter != infer_filter_funcs.end();
+           it_filter++) {
+        wfile_cc << "bool BSItemFilter::" << it_filter->first
+                 << "(const SampleInterface& bs, const FilterCondition& filter_condition, size_t pos) "
+                 << replace_simple_infer_filter(it_filter->second)
+                 << "\n\n";
       }
-      wfile_cc.close();
-      std::system((cmd_format + new_cc_filename).c_str());
+
+      wfile_cc << "}  // namespace ad_nn\n}  // namespace ks";
+      tool::write_formatted_file(new_cc_filename, wfile_cc.str());
+      feature_outputs_[extractor_name].push_back(new_cc_filename);
       LOG(INFO) << "convert done,  .cc: " << new_cc_filename;
     }
     LOG(INFO) << "done";
@@ -277,129 +348,77 @@ void ConvertAction::write_cc_file(const FeatureInfo& feature_info,
                                   const std::string& new_h_filename,
                                   const std::string& new_cc_filename,
                                   const std::string& bs_extractor_name) {
-  std::ofstream wfile_cc(new_cc_filename.c_str());
+  std::ostringstream wfile_cc;
 
   const std::string &extract_method_content = feature_info.extract_method_content();
 
-  if (wfile_cc.is_open()) {
-    // 写入常见的头文件。
-    if (feature_info.has_hash_fn_str()) {
-      wfile_cc << "#include \"teams/ad/ad_nn/bs_field_helper/bs_field_helper.h\"\n";
-    }
-
-    if (feature_info.has_query_token()) {
-      wfile_cc << "#include \"teams/ad/ad_algorithm/bs_feature/fast/frame/bs_action_util.h\"\n";
-    }
+  // 写入常见的头文件。
+  if (feature_info.has_hash_fn_str()) {
+    wfile_cc << "#include \"teams/ad/ad_nn/bs_field_helper/bs_field_helper.h\"\n";
+  }
 
-    if (extract_method_content.find("std::move") != std::string::npos) {
-      wfile_cc << "#include <utility>\n";
-    }
+  if (feature_info.has_query_token()) {
+    wfile_cc << "#include \"teams/ad/ad_algorithm/bs_feature/fast/frame/bs_action_util.h\"\n";
+  }
 
-    if (extract_method_content.find("unordered_map") != std::string::npos) {
-      wfile_cc << "#include <unordered_map>\n";
-    }
+  if (extract_method_content.find("std::move") != std::string::npos) {
+    wfile_cc << "#include <utility>\n";
+  }
 
-    if (extract_method_content.find("unordered_set") != std::string::npos) {
-      wfile_cc << "#include <unordered_set>\n";
-    }
+  if (extract_method_content.find("unordered_map") != std::string::npos) {
+    wfile_cc << "#include <unordered_map>\n";
+  }
 
-    wfile_cc << "#include \"" << new_h_filename << "\"\n\n";
-    wfile_cc << "namespace ks {\nnamespace ad_algorithm {\n"
-             << bs_extractor_name << "::" << bs_extractor_name << "(): BS"
-             << feature_info.constructor_info().init_list() << "\n"
-             << tool::rm_empty_line(feature_info.constructor_info().body_content())
-             << "\n\n";
-
-    // `reco_user_info` 相关字段特殊处理，需要通过 `gflags` 参数区分逻辑。
-    if (const auto& reco_extract_body = feature_info.reco_extract_body()) {
-      wfile_cc << "void " << bs_extractor_name << "::ExtractWithBSRecoUserInfo("
-               << "const BSLog& bslog, size_t pos, std::vector<ExtractResult>* result) \n"
-               << tool::rm_empty_line(reco_extract_body.value()) << "\n";
-    }
+  if (extract_method_content.find("unordered_set") != std::string::npos) {
+    wfile_cc << "#include <unordered_set>\n";
+  }
 
-    // 写入主要的 `Extract` 方法。
-    wfile_cc << "void " << bs_extractor_name << "::Extract("
-             << "const BSLog& bslog, size_t pos, std::vector<ExtractResult>* "
-                "result) \n"
-             << tool::rm_empty_line(extract_method_content) << "\n";
-
-    // 写入其他函数。
-    const auto &other_methods = feature_info.other_methods();
-    for (auto it_method = other_methods.begin(); it_method != other_methods.end(); it_method++) {
-      wfile_cc << it_method->second.bs_return_type() << " "
-               << "BS" << feature_info.feature_name()
-               << "::" << it_method->second.decl() << it_method->second.body()
-               << "\n";
-    }
+  wfile_cc << "#include \"" << new_h_filename << "\"\n\n";
+  wfile_cc << "namespace ks {\nnamespace ad_algorithm {\n"
+           << bs_extractor_name << "::" << bs_extractor_name << "(): BS"
+           << feature_info.constructor_info().init_list() << "\n"
+           << tool::rm_empty_line(feature_info.constructor_info().body_content())
+           << "\n\n";
+
+  // `reco_user_info` 相关字段特殊处理，需要通过 `gflags` 参数区分逻辑。
+  if (const auto& reco_extract_body = feature_info.reco_extract_body()) {
+    wfile_cc << "void " << bs_extractor_name << "::ExtractWithBSRecoUserInfo("
+             << "const BSLog& bslog, size_t pos, std::vector<ExtractResult>* result) \n"
+             << tool::rm_empty_line(reco_extract_body.value()) << "\n";
+  }
 
-    wfile_cc << "}  // namespace ad_algorithm\n}  // namespace ks\n";
+  // 写入主要的 `Extract` 方法。
+  wfile_cc << "void " << bs_extractor_name << "::Extract("
+           << "const BSLog& bslog, size_t pos, std::vector<ExtractResult>* "
+              "result) \n"
+           << tool::rm_empty_line(extract_method_content) << "\n";
+
+  // 写入其他函数。
+  const auto &other_methods = feature_info.other_methods();
+  for (auto it_method = other_methods.begin(); it_method != other_methods.end(); it_method++) {
+    wfile_cc << it_method->second.bs_return_type() << " "
+             << "BS" << feature_info.feature_name()
+             << "::" << it_method->second.decl() << it_method->second.body()
+             << "\n";
   }
 
-  wfile_cc.close();
+  wfile_cc << "}  // namespace ad_algorithm\n}  // namespace ks\n";
+
+  tool::write_formatted_file(new_cc_filename, wfile_cc.str());
 }
 
 std::string ConvertAction::replace_simple(const std::string& content,
                                           const std::string& class_name) {
-  std::regex p_class_name(class_name);
-
-  static std::regex p_more_class("class (Extract.*) ?: ?public");
-  static std::regex p_empty_line("\n *;");
-  static std::regex p_colon(": *;");
-  static std::regex p_adlog("const AdLog ?\\& ?(adlog|ad_log)");
-  static std::regex p_fast_feature("FastFeature");
-  static std::regex p_register("REGISTER_EXTRACTOR");
-  static std::regex p_register_seq("REGISTER_SEQUENCE_EXTRACTOR");
-  static std::regex p_using("using Extract");
-  static std::regex p_extract_bs("EXTRACTOR\\(Extract");
-  static std::regex p_ad_callback_log("(::)?auto_cpp_rewriter::AdCallbackLog");
-  static std::regex p_name_extend_two("(::)?auto_cpp_rewriter::CommonInfoAttr");
-  // 必须放到 FastFeature 替换以后
-  static std::regex p_extract_multi("ExtractMultiAttrBSFastFeatureNoPrefix");
-  static std::regex p_tempalte_item_type("template ?<ItemType");
-
-  std::string s = std::regex_replace(content, p_class_name, std::string("BS") + class_name);
-  s = std::regex_replace(s, p_more_class, "class BS$1: public");
-  s = std::regex_replace(s, p_empty_line, "");
-  s = std::regex_replace(s, p_colon, ";");
-  s = std::regex_replace(s, p_adlog, "const BSLog& bslog");
-  s = std::regex_replace(s, p_fast_feature, "BSFastFeature");
-  s = std::regex_replace(s, p_register, "REGISTER_BS_EXTRACTOR");
-  s = std::regex_replace(s, p_register_seq, "REGISTER_BS_SEQUENCE_EXTRACTOR");
-  s = std::regex_replace(s, p_using, "using BSExtract");
-  s = std::regex_replace(s, p_extract_bs, "EXTRACTOR(BSExtract");
-  s = std::regex_replace(s, p_ad_callback_log, "::bs::auto_cpp_rewriter::AdCallbackLog");
-  s = std::regex_replace(s, p_name_extend_two, "::bs::auto_cpp_rewriter::CommonInfoAttr");
-  s = std::regex_replace(s, p_tempalte_item_type, "template<bs::ItemType");
-
-  if (s.find("ad::CommonInfoAttr") != std::string::npos) {
-    std::string last_include = tool::find_last_include(s);
-  }
-
-  s = std::regex_replace(s, p_extract_multi, "BSExtractMultiAttrFastFeatureNoPrefix");
-
-  s = tool::fix_std_string(s);
-
-  return s;
+  return tool::replace_feature_text(content, class_name);
 }
 
 std::string ConvertAction::replace_simple_infer_filter(const std::string& content) {
-  static std::regex p_item_filter("ItemFilter");
-  static std::regex p_enum_item("BSFieldEnum::item");
-  static std::regex p_bs("\\(\\*bs");
-  static std::regex p_static_inline("static inline bool");
-
-  std::string s = std::regex_replace(content, p_item_filter, std::string("BSItemFilter"));
-  s = std::regex_replace(s, p_enum_item, std::string("BSFieldEnum::adlog_item"));
-  s = std::regex_replace(s, p_bs, std::string("(bs"));
-  s = std::regex_replace(s, p_static_inline, std::string("static bool"));
-
-  return s;
+  return tool::replace_infer_filter_text(content);
 }
 
 std::string ConvertAction::insert_new_field_def(const std::string& header_content,
                                                 const FeatureInfo& feature_info) {
-  static std::regex p_private("private ?:");
-  std::smatch m;
+  static const tool::TextReplacer replacer({{"private ?:", ""}});
 
   std::ostringstream oss;
   oss << "private:\n  ";
@@ -414,10 +433,7 @@ std::string ConvertAction::insert_new_field_def(const std::string& header_conten
     }
   }
 
-  std::string s = std::regex_replace(header_content,
-                                     p_private,
-                                     oss.str(),
-                                     std::regex_constants::format_first_only);
+  std::string s = replacer.replace_first(header_content, oss.str());
 
   return s;
 }
@@ -425,6 +441,16 @@ std::string ConvertAction::insert_new_field_def(const std::string& header_conten
 std::unique_ptr<clang::ASTConsumer> ConvertAction::CreateASTConsumer(clang::CompilerInstance &CI,
                                                                      llvm::StringRef file) {
   rewriter_.setSourceMgr(CI.getSourceManager(), CI.getLangOpts());
+  clear_stmt_string_cache();
+  ExprInfoArena::clear_thread_arena();
+  TypeCategoryCache::clear();
+
+  // 收集源文件的头文件依赖以及包含关系，用于增量转换的缓存。
+  if (ConvertCache::Instance()->is_enabled()) {
+    dependency_collector_ = std::make_shared<clang::DependencyCollector>();
+    dependency_collector_->attachToPreprocessor(CI.getPreprocessor());
+    include_graph_.attach_to_preprocessor(CI.getPreprocessor());
+  }
 
   LOG(INFO) << "remove_comment: " << GlobalConfig::Instance()->remove_comment;
   if (GlobalConfig::Instance()->remove_comment) {
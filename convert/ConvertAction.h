@@ -6,6 +6,7 @@
 #include <set>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
@@ -22,13 +23,16 @@
 #include "clang/AST/ASTConsumer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/Utils.h"
 #include "llvm/ADT/StringRef.h"
 
 #include "Tool.h"
+#include "IncludeGraph.h"
 #include "info/FeatureInfo.h"
 #include "matcher_callback/FeatureDeclCallback.h"
 #include "matcher_callback/TypeAliasCallback.h"
 #include "matcher_callback/InferFilterCallback.h"
+#include "matcher_callback/DeferredCallback.h"
 
 namespace ks {
 namespace ad_algorithm {
@@ -55,9 +59,11 @@ class ConvertASTConsumer : public clang::ASTConsumer {
  private:
   clang::Rewriter& rewriter_;
 
-  /// 用于匹配 `FeatureDecl` 的 `MatchFinder`。
+  /// 匹配 `TypeAliasDecl`、`FeatureDecl` 和 `InferFilterDecl` 的 `MatchFinder`。
   ///
-  /// 所有的特征都继承自同一个基类 `FastFeature`，我们可以使用同一个 `MatchFinder` 来匹配所有的特征。
+  /// 三种 matcher 放在同一个 `MatchFinder` 中，只需要遍历一次 ast。
+  ///
+  /// 所有的特征都继承自同一个基类 `FastFeature`，我们可以使用同一个 matcher 来匹配所有的特征。
   ///
   /// 示例:
   /// ```cpp
@@ -65,17 +71,9 @@ class ConvertASTConsumer : public clang::ASTConsumer {
   ///   ...
   /// };
   /// ```
-  clang::ast_matchers::MatchFinder match_finder_;
-
-  /// 用于匹配 `TypeAliasDecl` 的 `MatchFinder`。
   ///
-  /// 用于匹配模板类型。
-  clang::ast_matchers::MatchFinder type_alias_finder_;
-
-  /// 用于匹配 `InferFilterDecl` 的 `MatchFinder`。
-  ///
-  /// 用于匹配 `filter` 类。
-  clang::ast_matchers::MatchFinder infer_filter_finder_;
+  /// `TypeAliasDecl` 用于匹配模板类型，`InferFilterDecl` 用于匹配 `filter` 类。
+  clang::ast_matchers::MatchFinder match_finder_;
 
   /// 用于在匹配上 `FeatureDecl` 后的处理。这是主要的逻辑处理类。
   FeatureDeclCallback feature_decl_callback_;
@@ -85,6 +83,12 @@ class ConvertASTConsumer : public clang::ASTConsumer {
 
   /// 用于在匹配上 `InferFilterDecl` 后的处理。
   InferFilterCallback infer_filter_callback_;
+
+  /// `FeatureDecl` 依赖 `TypeAliasDecl` 解析出的模板参数，需要等遍历结束后再处理。
+  DeferredCallback deferred_feature_decl_callback_;
+
+  /// 和之前保持一致，`InferFilterDecl` 在特征之后处理。
+  DeferredCallback deferred_infer_filter_callback_;
 };
 
 /// 处理逻辑。
@@ -108,12 +112,21 @@ class ConvertAction : public clang::ASTFrontendAction {
   /// 处理 `label_extractor` 类。
   void handle_label_extractor();
 
+  /// 将当前源文件中每个类的依赖、生成的文件以及字段信息，以及源文件的依赖更新到增量转换的缓存中。
+  void update_cache();
+
   /// 将改写的结果写入新的 `c++` 文件。
   void write_cc_file(const FeatureInfo &feature_info,
                      const std::string &new_h_filename,
                      const std::string &new_cc_filename,
                      const std::string &bs_extractor_name);
 
+  /// 当前线程中所有已处理的特征的字段信息。
+  static nlohmann::json gen_field_output();
+
+  /// 将所有特征的字段信息写入 `../data/<field_detail_filename>`。
+  static void write_field_detail(const nlohmann::json& field_output, const std::string& field_detail_filename);
+
   /// 替换简单的字符串。
   ///
   /// 用于替换固定的字符串代码，不涉及到复杂的 `ast` 节点。
@@ -154,6 +167,15 @@ class ConvertAction : public clang::ASTFrontendAction {
 
   /// 用于删除注释的处理器。
   RmComment* rm_comment_ = nullptr;
+
+  /// 源文件依赖的头文件，只在开启缓存时收集。
+  std::shared_ptr<clang::DependencyCollector> dependency_collector_;
+
+  /// 头文件之间的包含关系，只在开启缓存时收集，用于计算每个类的依赖。
+  IncludeGraph include_graph_;
+
+  /// 当前源文件中写入结果的类及其生成的文件。
+  std::map<std::string, std::vector<std::string>> feature_outputs_;
 };
 
 }  // namespace convert
@@ -0,0 +1,310 @@
+#include <glog/logging.h>
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "Config.h"
+#include "Tool.h"
+#include "ConvertCache.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+namespace {
+
+/// FNV-1a, 保证多次运行结果一致。
+std::string hash_string(const std::string& s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+
+  std::ostringstream oss;
+  oss << std::hex << h << "_" << std::dec << s.size();
+  return oss.str();
+}
+
+}  // namespace
+
+void ConvertCache::load(const std::string& filename) {
+  std::lock_guard<std::mutex> lock(mu_);
+
+  filename_ = filename;
+  data_ = {{"fingerprint", gen_fingerprint()}, {"files", json::object()}, {"features", json::object()}};
+
+  std::ifstream f(filename);
+  if (!f.is_open()) {
+    LOG(INFO) << "cache file not exists, start with empty cache, filename: " << filename;
+    return;
+  }
+
+  json old_data = json::parse(f, nullptr, false);
+  if (old_data.is_discarded() ||
+      !old_data.contains("fingerprint") ||
+      !old_data.contains("files") ||
+      !old_data.contains("features")) {
+    LOG(ERROR) << "parse cache file failed, ignore it, filename: " << filename;
+    return;
+  }
+
+  if (old_data["fingerprint"] != data_["fingerprint"]) {
+    LOG(INFO) << "fingerprint changed, ignore all cache, filename: " << filename;
+    return;
+  }
+
+  data_["files"] = std::move(old_data["files"]);
+  data_["features"] = std::move(old_data["features"]);
+  LOG(INFO) << "load cache done, files: " << data_["files"].size()
+            << ", features: " << data_["features"].size();
+}
+
+bool ConvertCache::save() {
+  if (!is_enabled()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+
+  std::ofstream f(filename_);
+  if (!f.is_open()) {
+    LOG(ERROR) << "open cache file failed, filename: " << filename_;
+    return false;
+  }
+
+  f << data_.dump(2);
+  LOG(INFO) << "save cache done, filename: " << filename_
+            << ", files: " << data_["files"].size()
+            << ", features: " << data_["features"].size();
+
+  return true;
+}
+
+bool ConvertCache::contains(const std::string& source_path) {
+  std::lock_guard<std::mutex> lock(mu_);
+  return data_["files"].contains(source_path);
+}
+
+void ConvertCache::set_compile_command(const std::string& source_path,
+                                       const std::vector<std::string>& command_line) {
+  std::ostringstream oss;
+  for (const std::string& arg : command_line) {
+    oss << arg << '\0';
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  command_hashes_[source_path] = hash_string(oss.str());
+}
+
+bool ConvertCache::use_cached_file(const std::string& source_path) {
+  if (!is_enabled()) {
+    return false;
+  }
+
+  json entry;
+  std::string command_hash;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!data_["files"].contains(source_path)) {
+      return false;
+    }
+    entry = data_["files"][source_path];
+    command_hash = get_command_hash(source_path);
+  }
+
+  if (!is_entry_up_to_date(entry, command_hash, source_path)) {
+    return false;
+  }
+
+  // 源文件中的类可能已经被其他源文件重新改写，每个类的缓存也需要有效。
+  std::vector<std::string> features;
+  for (const auto& name : entry["features"]) {
+    json feature_entry;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      if (!data_["features"].contains(name.get<std::string>())) {
+        LOG(INFO) << "feature not in cache, source_path: " << source_path << ", feature: " << name;
+        return false;
+      }
+      feature_entry = data_["features"][name.get<std::string>()];
+    }
+
+    if (!is_entry_up_to_date(feature_entry, feature_entry.value("command", std::string()), name.get<std::string>())) {
+      return false;
+    }
+
+    features.push_back(name.get<std::string>());
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  hit_features_.insert(features.begin(), features.end());
+  return true;
+}
+
+bool ConvertCache::use_cached_feature(const std::string& feature_name, const std::string& source_path) {
+  if (!is_enabled()) {
+    return false;
+  }
+
+  json entry;
+  std::string command_hash;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!data_["features"].contains(feature_name)) {
+      return false;
+    }
+    entry = data_["features"][feature_name];
+    command_hash = get_command_hash(source_path);
+  }
+
+  if (!is_entry_up_to_date(entry, command_hash, feature_name)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  hit_features_.insert(feature_name);
+  return true;
+}
+
+void ConvertCache::clear_cache_hits() {
+  std::lock_guard<std::mutex> lock(mu_);
+  hit_features_.clear();
+}
+
+json ConvertCache::cached_field_output() {
+  std::lock_guard<std::mutex> lock(mu_);
+
+  json res = json::object();
+  for (const std::string& name : hit_features_) {
+    if (data_["features"].contains(name)) {
+      res[name] = data_["features"][name]["field_output"];
+    }
+  }
+
+  return res;
+}
+
+void ConvertCache::update_feature(const std::string& feature_name,
+                                  const std::string& source_path,
+                                  const std::vector<std::string>& deps,
+                                  const std::vector<std::string>& outputs,
+                                  const json& field_output) {
+  if (!is_enabled()) {
+    return;
+  }
+
+  json entry = {{"deps", json::object()}, {"outputs", outputs}, {"field_output", field_output}};
+  for (const std::string& dep : deps) {
+    entry["deps"][dep] = file_hash(dep);
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  entry["command"] = get_command_hash(source_path);
+  data_["features"][feature_name] = std::move(entry);
+}
+
+void ConvertCache::update(const std::string& source_path,
+                          const std::vector<std::string>& deps,
+                          const std::vector<std::string>& features) {
+  if (!is_enabled()) {
+    return;
+  }
+
+  json entry = {{"deps", json::object()}, {"features", features}};
+  for (const std::string& dep : deps) {
+    entry["deps"][dep] = file_hash(dep);
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  entry["command"] = get_command_hash(source_path);
+  data_["files"][source_path] = std::move(entry);
+}
+
+bool ConvertCache::is_entry_up_to_date(const json& entry, const std::string& command_hash, const std::string& name) {
+  if (!entry.contains("command") || entry["command"].get<std::string>() != command_hash) {
+    LOG(INFO) << "compile command changed, name: " << name;
+    return false;
+  }
+
+  // 源文件的记录中没有生成的文件，生成的文件记录在每个类中。
+  for (const auto& output : entry.value("outputs", json::array())) {
+    if (!tool::is_file_exists(output.get<std::string>())) {
+      LOG(INFO) << "output file not exists, name: " << name << ", output: " << output;
+      return false;
+    }
+  }
+
+  for (auto it = entry["deps"].begin(); it != entry["deps"].end(); it++) {
+    if (file_hash(it.key()) != it.value().get<std::string>()) {
+      LOG(INFO) << "dep changed, name: " << name << ", dep: " << it.key();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::string ConvertCache::get_command_hash(const std::string& source_path) const {
+  auto it = command_hashes_.find(source_path);
+  return it != command_hashes_.end() ? it->second : std::string();
+}
+
+std::string ConvertCache::to_absolute_path(const std::string& path) {
+  llvm::SmallString<256> abs_path(path);
+  if (llvm::sys::fs::make_absolute(abs_path)) {
+    return path;
+  }
+
+  return abs_path.str().str();
+}
+
+std::string ConvertCache::gen_fingerprint() const {
+  auto config = GlobalConfig::Instance();
+
+  // 工具本身变化时改写逻辑可能会变化，因此可执行文件也作为 fingerprint 的一部分。
+  std::ostringstream oss;
+  oss << "exe:" << hash_string(tool::read_file_to_string("/proc/self/exe")) << ";"
+      << "message_def:" << hash_string(tool::read_file_to_string(config->message_def_filename)) << ";"
+      << "remove_comment:" << config->remove_comment << ";"
+      << "use_reco_user_info:" << config->use_reco_user_info << ";"
+      << "overwrite:" << config->overwrite << ";"
+      << "allowed_paths:";
+  for (const std::string& allowed_path : config->allowed_paths) {
+    oss << allowed_path << ",";
+  }
+
+  return hash_string(oss.str());
+}
+
+std::string ConvertCache::file_hash(const std::string& filename) {
+  // 获取不到文件状态时不缓存，每次都重新读取。
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(filename, status)) {
+    return hash_string(tool::read_file_to_string(filename));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = file_hash_cache_.find(filename);
+    if (it != file_hash_cache_.end() &&
+        it->second.mtime == status.getLastModificationTime() &&
+        it->second.size == status.getSize()) {
+      return it->second.hash;
+    }
+  }
+
+  std::string res = hash_string(tool::read_file_to_string(filename));
+
+  std::lock_guard<std::mutex> lock(mu_);
+  file_hash_cache_[filename] = FileHash{status.getLastModificationTime(), status.getSize(), res};
+  return res;
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/Support/Chrono.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+using nlohmann::json;
+
+/// 增量转换的缓存，保存在 `--cache-filename` 指定的文件中。
+///
+/// 以特征类为单位，记录类所在头文件及其直接或者间接包含的非系统头文件的内容 hash、编译命令、生成的文件
+/// 以及字段信息。这些都没有变化并且生成的文件都还存在时，该类不再解析和改写，字段信息直接从缓存中获取。
+/// 公共头文件中的类被多个源文件包含，其中一个源文件修改时，只要类所在头文件的依赖没有变化就不需要重新改写。
+///
+/// 另外以源文件为单位记录源文件的所有依赖以及源文件中改写的类。源文件的依赖都没有变化、其中的类的缓存
+/// 也都有效时，整个源文件直接跳过，不需要解析。
+///
+/// 缓存整体有一个 fingerprint, 包括工具本身、`message_def_filename` 以及影响
+/// 改写结果的参数，如 `allowed_paths`、`--overwrite`, 任何一个变化都会使所有缓存失效。proto 定义的变化
+/// 会体现在依赖的 `.pb.h` 中。编译命令单独记录，编译参数变化时只有对应的源文件和类失效。
+///
+/// 格式:
+/// ```json
+/// {
+///   "fingerprint": "...",
+///   "files": {
+///     "/path/to/extract_user_id.h": {
+///       "command": "...",
+///       "deps": {"/path/to/extract_user_id.h": "...", ...},
+///       "features": ["ExtractUserId"]
+///     }
+///   },
+///   "features": {
+///     "ExtractUserId": {
+///       "command": "...",
+///       "deps": {"/path/to/extract_user_id.h": "...", ...},
+///       "outputs": ["teams/ad/ad_algorithm/bs_feature/fast/impl/bs_extract_user_id.h", ...],
+///       "field_output": {...}
+///     }
+///   }
+/// }
+/// ```
+class ConvertCache {
+ public:
+  static ConvertCache* Instance() {
+    static ConvertCache instance;
+    return &instance;
+  }
+
+  /// 加载缓存，fingerprint 不一致则丢弃所有旧的缓存。
+  void load(const std::string& filename);
+
+  bool save();
+
+  bool is_enabled() const { return filename_.size() > 0; }
+
+  /// 源文件是否有缓存记录，即之前是否由本工具转换过。
+  bool contains(const std::string& source_path);
+
+  /// 设置源文件的编译命令，需要在 use_cached_file、use_cached_feature 以及 update 之前调用。
+  void set_compile_command(const std::string& source_path, const std::vector<std::string>& command_line);
+
+  /// 源文件及其依赖、编译命令都没有变化，并且其中的类的缓存都有效时返回 true, 源文件可以直接跳过，
+  /// 其中的类的字段信息从缓存中获取。
+  bool use_cached_file(const std::string& source_path);
+
+  /// 类所在头文件及其依赖、编译命令都没有变化，并且生成的文件都存在时返回 true, 类不需要再改写，
+  /// 字段信息从缓存中获取。source_path 为当前处理的源文件。
+  bool use_cached_feature(const std::string& feature_name, const std::string& source_path);
+
+  /// 每次转换开始前清空从缓存中获取的类。
+  void clear_cache_hits();
+
+  /// 本次转换中从缓存中获取的类的字段信息。
+  json cached_field_output();
+
+  /// 更新类的缓存，deps 为类所在头文件及其依赖。
+  void update_feature(const std::string& feature_name,
+                      const std::string& source_path,
+                      const std::vector<std::string>& deps,
+                      const std::vector<std::string>& outputs,
+                      const json& field_output);
+
+  /// 更新源文件的缓存，features 为源文件中改写的类以及从缓存中获取的类。
+  void update(const std::string& source_path,
+              const std::vector<std::string>& deps,
+              const std::vector<std::string>& features);
+
+  static std::string to_absolute_path(const std::string& path);
+
+ private:
+  ConvertCache() = default;
+
+  std::string gen_fingerprint() const;
+
+  /// 编译命令、生成的文件以及依赖是否都没有变化，name 只用于打印日志。
+  bool is_entry_up_to_date(const json& entry, const std::string& command_hash, const std::string& name);
+
+  /// 需要持有 mu_。
+  std::string get_command_hash(const std::string& source_path) const;
+
+  /// 文件内容的 hash。文件的修改时间和大小没有变化时直接返回之前的结果，serve 模式下请求之间修改过的
+  /// 文件会重新计算，其余的文件只需要 stat 一次。
+  std::string file_hash(const std::string& filename);
+
+ private:
+  struct FileHash {
+    llvm::sys::TimePoint<> mtime;
+    uint64_t size = 0;
+    std::string hash;
+  };
+
+  std::mutex mu_;
+  std::string filename_;
+  json data_ = json::object();
+  std::unordered_map<std::string, FileHash> file_hash_cache_;
+
+  /// 源文件编译命令的 hash。
+  std::unordered_map<std::string, std::string> command_hashes_;
+
+  /// 本次转换中从缓存中获取的类。
+  std::set<std::string> hit_features_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,242 @@
+#include <glog/logging.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "Config.h"
+#include "ConvertAction.h"
+#include "ConvertServer.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+int ConvertServer::serve() {
+  if (socket_path_.size() >= sizeof(sockaddr_un::sun_path)) {
+    LOG(ERROR) << "socket path is too long: " << socket_path_;
+    return 1;
+  }
+
+  int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server_fd < 0) {
+    LOG(ERROR) << "create socket failed: " << strerror(errno);
+    return 1;
+  }
+
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+
+  if (!remove_stale_socket(addr)) {
+    close(server_fd);
+    return 1;
+  }
+
+  if (bind(server_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(server_fd, 16) < 0) {
+    LOG(ERROR) << "listen failed, socket_path: " << socket_path_ << ", err: " << strerror(errno);
+    close(server_fd);
+    return 1;
+  }
+
+  LOG(INFO) << "serve on: " << socket_path_;
+
+  bool is_shutdown = false;
+  while (!is_shutdown) {
+    int fd = accept(server_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno != EINTR) {
+        LOG(ERROR) << "accept failed: " << strerror(errno);
+      }
+      continue;
+    }
+
+    // 请求按顺序处理，一个连接不收发数据时不能一直阻塞后面的请求。
+    timeval timeout;
+    timeout.tv_sec = kSocketTimeoutSeconds;
+    timeout.tv_usec = 0;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0) {
+      LOG(ERROR) << "set socket timeout failed: " << strerror(errno);
+      close(fd);
+      continue;
+    }
+
+    std::string data;
+    json response;
+    if (!read_request(fd, &data)) {
+      response = {{"ret", 1}, {"error", "read request failed"}};
+    } else {
+      json request = json::parse(data, nullptr, false);
+      if (request.is_discarded() || !request.is_object()) {
+        LOG(ERROR) << "invalid request: " << data;
+        response = {{"ret", 1}, {"error", "invalid request"}};
+      } else {
+        // 请求中字段类型不对或者处理时抛出异常，只返回错误，不能让整个服务退出。
+        try {
+          response = handle_request(request, &is_shutdown);
+        } catch (const std::exception& e) {
+          LOG(ERROR) << "handle request failed: " << e.what() << ", request: " << data;
+          response = {{"ret", 1}, {"error", std::string("handle request failed: ") + e.what()}};
+        }
+      }
+    }
+
+    std::string out = response.dump() + "\n";
+    size_t written = 0;
+    while (written < out.size()) {
+      // 客户端提前关闭连接时不能因为 SIGPIPE 退出。
+      ssize_t n = send(fd, out.data() + written, out.size() - written, MSG_NOSIGNAL);
+      if (n <= 0) {
+        break;
+      }
+      written += n;
+    }
+
+    close(fd);
+  }
+
+  close(server_fd);
+  unlink(socket_path_.c_str());
+  LOG(INFO) << "shutdown";
+
+  return 0;
+}
+
+bool ConvertServer::read_request(int fd, std::string* data) {
+  // 读到换行或者连接关闭为止。
+  char buf[4096];
+  while (data->find('\n') == std::string::npos) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(ERROR) << "read request failed: " << strerror(errno);
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+
+    data->append(buf, n);
+    if (data->size() > kMaxRequestSize) {
+      LOG(ERROR) << "request is too large, size: " << data->size();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ConvertServer::remove_stale_socket(const sockaddr_un& addr) {
+  // 不是 socket 的文件不能删除，交给 bind 报错。
+  struct stat st;
+  if (lstat(socket_path_.c_str(), &st) < 0 || !S_ISSOCK(st.st_mode)) {
+    return true;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    LOG(ERROR) << "create socket failed: " << strerror(errno);
+    return false;
+  }
+
+  int ret = connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+  int err = errno;
+  close(fd);
+
+  if (ret == 0) {
+    LOG(ERROR) << "server is already running, socket_path: " << socket_path_;
+    return false;
+  }
+
+  // 只删除没有进程监听的 socket 文件。
+  if (err == ECONNREFUSED) {
+    LOG(INFO) << "remove stale socket: " << socket_path_;
+    unlink(socket_path_.c_str());
+  }
+
+  return true;
+}
+
+json ConvertServer::handle_request(const json& request, bool* is_shutdown) {
+  LOG(INFO) << "handle request: " << request.dump();
+
+  if (!request.contains("cmd") || !request["cmd"].is_string()) {
+    return {{"ret", 1}, {"error", "cmd must be string"}};
+  }
+  std::string cmd = request["cmd"].get<std::string>();
+
+  if (cmd == "shutdown") {
+    *is_shutdown = true;
+    return {{"ret", 0}};
+  }
+
+  if (!request.contains("files") || !request["files"].is_array()) {
+    return {{"ret", 1}, {"error", "missing files"}};
+  }
+
+  std::vector<std::string> files;
+  for (const auto& file : request["files"]) {
+    if (!file.is_string()) {
+      return {{"ret", 1}, {"error", "file must be string"}};
+    }
+    files.push_back(file.get<std::string>());
+  }
+
+  if (files.size() == 0) {
+    return {{"ret", 1}, {"error", "files is empty"}};
+  }
+
+  if (cmd != "convert" && cmd != "parse_logic") {
+    return {{"ret", 1}, {"error", "unsupported cmd: " + cmd}};
+  }
+
+  // 只对当前请求生效，不覆盖命令行参数。
+  std::string field_detail_filename = GlobalConfig::Instance()->field_detail_filename;
+  if (request.contains("field_detail_filename")) {
+    const json& value = request["field_detail_filename"];
+    if (!value.is_string()) {
+      return {{"ret", 1}, {"error", "field_detail_filename must be string"}};
+    }
+
+    // 文件名会拼接在数据目录后面，不能写到数据目录之外。
+    field_detail_filename = value.get<std::string>();
+    if (field_detail_filename.find('/') != std::string::npos ||
+        field_detail_filename.find("..") != std::string::npos) {
+      return {{"ret", 1}, {"error", "invalid field_detail_filename: " + field_detail_filename}};
+    }
+  }
+
+  // 每个请求都是独立的，上一个请求中的特征需要重新处理。只是清空几个容器，代价很小。
+  GlobalConfig::clear_thread_state();
+
+  // 没有在启动时生成预编译头时在第一个请求中生成，之后只有编译参数或者 `--pch-header` 变化才会重新检查。
+  cmd_runner_->prepare_pch(files[0]);
+
+  if (cmd == "parse_logic") {
+    return {{"ret", cmd_runner_->run_parse_logic(files)}};
+  }
+
+  json field_output = json::object();
+  int ret = cmd_runner_->run_convert(files, &field_output);
+
+  if (field_detail_filename.size() > 0) {
+    ConvertAction::write_field_detail(field_output, field_detail_filename);
+  }
+
+  return {{"ret", ret}, {"field_output", std::move(field_output)}};
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <sys/un.h>
+
+#include <cstddef>
+#include <string>
+
+#include "CmdRunner.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+using nlohmann::json;
+
+/// `--cmd=serve` 模式，常驻进程，通过 Unix socket 接收请求。
+///
+/// 请求之间保持的状态:
+/// - 编译数据库。命令行中没有源文件时从 `--compile-commands-dir` 加载。
+/// - `ProtoParser` 中的 adlog 树以及路径查找的缓存，`Symbol` 的字符串池。
+/// - `ConvertCache` 中的记录，只在启动时加载一次，每个请求结束后写回文件。文件内容的 hash 按修改时间和
+///   大小校验，没有修改的文件不会重新读取。
+/// - 预编译头。启动时有源文件则直接生成，否则在第一个请求中生成。之后的请求只有编译参数或者
+///   `--pch-header` 的修改时间变化才会重新检查依赖。
+///
+/// 每个请求开始时会清空上一个请求的特征信息 (`GlobalConfig::clear_thread_state`), 否则返回的字段信息
+/// 会包含上一个请求中的特征。这些信息只和请求中的文件有关，清空只是几个容器的 clear。
+///
+/// 每个连接一个请求，请求和返回都是一行 json:
+/// ```json
+/// {"cmd": "convert", "files": ["teams/ad/ad_algorithm/feature/fast/impl/extract_user_id.h"]}
+/// {"ret": 0, "field_output": {...}}
+/// ```
+///
+/// `cmd` 支持 `convert`、`parse_logic` 和 `shutdown`。`convert` 请求可以通过 `field_detail_filename`
+/// 将字段信息写入文件，不指定时使用命令行参数 `--field-detail-filename`。文件名写在数据目录下，不能包含
+/// `/` 和 `..`。请求按顺序处理，字段类型不对时返回错误。
+class ConvertServer {
+ public:
+  explicit ConvertServer(CmdRunner* cmd_runner, const std::string& socket_path):
+    cmd_runner_(cmd_runner), socket_path_(socket_path) {}
+
+  /// 监听并处理请求，直到收到 `shutdown` 请求。
+  int serve();
+
+ private:
+  json handle_request(const json& request, bool* is_shutdown);
+
+  /// 已经有服务在监听时返回 false。socket 文件存在但是没有进程监听时删除。
+  bool remove_stale_socket(const sockaddr_un& addr);
+
+  /// 读取一行请求。超时、连接关闭或者超过长度限制时返回 false。
+  bool read_request(int fd, std::string* data);
+
+ private:
+  static constexpr int kSocketTimeoutSeconds = 10;
+  static constexpr size_t kMaxRequestSize = 1 << 20;
+
+  CmdRunner* cmd_runner_ = nullptr;
+  std::string socket_path_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
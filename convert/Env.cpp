@@ -17,53 +17,81 @@ namespace ks {
 namespace ad_algorithm {
 namespace convert {
 
-const Env* Env::get_loop_parent() const {
+using SymKind = ScopedSymbolTable::Kind;
+
+thread_local uint64_t Env::generation_ = 0;
+
+Env::Env(): own_symbol_table_(new ScopedSymbolTable()) {
+  symbol_table_ = own_symbol_table_.get();
+  scope_ = symbol_table_->push_scope();
+  root_ = this;
+}
+
+Env::Env(Env* parent): parent_(parent) {
+  parent_->add_child(this);
+
+  symbol_table_ = parent_->symbol_table_;
+  scope_ = symbol_table_->push_scope();
+  root_ = parent_->root_;
+  update_kind_cache();
+}
+
+Env::~Env() {
+  bump_generation();
+  symbol_table_->pop_scope(scope_);
+}
+
+void Env::update_kind_cache() {
+  const Env* parent = parent_;
+
   if (is_loop_) {
-    return parent_;
+    loop_env_ = this;
+    outer_loop_ = parent != nullptr && parent->is_loop_ ? parent->outer_loop_ : this;
+  } else {
+    loop_env_ = parent != nullptr ? parent->loop_env_ : nullptr;
+    outer_loop_ = parent != nullptr ? parent->outer_loop_ : nullptr;
   }
 
-  if (parent_ != nullptr) {
-    return parent_->get_loop_parent();
+  if (is_if_) {
+    outer_if_ = parent != nullptr && parent->is_if_ ? parent->outer_if_ : this;
+  } else {
+    outer_if_ = parent != nullptr ? parent->outer_if_ : nullptr;
   }
-
-  return nullptr;
 }
 
-Env* Env::mutable_loop_parent() {
-  const Env* loop_parent = get_loop_parent();
-  return const_cast<Env*>(loop_parent);
+const EnvSideTables& Env::side_tables() const {
+  if (side_tables_ != nullptr) {
+    return *side_tables_;
+  }
+
+  static const EnvSideTables empty;
+  return empty;
 }
 
-const Env* Env::get_loop_env() const {
-  if (is_loop_) {
-    return this;
+EnvSideTables& Env::mutable_side_tables() {
+  bump_generation();
+  if (side_tables_ == nullptr) {
+    side_tables_.reset(new EnvSideTables());
   }
 
-  if (parent_ != nullptr) {
-    return parent_->get_loop_env();
+  return *side_tables_;
+}
+
+const Env* Env::get_loop_parent() const {
+  if (loop_env_ != nullptr) {
+    return loop_env_->parent_;
   }
 
   return nullptr;
 }
 
+Env* Env::mutable_loop_parent() {
+  const Env* loop_parent = get_loop_parent();
+  return const_cast<Env*>(loop_parent);
+}
+
 const Env *Env::get_outer_loop() const {
-  if (is_loop_) {
-    if (parent_ != nullptr) {
-      if (parent_->is_loop()) {
-        return parent_->get_outer_loop();
-      } else {
-        return this;
-      }
-    } else {
-      return this;
-    }
-  } else {
-    if (parent_ != nullptr) {
-      return parent_->get_outer_loop();
-    } else {
-      return nullptr;
-    }
-  }
+  return outer_loop_;
 }
 
 Env *Env::mutable_outer_loop() {
@@ -87,23 +115,7 @@ Env *Env::mutable_outer_loop_parent() {
 }
 
 const Env *Env::get_outer_if() const {
-  if (is_if_) {
-    if (parent_ != nullptr) {
-      if (parent_->is_if()) {
-        return parent_->get_outer_if();
-      } else {
-        return this;
-      }
-    } else {
-      return this;
-    }
-  } else {
-    if (parent_ != nullptr) {
-      return parent_->get_outer_if();
-    } else {
-      return nullptr;
-    }
-  }
+  return outer_if_;
 }
 
 Env *Env::mutable_outer_if() {
@@ -132,23 +144,15 @@ Env* Env::mutable_loop_env() {
 }
 
 const Env* Env::get_root() const {
-  if (parent_ == nullptr) {
-    return const_cast<const Env*>(this);
-  }
-
-  return parent_->get_root();
+  return root_;
 }
 
 Env* Env::get_mutable_root() {
-  if (parent_ == nullptr) {
-    return this;
-  }
-
-  return parent_->get_mutable_root();
+  return root_;
 }
 
 const Env* Env::get_common_info_prepare_env() const {
-  if (common_info_prepare_) {
+  if (side_tables().common_info_prepare) {
     return this;
   }
 
@@ -191,36 +195,43 @@ bool Env::is_parent_if() const {
 }
 
 void Env::add_used_var_name(const std::string& name) {
-  used_var_names_.insert(name);
+  bump_generation();
+  mutable_side_tables().used_var_names.insert(Symbol::intern(name));
 }
 
 bool Env::is_var_name_used(const std::string& name) const {
-  return used_var_names_.find(name) != used_var_names_.end();
+  absl::optional<Symbol> symbol = Symbol::find(name);
+  return symbol && side_tables().used_var_names.find(*symbol) != side_tables().used_var_names.end();
 }
 
 void Env::add_template_var_names(const std::vector<std::string>& var_names) {
+  bump_generation();
   for (size_t i = 0; i < var_names.size(); i++) {
     LOG(INFO) << "add_template_var_name: " << var_names[i];
-    used_var_names_.insert(var_names[i]);
+    mutable_side_tables().used_var_names.insert(Symbol::intern(var_names[i]));
   }
 }
 
 void Env::add_child(Env* child) {
+  bump_generation();
   if (child != nullptr) {
     children_.push_back(child);
   }
 }
 
 void Env::add(const std::string& key, clang::Expr* expr) {
+  bump_generation();
   if (var_decls_.find(key) != var_decls_.end()) {
     LOG(INFO) << "override key: " << key << ", expr: " << stmt_to_string(expr);
   }
   get_mutable_root()->add_used_var_name(key);
   var_decls_[key] = expr;
+  symbol_table_->bind(scope_, SymKind::VAR_DECL, key, this, expr);
 }
 
 void Env::set_feature_name(const std::string& feature_name) {
-  feature_name_ = feature_name;
+  bump_generation();
+  mutable_side_tables().feature_name = feature_name;
 }
 
 const std::string& Env::feature_name() const {
@@ -234,7 +245,8 @@ const std::string& Env::feature_name() const {
 }
 
 void Env::set_feature_type(const std::string& feature_type) {
-  feature_type_ = feature_type;
+  bump_generation();
+  mutable_side_tables().feature_type = feature_type;
 }
 
 const std::string& Env::feature_type() const {
@@ -248,33 +260,35 @@ const std::string& Env::feature_type() const {
 }
 
 clang::Expr* Env::find(const std::string& key) const {
-  auto it = var_decls_.find(key);
-  if (it != var_decls_.end()) {
-    return it->second;
-  }
-
-  if (parent_ != nullptr) {
-    return parent_->find(key);
+  const ScopedSymbolTable::Binding* binding = symbol_table_->lookup(scope_, SymKind::VAR_DECL, key);
+  if (binding != nullptr) {
+    return static_cast<clang::Expr*>(binding->value);
   }
 
   return nullptr;
 }
 
 void Env::erase(const std::string& key) {
+  bump_generation();
   if (var_decls_.find(key) != var_decls_.end()) {
     var_decls_.erase(key);
+    symbol_table_->unbind(scope_, SymKind::VAR_DECL, key);
   }
 }
 
 void Env::add_loop_var(const std::string& key) {
+  bump_generation();
   loop_var_names_.push_back(key);
+  symbol_table_->bind(scope_, SymKind::LOOP_VAR, key, this, nullptr, true);
   if (loop_info_) {
     loop_info_->set_loop_var(key);
   }
 }
 
 void Env::pop_loop_var() {
+  bump_generation();
   if (loop_var_names_.size() > 0) {
+    symbol_table_->unbind(scope_, SymKind::LOOP_VAR, loop_var_names_.back());
     loop_var_names_.pop_back();
   }
 }
@@ -295,17 +309,7 @@ const std::string& Env::get_last_loop_var() const {
 }
 
 bool Env::is_loop_var(const std::string& key) const {
-  for (size_t i = 0; i < loop_var_names_.size(); i++) {
-    if (loop_var_names_[i] == key) {
-      return true;
-    }
-  }
-
-  if (parent_ != nullptr) {
-    return parent_->is_loop_var(key);
-  }
-
-  return false;
+  return symbol_table_->lookup(scope_, SymKind::LOOP_VAR, key) != nullptr;
 }
 
 bool Env::is_in_loop() const {
@@ -321,31 +325,32 @@ bool Env::is_in_loop() const {
 }
 
 void Env::add_loop_expr(clang::Expr* expr) {
+  bump_generation();
   if (expr == nullptr) {
     return;
   }
 
-  loop_exprs_.push_back(expr);
+  mutable_side_tables().loop_exprs.push_back(expr);
 }
 
 size_t Env::get_loop_expr_size() {
-  return loop_exprs_.size();
+  return side_tables().loop_exprs.size();
 }
 
 clang::Expr* Env::get_loop_expr(size_t index) {
-  if (index >= loop_exprs_.size()) {
+  if (index >= side_tables().loop_exprs.size()) {
     return nullptr;
   }
 
-  return loop_exprs_[index];
+  return side_tables().loop_exprs[index];
 }
 
 clang::Expr* Env::get_first_loop_expr() {
-  if (loop_exprs_.size() == 0) {
+  if (side_tables().loop_exprs.size() == 0) {
     return nullptr;
   }
 
-  return loop_exprs_[0];
+  return side_tables().loop_exprs[0];
 }
 
 clang::Expr* Env::find_parent_loop() {
@@ -396,8 +401,16 @@ bool Env::is_in_if_body() const {
   return false;
 }
 
+void Env::set_is_loop(bool is_loop) {
+  bump_generation();
+  is_loop_ = is_loop;
+  update_kind_cache();
+}
+
 void Env::set_is_if(bool is_if) {
+  bump_generation();
   is_if_ = is_if;
+  update_kind_cache();
   if (parent_ != nullptr) {
     parent_->set_has_if_in_children(true);
   }
@@ -408,6 +421,7 @@ bool Env::has_if_in_children() const {
 }
 
 void Env::set_has_if_in_children(bool v) {
+  bump_generation();
   has_if_in_children_ = v;
 }
 
@@ -484,6 +498,7 @@ bool Env::is_in_common_info_if_body() const {
 }
 
 void Env::set_is_child_common_attr_cond(bool v) {
+  bump_generation();
   is_child_common_attr_cond_ = v;
 }
 
@@ -540,10 +555,11 @@ bool Env::is_check_item_pos_cond() const {
 }
 
 bool Env::is_action_detail_cond() const {
-  return is_if_ && action_detail_info_.has_value();
+  return is_if_ && side_tables().action_detail_info.has_value();
 }
 
 void Env::set_cxx_for_range_stmt(clang::CXXForRangeStmt* cxx_for_range_stmt) {
+  bump_generation();
   cxx_for_range_stmt_ = cxx_for_range_stmt;
 }
 clang::CXXForRangeStmt* Env::cxx_for_range_stmt() const {
@@ -551,6 +567,7 @@ clang::CXXForRangeStmt* Env::cxx_for_range_stmt() const {
 }
 
 void Env::set_for_stmt(clang::ForStmt* for_stmt) {
+  bump_generation();
   for_stmt_ = for_stmt;
 }
 
@@ -559,6 +576,7 @@ clang::ForStmt* Env::for_stmt() const {
 }
 
 void Env::set_if_stmt(clang::IfStmt* if_stmt) {
+  bump_generation();
   if_stmt_ = if_stmt;
 }
 
@@ -580,7 +598,7 @@ bool Env::is_all_if_stmt_deleted() const {
     return false;
   }
 
-  int total_deleted = deleted_vars_.size();
+  int total_deleted = side_tables().deleted_vars.size();
   if (total_deleted == 0) {
     return false;
   }
@@ -594,18 +612,16 @@ bool Env::is_all_if_stmt_deleted() const {
 }
 
 void Env::add_decl_stmt(const std::string& name, clang::DeclStmt* decl_stmt) {
+  bump_generation();
   decl_stmts_[name] = decl_stmt;
+  symbol_table_->bind(scope_, SymKind::DECL_STMT, name, this, decl_stmt);
   get_mutable_root()->add_used_var_name(name);
 }
 
 clang::DeclStmt* Env::get_decl_stmt(const std::string& name) const {
-  auto it = decl_stmts_.find(name);
-  if (it != decl_stmts_.end()) {
-    return it->second;
-  }
-
-  if (parent_ != nullptr) {
-    return parent_->get_decl_stmt(name);
+  const ScopedSymbolTable::Binding* binding = symbol_table_->lookup(scope_, SymKind::DECL_STMT, name);
+  if (binding != nullptr) {
+    return static_cast<clang::DeclStmt*>(binding->value);
   }
 
   return nullptr;
@@ -621,27 +637,26 @@ clang::DeclStmt* Env::get_decl_stmt_in_cur_env(const std::string& name) const {
 }
 
 Env* Env::find_decl_env(const std::string& name) {
-  if (decl_stmts_.find(name) != decl_stmts_.end()) {
-    return this;
-  }
-
-  if (parent_ != nullptr) {
-    return parent_->find_decl_env(name);
+  const ScopedSymbolTable::Binding* binding = symbol_table_->lookup(scope_, SymKind::DECL_STMT, name);
+  if (binding != nullptr) {
+    return binding->env;
   }
 
   return nullptr;
 }
 
 void Env::add_deleted_var(const std::string& name) {
+  bump_generation();
   LOG(INFO) << "add deleted var: " << name;
-  deleted_vars_.insert(name);
+  mutable_side_tables().deleted_vars.insert(name);
 }
 
 // 可能有隐式转换, 统一通过 str 来判断
 bool Env::add_deleted_var_by_expr(clang::Expr* expr) {
+  bump_generation();
   for (auto it = var_decls_.begin(); it != var_decls_.end(); it++) {
     if (stmt_to_string(expr) == stmt_to_string(it->second)) {
-      deleted_vars_.insert(it->first);
+      mutable_side_tables().deleted_vars.insert(it->first);
       return true;
     }
   }
@@ -651,9 +666,10 @@ bool Env::add_deleted_var_by_expr(clang::Expr* expr) {
 
 // 可能有隐式转换, 统一通过 str 来判断
 bool Env::add_deleted_var_by_expr_str(const std::string& expr_str) {
+  bump_generation();
   for (auto it = var_decls_.begin(); it != var_decls_.end(); it++) {
     if (expr_str == stmt_to_string(it->second)) {
-      deleted_vars_.insert(it->first);
+      mutable_side_tables().deleted_vars.insert(it->first);
       return true;
     }
   }
@@ -662,11 +678,17 @@ bool Env::add_deleted_var_by_expr_str(const std::string& expr_str) {
 }
 
 void Env::pop_deleted_var(const std::string& name) {
-  deleted_vars_.erase(name);
+  bump_generation();
+  if (side_tables_ != nullptr) {
+    side_tables_->deleted_vars.erase(name);
+  }
 }
 
 void Env::clear_deleted_var() {
-  deleted_vars_.clear();
+  bump_generation();
+  if (side_tables_ != nullptr) {
+    side_tables_->deleted_vars.clear();
+  }
 }
 
 Env* Env::mutable_new_def_target_env(bool is_from_reco) {
@@ -702,6 +724,7 @@ Env* Env::mutable_new_def_target_env(bool is_from_reco) {
 void Env::add_new_def(const std::string& bs_enum_str,
                       const std::string& var_def,
                       NewVarType new_var_type) {
+  bump_generation();
   bool is_from_reco  = tool::is_str_from_reco_user_info(bs_enum_str);
   Env* target_env = mutable_new_def_target_env(is_from_reco);
   if (target_env == nullptr) {
@@ -714,6 +737,7 @@ void Env::add_new_def(const std::string& bs_enum_str,
 void Env::add_new_def_helper(const std::string &bs_enum_str,
                              const std::string &var_def,
                              NewVarType new_var_type) {
+  bump_generation();
   absl::optional<NewVarDef> &var = find_mutable_new_def(bs_enum_str);
   if (var) {
     if (var->var_def().size() == 0) {
@@ -727,17 +751,19 @@ void Env::add_new_def_helper(const std::string &bs_enum_str,
   get_mutable_root()->add_used_var_name(var_name);
   absl::optional<NewVarDef> new_def = absl::make_optional<NewVarDef>(
       bs_enum_str, var_name, var_def, new_var_type);
-  new_defs_[bs_enum_str] = std::move(new_def);
+  mutable_side_tables().new_defs[bs_enum_str] = std::move(new_def);
 }
 
 void Env::add_new_def_meta(const std::string& bs_enum_str,
                            const std::string& var_def,
                            NewVarType new_var_type) {
+  bump_generation();
   add_new_def(bs_enum_str, var_def, new_var_type);
   add_attr_meta(bs_enum_str);
 }
 
 void Env::add_attr_meta(const std::string& bs_enum_str) {
+  bump_generation();
   if (starts_with(bs_enum_str, "adlog")) {
     if (auto constructor_info = mutable_constructor_info()) {
       constructor_info->add_bs_field_enum(bs_enum_str);
@@ -747,8 +773,41 @@ void Env::add_attr_meta(const std::string& bs_enum_str) {
   }
 }
 
+// 在当前 env 判断是否在循环中，new def 可能会被定义到 loop parent env 中。
+void Env::add_field_access(const std::string& bs_enum_str,
+                           absl::optional<NewVarType> new_var_type) {
+  bump_generation();
+  // 和 add_attr_meta 一样只记录 adlog 字段，如 seq_list 的局部变量名不是 bs 字段。
+  if (!tool::is_adlog_field(bs_enum_str)) {
+    return;
+  }
+
+  if (auto feature_info = mutable_feature_info()) {
+    feature_info->add_field_access(bs_enum_str, new_var_type, is_in_loop());
+  }
+}
+
+void Env::add_common_info_field_access(const CommonInfoLeaf& common_info_detail) {
+  bump_generation();
+  std::string bs_enum_str = common_info_detail.get_bs_enum_str();
+  if (bs_enum_str.size() == 0 || !common_info_detail.is_ready()) {
+    return;
+  }
+
+  if (common_info_detail.is_scalar()) {
+    add_field_access(bs_enum_str, NewVarType::SCALAR);
+  } else if (common_info_detail.is_list()) {
+    add_field_access(bs_enum_str, NewVarType::LIST);
+  } else if (common_info_detail.is_map()) {
+    add_field_access(bs_enum_str, NewVarType::MAP);
+    add_field_access(bs_enum_str + "_key", absl::nullopt);
+    add_field_access(bs_enum_str + "_value", absl::nullopt);
+  }
+}
+
 void Env::set_normal_adlog_field_info(const std::string& bs_enum_str,
                                       const std::string& adlog_field) {
+  bump_generation();
   if (auto construct_info = mutable_constructor_info()) {
     construct_info->set_normal_adlog_field_info(bs_enum_str, adlog_field);
   }
@@ -758,6 +817,7 @@ void Env::set_common_info_field_info(const std::string& bs_enum_str,
                                      const std::string& adlog_field,
                                      const std::string& common_info_enum_name,
                                      int common_info_value) {
+  bump_generation();
   if (auto construct_info = mutable_constructor_info()) {
     construct_info->set_common_info_field_info(bs_enum_str,
                                                adlog_field,
@@ -796,6 +856,7 @@ void Env::add_new_def(const std::string& bs_enum_str,
                       const std::string& var_name,
                       const std::string& var_def,
                       NewVarType new_var_type) {
+  bump_generation();
   bool is_from_reco  = tool::is_str_from_reco_user_info(bs_enum_str);
   Env *target_env = mutable_new_def_target_env(is_from_reco);
   if (target_env == nullptr) {
@@ -809,6 +870,7 @@ void Env::add_new_def_helper(const std::string &bs_enum_str,
                              const std::string &var_name,
                              const std::string &var_def,
                              NewVarType new_var_type) {
+  bump_generation();
   absl::optional<NewVarDef> &var = find_mutable_new_def(bs_enum_str);
   if (var) {
     LOG(INFO) << "var_def already exists, bs_enum_str: " << bs_enum_str
@@ -825,7 +887,7 @@ void Env::add_new_def_helper(const std::string &bs_enum_str,
 
   absl::optional<NewVarDef> new_def = absl::make_optional<NewVarDef>(
       bs_enum_str, var_name, var_def, new_var_type);
-  new_defs_[bs_enum_str] = std::move(new_def);
+  mutable_side_tables().new_defs[bs_enum_str] = std::move(new_def);
   get_mutable_root()->add_used_var_name(var_name);
 }
 
@@ -833,12 +895,14 @@ void Env::add_new_def_meta(const std::string& bs_enum_str,
                            const std::string& var_name,
                            const std::string& var_def,
                            NewVarType new_var_type) {
+  bump_generation();
   add_new_def(bs_enum_str, var_name, var_def, new_var_type);
   add_attr_meta(bs_enum_str);
 }
 
 void Env::add_new_exists_def(const std::string &bs_enum_str,
                              const std::string &exists_var_def) {
+  bump_generation();
   bool is_from_reco  = tool::is_str_from_reco_user_info(bs_enum_str);
   if (auto env = mutable_new_def_target_env(is_from_reco)) {
     env->add_new_exists_def_helper(bs_enum_str, exists_var_def);
@@ -847,6 +911,7 @@ void Env::add_new_exists_def(const std::string &bs_enum_str,
 
 void Env::add_new_exists_def_helper(const std::string& bs_enum_str,
                                      const std::string& exists_var_def) {
+  bump_generation();
   if (absl::optional<NewVarDef>& var_def = find_mutable_new_def(bs_enum_str)) {
     var_def->set_exists_var_def(tool::get_exists_name(var_def->name()), exists_var_def);
   } else {
@@ -856,19 +921,20 @@ void Env::add_new_exists_def_helper(const std::string& bs_enum_str,
     absl::optional<NewVarDef> new_def = absl::make_optional<NewVarDef>(bs_enum_str, var_name);
     std::string exists_name = tool::get_exists_name(var_name);
     new_def->set_exists_var_def(exists_name, exists_var_def);
-    new_defs_.emplace(bs_enum_str, new_def);
+    mutable_side_tables().new_defs.emplace(bs_enum_str, new_def);
   }
 }
 
 void Env::add_new_exists_def_meta(const std::string& bs_enum_str,
                                   const std::string& exists_var_def) {
+  bump_generation();
   add_new_exists_def(bs_enum_str, exists_var_def);
   add_attr_meta(bs_enum_str);
 }
 
 const absl::optional<NewVarDef>& Env::find_new_def(const std::string& bs_enum_str) const {
-  auto it = new_defs_.find(bs_enum_str);
-  if (it != new_defs_.end() && it->second.has_value()) {
+  auto it = side_tables().new_defs.find(bs_enum_str);
+  if (it != side_tables().new_defs.end() && it->second.has_value()) {
     return it->second;
   }
 
@@ -876,7 +942,7 @@ const absl::optional<NewVarDef>& Env::find_new_def(const std::string& bs_enum_st
     return parent_->find_new_def(bs_enum_str);
   }
 
-  static absl::optional<NewVarDef> empty = absl::nullopt;
+  static thread_local absl::optional<NewVarDef> empty = absl::nullopt;
   return empty;
 }
 
@@ -885,6 +951,7 @@ void Env::add_new_def_overwrite(
   const std::string &var_def,
   NewVarType new_var_type
 ) {
+  bump_generation();
   absl::optional<NewVarDef> &var = find_mutable_new_def(bs_var_name);
   if (var) {
     if (var->var_def().size() == 0) {
@@ -897,10 +964,11 @@ void Env::add_new_def_overwrite(
   get_mutable_root()->add_used_var_name(bs_var_name);
   absl::optional<NewVarDef> new_def = absl::make_optional<NewVarDef>(
       bs_var_name, bs_var_name, var_def, new_var_type);
-  new_defs_[bs_var_name] = std::move(new_def);
+  mutable_side_tables().new_defs[bs_var_name] = std::move(new_def);
 }
 
 absl::optional<NewVarDef>& Env::find_mutable_new_def(const std::string& bs_enum_str) {
+  bump_generation();
   const absl::optional<NewVarDef>& var_def = find_new_def(bs_enum_str);
   return const_cast<absl::optional<NewVarDef>&>(var_def);
 }
@@ -976,7 +1044,7 @@ const std::string& Env::find_new_exists_var_name(const std::string& bs_enum_str)
 std::vector<std::string> Env::get_all_new_def_var_names() const {
   std::vector<std::string> res;
 
-  for (auto it = new_defs_.begin(); it != new_defs_.end(); it++) {
+  for (auto it = side_tables().new_defs.begin(); it != side_tables().new_defs.end(); it++) {
     if (it->second.has_value()) {
       res.emplace_back(it->second->name());
     }
@@ -987,7 +1055,7 @@ std::vector<std::string> Env::get_all_new_def_var_names() const {
 
 std::string Env::get_all_new_defs() const {
   std::ostringstream oss;
-  for (auto it = new_defs_.begin(); it != new_defs_.end(); it++) {
+  for (auto it = side_tables().new_defs.begin(); it != side_tables().new_defs.end(); it++) {
     if (it->second.has_value()) {
       LOG(INFO) << "new var, var_name: " << it->second->name() << ", def: " << it->second->var_def();
       if (it->second->var_def().size() > 0) {
@@ -1015,13 +1083,14 @@ int Env::get_action() {
 }
 
 void Env::set_action_expr(clang::Expr* expr, std::string bs_action_expr) {
+  bump_generation();
   action_expr_ = expr;
-  bs_action_expr_ = bs_action_expr;
+  mutable_side_tables().bs_action_expr = bs_action_expr;
 }
 
 std::string Env::get_bs_action_expr() {
-  if (bs_action_expr_.size() > 0) {
-    return bs_action_expr_;
+  if (side_tables().bs_action_expr.size() > 0) {
+    return side_tables().bs_action_expr;
   }
 
   if (parent_ != nullptr) {
@@ -1032,7 +1101,7 @@ std::string Env::get_bs_action_expr() {
 }
 
 std::string Env::find_one_action_detail_leaf_name(const std::string& bs_enum_str) const {
-  for (auto it = new_defs_.begin(); it != new_defs_.end(); it++) {
+  for (auto it = side_tables().new_defs.begin(); it != side_tables().new_defs.end(); it++) {
     if (starts_with(it->first, bs_enum_str)) {
       const absl::optional<NewVarDef>& new_var_def = it->second;
       if (new_var_def && new_var_def->is_list()) {
@@ -1049,55 +1118,60 @@ std::string Env::find_one_action_detail_leaf_name(const std::string& bs_enum_str
 }
 
 void Env::add_if_stmt(clang::IfStmt* if_stmt) {
+  bump_generation();
   if_info_.emplace(if_stmt);
 }
 
 void Env::add_loop_stmt(clang::ForStmt* for_stmt) {
+  bump_generation();
   loop_info_.emplace(for_stmt);
 }
 
 void Env::add_loop_stmt(clang::CXXForRangeStmt* cxx_for_range_stmt) {
+  bump_generation();
   loop_info_.emplace(cxx_for_range_stmt);
 }
 
 void Env::add_action_detail_prefix_adlog(const std::string& prefix_adlog) {
-  action_detail_prefix_adlog_.emplace(prefix_adlog);
+  bump_generation();
+  mutable_side_tables().action_detail_prefix_adlog.emplace(prefix_adlog);
 }
 
 // 多个 common info
 // 一定要找到 prefix 所在 loop Env 来创建，才能保证唯一。
 absl::optional<CommonInfoNormal>& Env::touch_common_info_normal() {
-  static absl::optional<CommonInfoNormal> empty;
+  bump_generation();
+  static thread_local absl::optional<CommonInfoNormal> empty;
 
-  if (common_info_prepare_ && common_info_prepare_->prefix()) {
-    if (!common_info_prepare_->is_common_info_normal()) {
+  if (side_tables().common_info_prepare && mutable_side_tables().common_info_prepare->prefix()) {
+    if (!mutable_side_tables().common_info_prepare->is_common_info_normal()) {
       return empty;
     }
 
-    if (!common_info_normal_) {
-      const std::string& prefix_adlog = *(common_info_prepare_->prefix_adlog());
+    if (!side_tables().common_info_normal) {
+      const std::string& prefix_adlog = *(mutable_side_tables().common_info_prepare->prefix_adlog());
       if (starts_with(prefix_adlog, "adlog") || (feature_name() == "ItemFilter" && starts_with(prefix_adlog, "item"))) {
         LOG(INFO) << "touch common_info_normal, prefix_adlog: "
-                  << *(common_info_prepare_->prefix_adlog());
-        common_info_normal_.emplace(*(common_info_prepare_->prefix_adlog()));
+                  << *(mutable_side_tables().common_info_prepare->prefix_adlog());
+        mutable_side_tables().common_info_normal.emplace(*(mutable_side_tables().common_info_prepare->prefix_adlog()));
       } else if (const auto &middle_node_info = get_middle_node_info()) {
         LOG(INFO) << "touch common_info_normal with middle_node, middle_node: "
                   << middle_node_info->name()
-                  << ", prefix_adlog: " << *(common_info_prepare_->prefix_adlog());
-        common_info_normal_.emplace(*(common_info_prepare_->prefix_adlog()), middle_node_info->name());
+                  << ", prefix_adlog: " << *(mutable_side_tables().common_info_prepare->prefix_adlog());
+        mutable_side_tables().common_info_normal.emplace(*(mutable_side_tables().common_info_prepare->prefix_adlog()), middle_node_info->name());
       } else {
         LOG(INFO) << "prefix_adlog is not starts_with adlog! prefix_adlog: " << prefix_adlog;
         return empty;
       }
 
-      common_info_normal_->set_env_ptr(this);
-      if (common_info_prepare_->name_value_alias()) {
-        common_info_normal_->set_name_value_alias(*(common_info_prepare_->name_value_alias()));
+      mutable_side_tables().common_info_normal->set_env_ptr(this);
+      if (mutable_side_tables().common_info_prepare->name_value_alias()) {
+        mutable_side_tables().common_info_normal->set_name_value_alias(*(mutable_side_tables().common_info_prepare->name_value_alias()));
       }
-      common_info_prepare_->set_is_confirmed();
+      mutable_side_tables().common_info_prepare->set_is_confirmed();
     }
 
-    return common_info_normal_;
+    return mutable_side_tables().common_info_normal;
   }
 
   if (parent_ != nullptr) {
@@ -1110,25 +1184,26 @@ absl::optional<CommonInfoNormal>& Env::touch_common_info_normal() {
 
 // common info enum 变量通过模板参数传递
 absl::optional<CommonInfoFixedList>& Env::touch_common_info_fixed_list() {
-  static absl::optional<CommonInfoFixedList> empty;
+  bump_generation();
+  static thread_local absl::optional<CommonInfoFixedList> empty;
 
-  if (common_info_prepare_ && common_info_prepare_->prefix_adlog()) {
-    // if (common_info_prepare_->is_common_info_normal()) {
+  if (side_tables().common_info_prepare && mutable_side_tables().common_info_prepare->prefix_adlog()) {
+    // if (mutable_side_tables().common_info_prepare->is_common_info_normal()) {
     //   return (empty);
     // }
-    if (!common_info_fixed_list_) {
-      const std::string& prefix_adlog = *(common_info_prepare_->prefix_adlog());
+    if (!side_tables().common_info_fixed_list) {
+      const std::string& prefix_adlog = *(mutable_side_tables().common_info_prepare->prefix_adlog());
       if (starts_with(prefix_adlog, "adlog")
           || (feature_name() == "ItemFilter"
               && starts_with(prefix_adlog, "item"))) {
-        common_info_fixed_list_.emplace(*(common_info_prepare_->prefix_adlog()));
+        mutable_side_tables().common_info_fixed_list.emplace(*(mutable_side_tables().common_info_prepare->prefix_adlog()));
         LOG(INFO) << "touch common_info_fixed_list, prefix_adlog: "
-                  << *(common_info_prepare_->prefix_adlog());
+                  << *(mutable_side_tables().common_info_prepare->prefix_adlog());
       } else if (const auto& middle_node_info = get_middle_node_info()) {
-        common_info_fixed_list_.emplace(*(common_info_prepare_->prefix_adlog()),
+        mutable_side_tables().common_info_fixed_list.emplace(*(mutable_side_tables().common_info_prepare->prefix_adlog()),
                                         middle_node_info);
         LOG(INFO) << "touch common_info_fixed_list with middle_node, prefix_adlog: "
-                  << *(common_info_prepare_->prefix_adlog())
+                  << *(mutable_side_tables().common_info_prepare->prefix_adlog())
                   << ", middle_node root: " << middle_node_info->name();
       } else {
         LOG(INFO) << "prefix_adlog is not starts_with adlog! prefix_adlog: "
@@ -1136,10 +1211,10 @@ absl::optional<CommonInfoFixedList>& Env::touch_common_info_fixed_list() {
         return empty;
       }
 
-      common_info_fixed_list_->set_env_ptr(this);
-      common_info_prepare_->set_is_confirmed();
+      mutable_side_tables().common_info_fixed_list->set_env_ptr(this);
+      mutable_side_tables().common_info_prepare->set_is_confirmed();
     }
-    return common_info_fixed_list_;
+    return mutable_side_tables().common_info_fixed_list;
   }
 
   if (parent_ != nullptr) {
@@ -1154,15 +1229,16 @@ absl::optional<CommonInfoFixedList>& Env::touch_common_info_fixed_list() {
 // 一定要找到 prefix 所在 loop Env 来创建，才能保证唯一。
 absl::optional<CommonInfoMultiMap>& Env::touch_common_info_multi_map(const std::string& map_name,
                                                                      const std::string& attr_name) {
-  if (common_info_prepare_ && common_info_prepare_->prefix()) {
-    if (!common_info_multi_map_) {
-      common_info_multi_map_.emplace(*(common_info_prepare_->prefix_adlog()), map_name, attr_name);
-      common_info_multi_map_->set_env_ptr(this);
-      common_info_prepare_->set_is_confirmed();
+  bump_generation();
+  if (side_tables().common_info_prepare && mutable_side_tables().common_info_prepare->prefix()) {
+    if (!side_tables().common_info_multi_map) {
+      mutable_side_tables().common_info_multi_map.emplace(*(mutable_side_tables().common_info_prepare->prefix_adlog()), map_name, attr_name);
+      mutable_side_tables().common_info_multi_map->set_env_ptr(this);
+      mutable_side_tables().common_info_prepare->set_is_confirmed();
       LOG(INFO) << "touch common_info_multi_map, prefix_adlog: "
-                << *(common_info_prepare_->prefix_adlog());
+                << *(mutable_side_tables().common_info_prepare->prefix_adlog());
     }
-    return (common_info_multi_map_);
+    return (mutable_side_tables().common_info_multi_map);
   }
 
   if (parent_ != nullptr) {
@@ -1170,18 +1246,19 @@ absl::optional<CommonInfoMultiMap>& Env::touch_common_info_multi_map(const std::
   }
 
   LOG(INFO) << "cannot get common info prefix for multi map!";
-  static absl::optional<CommonInfoMultiMap> empty;
+  static thread_local absl::optional<CommonInfoMultiMap> empty;
   return empty;
 }
 
 absl::optional<CommonInfoMultiIntList>& Env::touch_common_info_multi_int_list() {
-  if (common_info_prepare_ && common_info_prepare_->prefix()) {
-    if (!common_info_multi_int_list_) {
-      common_info_multi_int_list_.emplace(*(common_info_prepare_->prefix_adlog()));
-      common_info_multi_int_list_->set_env_ptr(this);
-      common_info_prepare_->set_is_confirmed();
+  bump_generation();
+  if (side_tables().common_info_prepare && mutable_side_tables().common_info_prepare->prefix()) {
+    if (!side_tables().common_info_multi_int_list) {
+      mutable_side_tables().common_info_multi_int_list.emplace(*(mutable_side_tables().common_info_prepare->prefix_adlog()));
+      mutable_side_tables().common_info_multi_int_list->set_env_ptr(this);
+      mutable_side_tables().common_info_prepare->set_is_confirmed();
       LOG(INFO) << "touch common_info_multi_int_list, prefix_adlog: "
-                << *(common_info_prepare_->prefix_adlog());
+                << *(mutable_side_tables().common_info_prepare->prefix_adlog());
 
       // 从 feature info 中复制 map_vec_connections
       if (auto feature_info = mutable_feature_info()) {
@@ -1189,7 +1266,7 @@ absl::optional<CommonInfoMultiIntList>& Env::touch_common_info_multi_int_list()
           LOG(INFO) << "int_list_info address: " << &(*int_list_info);
           const auto& map_vec_connections = int_list_info->map_vec_connections();
           for (auto it = map_vec_connections.begin(); it != map_vec_connections.end(); it++) {
-            common_info_multi_int_list_->add_map_vec_connection(it->first, it->second);
+            mutable_side_tables().common_info_multi_int_list->add_map_vec_connection(it->first, it->second);
             LOG(INFO) << "copy from feature_info, map_name: " << it->first
                       << ", vec_name: " << it->second;
           }
@@ -1198,11 +1275,11 @@ absl::optional<CommonInfoMultiIntList>& Env::touch_common_info_multi_int_list()
     }
 
     // 目前还区分不了
-    if (common_info_fixed_list_) {
-      common_info_fixed_list_ = absl::nullopt;
+    if (side_tables().common_info_fixed_list) {
+      mutable_side_tables().common_info_fixed_list = absl::nullopt;
     }
 
-    return (common_info_multi_int_list_);
+    return (mutable_side_tables().common_info_multi_int_list);
   }
 
   if (parent_ != nullptr) {
@@ -1210,18 +1287,19 @@ absl::optional<CommonInfoMultiIntList>& Env::touch_common_info_multi_int_list()
   }
 
   LOG(INFO) << "cannot get common info prefix for multi_int_list!";
-  static absl::optional<CommonInfoMultiIntList> empty;
+  static thread_local absl::optional<CommonInfoMultiIntList> empty;
   return empty;
 }
 
 absl::optional<ActionDetailInfo>& Env::touch_action_detail_info(int action) {
-  if (action_detail_prefix_adlog_) {
-    if (!action_detail_info_) {
-      action_detail_info_.emplace(*action_detail_prefix_adlog_, action);
-      action_detail_info_->set_env_ptr(this);
+  bump_generation();
+  if (side_tables().action_detail_prefix_adlog) {
+    if (!side_tables().action_detail_info) {
+      mutable_side_tables().action_detail_info.emplace(*mutable_side_tables().action_detail_prefix_adlog, action);
+      mutable_side_tables().action_detail_info->set_env_ptr(this);
     }
 
-    return (action_detail_info_);
+    return (mutable_side_tables().action_detail_info);
   }
 
   if (parent_ != nullptr) {
@@ -1229,29 +1307,31 @@ absl::optional<ActionDetailInfo>& Env::touch_action_detail_info(int action) {
   }
 
   LOG(INFO) << "cannot find action detail prefix!";
-  static absl::optional<ActionDetailInfo> empty;
+  static thread_local absl::optional<ActionDetailInfo> empty;
   return empty;
 }
 
 absl::optional<ActionDetailInfo>& Env::update_action_detail_info(int action) {
+  bump_generation();
   if (auto& action_detail_info = touch_action_detail_info(action)) {
     action_detail_info->add_action(action);
     return action_detail_info;
   }
 
   LOG(INFO) << "update_action_detail_info faield! cannot find action detail prefix!";
-  static absl::optional<ActionDetailInfo> empty;
+  static thread_local absl::optional<ActionDetailInfo> empty;
   return empty;
 }
 
 absl::optional<ActionDetailFixedInfo>& Env::touch_action_detail_fixed_info(const std::string& action) {
-  if (action_detail_prefix_adlog_) {
-    if (!action_detail_fixed_info_) {
-      action_detail_fixed_info_.emplace(*action_detail_prefix_adlog_, action);
-      action_detail_fixed_info_->set_env_ptr(this);
+  bump_generation();
+  if (side_tables().action_detail_prefix_adlog) {
+    if (!side_tables().action_detail_fixed_info) {
+      mutable_side_tables().action_detail_fixed_info.emplace(*mutable_side_tables().action_detail_prefix_adlog, action);
+      mutable_side_tables().action_detail_fixed_info->set_env_ptr(this);
     }
 
-    return action_detail_fixed_info_;
+    return mutable_side_tables().action_detail_fixed_info;
   }
 
   if (parent_ != nullptr) {
@@ -1259,67 +1339,80 @@ absl::optional<ActionDetailFixedInfo>& Env::touch_action_detail_fixed_info(const
   }
 
   LOG(INFO) << "cannot find action detail prefix!";
-  static absl::optional<ActionDetailFixedInfo> empty;
+  static thread_local absl::optional<ActionDetailFixedInfo> empty;
   return empty;
 }
 
 absl::optional<SeqListInfo>& Env::touch_seq_list_info(const std::string& root_name) {
-  if (!seq_list_info_) {
-    seq_list_info_.emplace(root_name);
+  bump_generation();
+  if (!side_tables().seq_list_info) {
+    mutable_side_tables().seq_list_info.emplace(root_name);
   }
 
-  return seq_list_info_;
+  return mutable_side_tables().seq_list_info;
 }
 
 absl::optional<ProtoListInfo> & Env::touch_proto_list_info(const std::string &prefix_adlog) {
-  if (!proto_list_info_) {
-    proto_list_info_.emplace(prefix_adlog);
+  bump_generation();
+  if (!side_tables().proto_list_info) {
+    mutable_side_tables().proto_list_info.emplace(prefix_adlog);
   }
 
-  return proto_list_info_;
+  return mutable_side_tables().proto_list_info;
 }
 
 absl::optional<BSFieldInfo>& Env::touch_bs_field_info(const std::string& bs_var_name) {
+  bump_generation();
   if (decl_stmts_.find(bs_var_name) != decl_stmts_.end()) {
-    if (!bs_field_info_) {
-      bs_field_info_.emplace();
+    if (!side_tables().bs_field_info) {
+      mutable_side_tables().bs_field_info.emplace();
     }
 
-    return bs_field_info_;
+    return mutable_side_tables().bs_field_info;
   }
 
   if (parent_ != nullptr) {
     return parent_->touch_bs_field_info(bs_var_name);
   }
 
-  return bs_field_info_;
+  // 找不到时返回空值，不需要为此分配 side tables。
+  if (side_tables_ == nullptr) {
+    static const absl::optional<BSFieldInfo> empty;
+    return const_cast<absl::optional<BSFieldInfo>&>(empty);
+  }
+
+  return side_tables_->bs_field_info;
 }
 
 void Env::add_middle_node_name(const std::string& name) {
-  middle_node_info_.emplace(name);
+  bump_generation();
+  mutable_side_tables().middle_node_info.emplace(name);
 }
 
 void Env::set_feature_info(FeatureInfo* feature_info) {
+  bump_generation();
   feature_info_ = feature_info;
 }
 
 void Env::set_constructor_info(ConstructorInfo* constructor_info) {
+  bump_generation();
   constructor_info_ = constructor_info;
 }
 
 void Env::set_common_info_prefix_adlog(const std::string& prefix_adlog) {
-  common_info_prepare_.emplace(prefix_adlog);
+  bump_generation();
+  mutable_side_tables().common_info_prepare.emplace(prefix_adlog);
   if (auto feature_info = mutable_feature_info()) {
     if (const auto& info_prepare = feature_info->common_info_prepare()) {
-      common_info_prepare_->set_template_int_names(info_prepare->template_int_names());
-      common_info_prepare_->set_common_info_values(info_prepare->common_info_values());
+      mutable_side_tables().common_info_prepare->set_template_int_names(info_prepare->template_int_names());
+      mutable_side_tables().common_info_prepare->set_common_info_values(info_prepare->common_info_values());
     }
   }
 }
 
 const absl::optional<std::string>& Env::common_info_prefix() const {
-  if (common_info_prepare_) {
-    return common_info_prepare_->prefix();
+  if (side_tables().common_info_prepare) {
+    return side_tables().common_info_prepare->prefix();
   }
 
   static absl::optional<std::string> empty;
@@ -1327,8 +1420,8 @@ const absl::optional<std::string>& Env::common_info_prefix() const {
 }
 
 const absl::optional<std::string>& Env::get_common_info_prefix() const {
-  if (common_info_prepare_) {
-    return common_info_prepare_->prefix();
+  if (side_tables().common_info_prepare) {
+    return side_tables().common_info_prepare->prefix();
   }
 
   if (parent_ != nullptr) {
@@ -1340,18 +1433,20 @@ const absl::optional<std::string>& Env::get_common_info_prefix() const {
 }
 
 void Env::update_template_common_info_values() {
-  if (common_info_normal_) {
+  bump_generation();
+  if (side_tables().common_info_normal) {
     if (const auto& feature_info = get_feature_info()) {
-      if (Env* parent_env_ptr = common_info_normal_->parent_env_ptr()) {
+      if (Env* parent_env_ptr = mutable_side_tables().common_info_normal->parent_env_ptr()) {
         if (feature_info->is_template()) {
           const std::set<int>& values = feature_info->template_common_info_values();
           for (int value: values) {
-            if (common_info_normal_->is_already_exists(value)) {
+            if (mutable_side_tables().common_info_normal->is_already_exists(value)) {
               continue;
             }
-            common_info_normal_->add_common_info_value(value);
-            const auto& common_info_detail = common_info_normal_->last_common_info_detail();
+            mutable_side_tables().common_info_normal->add_common_info_value(value);
+            const auto& common_info_detail = mutable_side_tables().common_info_normal->last_common_info_detail();
             parent_env_ptr->add_common_info_detail_def(*common_info_detail);
+            add_common_info_field_access(*common_info_detail);
           }
         }
       }
@@ -1360,6 +1455,7 @@ void Env::update_template_common_info_values() {
 }
 
 void Env::add_common_info_detail_def(const CommonInfoLeaf& common_info_detail) {
+  bump_generation();
   std::string bs_enum_str = common_info_detail.get_bs_enum_str();
   if (bs_enum_str.size() == 0) {
     LOG(INFO) << "cannot get bs_enum_str from common_info_detail!";
@@ -1437,19 +1533,22 @@ void Env::add_common_info_detail_def(const CommonInfoLeaf& common_info_detail) {
                                       common_info_detail.get_exists_functor_name(),
                                       common_info_detail.get_bs_scalar_exists_field_def(this),
                                       NewVarType::SCALAR,
-                                      AdlogVarType::COMMON_INFO_MIDDLE_NODE);
+                                      AdlogVarType::COMMON_INFO_MIDDLE_NODE,
+                                      is_in_loop());
         } else if (common_info_detail.is_list() || common_info_detail.is_list_size()) {
           feature_info->add_field_def(common_info_detail.get_bs_enum_str(),
                                       common_info_detail.get_functor_name(),
                                       common_info_detail.get_bs_list_field_def(this),
                                       NewVarType::LIST,
-                                      AdlogVarType::COMMON_INFO_MIDDLE_NODE);
+                                      AdlogVarType::COMMON_INFO_MIDDLE_NODE,
+                                      is_in_loop());
         } else if (common_info_detail.is_map() || common_info_detail.is_map_size()) {
           feature_info->add_field_def(common_info_detail.get_bs_enum_str(),
                                       common_info_detail.get_functor_name(),
                                       common_info_detail.get_bs_map_field_def(this),
                                       NewVarType::MAP,
-                                      AdlogVarType::COMMON_INFO_MIDDLE_NODE);
+                                      AdlogVarType::COMMON_INFO_MIDDLE_NODE,
+                                      is_in_loop());
         }
 
         if (const auto& name_value_alias = common_info_detail.name_value_alias()) {
@@ -1463,20 +1562,29 @@ void Env::add_common_info_detail_def(const CommonInfoLeaf& common_info_detail) {
 }
 
 void Env::clear_common_info_fixed_list() {
-  if (auto& common_info_fixed_list = mutable_common_info_fixed_list()) {
-    common_info_fixed_list = absl::nullopt;
+  bump_generation();
+  // 和 get_info 一样从当前 Env 向上查找，没有分配 side tables 的 Env 直接跳过。
+  for (Env* env = this; env != nullptr; env = env->parent_) {
+    if (env->side_tables_ != nullptr && env->side_tables_->common_info_fixed_list) {
+      env->side_tables_->common_info_fixed_list = absl::nullopt;
+      return;
+    }
   }
 }
 
 void Env::add_ctor_decls(const VarDeclInfo& var_decl_info) {
+  bump_generation();
   const std::unordered_map<std::string, DeclInfo>& var_decls = var_decl_info.var_decls();
   for (auto it = var_decls.begin(); it != var_decls.end(); it++) {
     LOG(INFO) << "add ctor decl, name: " << it->first << ", v: " << stmt_to_string(it->second.init_expr());
-    var_decls_.emplace(it->first, it->second.init_expr());
+    if (var_decls_.emplace(it->first, it->second.init_expr()).second) {
+      symbol_table_->bind(scope_, SymKind::VAR_DECL, it->first, this, it->second.init_expr());
+    }
   }
 }
 
 void Env::update(clang::DeclStmt* decl_stmt) {
+  bump_generation();
   clang::VarDecl* var_decl = dyn_cast<clang::VarDecl>(decl_stmt->getSingleDecl());
   if (var_decl == nullptr) {
     return;
@@ -1522,6 +1630,7 @@ void Env::update(clang::DeclStmt* decl_stmt) {
 }
 
 void Env::update(clang::IfStmt* if_stmt) {
+  bump_generation();
   set_is_if(true);
   set_if_stmt(if_stmt);
   if_info_.emplace(if_stmt);
@@ -1532,6 +1641,7 @@ void Env::update(clang::IfStmt* if_stmt) {
 }
 
 void Env::update(clang::ForStmt* for_stmt) {
+  bump_generation();
   set_for_stmt(for_stmt);
   set_is_loop(true);
   loop_info_.emplace(for_stmt);
@@ -1539,6 +1649,7 @@ void Env::update(clang::ForStmt* for_stmt) {
 }
 
 void Env::update(clang::CXXForRangeStmt* cxx_for_range_stmt) {
+  bump_generation();
   set_cxx_for_range_stmt(cxx_for_range_stmt);
   set_is_loop(true);
   loop_info_.emplace(cxx_for_range_stmt);
@@ -1546,6 +1657,7 @@ void Env::update(clang::CXXForRangeStmt* cxx_for_range_stmt) {
 }
 
 void Env::update(clang::BinaryOperator* binary_operator) {
+  bump_generation();
   std::string op = binary_operator->getOpcodeStr().str();
 
   binary_op_info_.emplace(op, binary_operator->getLHS(), binary_operator->getRHS());
@@ -1556,12 +1668,15 @@ void Env::update(clang::BinaryOperator* binary_operator) {
 
   if (op == "=") {
     if (binary_op_info_->left_expr_str() != binary_op_info_->right_expr_str()) {
-      var_decls_[binary_op_info_->left_expr_str()] = binary_operator->getRHS();
+      std::string left_expr_str = binary_op_info_->left_expr_str();
+      var_decls_[left_expr_str] = binary_operator->getRHS();
+      symbol_table_->bind(scope_, SymKind::VAR_DECL, left_expr_str, this, binary_operator->getRHS());
     }
   }
 }
 
 void Env::update(clang::CXXOperatorCallExpr* cxx_operator_call_expr) {
+  bump_generation();
   std::string op = stmt_to_string(cxx_operator_call_expr->getCallee());
 
   if (cxx_operator_call_expr->getNumArgs() == 2) {
@@ -1591,12 +1706,14 @@ void Env::update(clang::CXXOperatorCallExpr* cxx_operator_call_expr) {
 }
 
 void Env::update(clang::CaseStmt* case_stmt) {
-  switch_case_info_.emplace(case_stmt);
+  bump_generation();
+  mutable_side_tables().switch_case_info.emplace(case_stmt);
 }
 
 void Env::update_assign_info(clang::BinaryOperator* binary_operator) {
+  bump_generation();
   std::string name = stmt_to_string(binary_operator->getLHS());
-  assign_info_.emplace(name, binary_operator->getLHS(), binary_operator->getRHS());
+  mutable_side_tables().assign_info.emplace(name, binary_operator->getLHS(), binary_operator->getRHS());
 }
 
 absl::optional<std::string> Env::get_template_int_name(clang::Expr* init_expr) const {
@@ -1632,6 +1749,7 @@ bool Env::is_reco_user_info() const {
 }
 
 void Env::set_is_reco_user_info(bool v) {
+  bump_generation();
   if (parent_ == nullptr) {
     is_reco_user_info_ = v;
     return;
@@ -1658,16 +1776,19 @@ bool Env::is_feature_other_method(const std::string& method_name) const {
 }
 
 void Env::add_action_param_new_def(const std::string& prefix, const NewActionParam& new_action_param) {
+  bump_generation();
   const auto new_params = new_action_param.new_params();
   for (size_t i = 0; i < new_params.size(); i++) {
     if (new_params[i].field() == "size") {
       add_new_def_meta(new_params[i].get_bs_enum_str(prefix),
                       new_params[i].get_new_def(prefix, this),
                       NewVarType::SCALAR);
+      add_field_access(new_params[i].get_bs_enum_str(prefix), NewVarType::SCALAR);
     } else {
       add_new_def_meta(new_params[i].get_bs_enum_str(prefix),
                       new_params[i].get_new_def(prefix, this),
                       NewVarType::LIST);
+      add_field_access(new_params[i].get_bs_enum_str(prefix), NewVarType::LIST);
     }
   }
 }
@@ -1689,6 +1810,7 @@ const FeatureInfo* Env::get_feature_info() const {
 }
 
 ConstructorInfo* Env::mutable_constructor_info() {
+  bump_generation();
   if (parent_ == nullptr) {
     return constructor_info_;
   }
@@ -1697,6 +1819,7 @@ ConstructorInfo* Env::mutable_constructor_info() {
 }
 
 FeatureInfo* Env::mutable_feature_info() {
+  bump_generation();
   if (parent_ == nullptr) {
     return feature_info_;
   }
@@ -1832,8 +1955,9 @@ bool Env::is_bslog_field_var_decl(const std::string& var_name) const {
 std::unordered_map<std::string, BSFieldDetail> * Env::find_bs_field_detail_ptr_by_var_name(
   const std::string &var_name
 ) {
-  if (bs_field_info_) {
-    auto& map_field_detail = bs_field_info_->mutable_map_bs_field_detail();
+  bump_generation();
+  if (side_tables().bs_field_info) {
+    auto& map_field_detail = mutable_side_tables().bs_field_info->mutable_map_bs_field_detail();
     if (map_field_detail.find(var_name) != map_field_detail.end()) {
       return &map_field_detail;
     }
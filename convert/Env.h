@@ -1,7 +1,9 @@
 #pragma once
 
 #include <absl/types/optional.h>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
@@ -17,6 +19,7 @@
 #include "clang/AST/ASTConsumer.h"
 
 #include "Traits.h"
+#include "ScopedSymbolTable.h"
 #include "./info/Info.h"
 #include "./info/IfInfo.h"
 #include "./info/DeclInfo.h"
@@ -34,6 +37,99 @@ namespace ks {
 namespace ad_algorithm {
 namespace convert {
 
+/// `Env` 中大部分节点都用不到的信息。
+///
+/// 每个 `if`、`for` 都会创建一个 `Env`, 而 `common info`、`action_detail`、新增变量定义等信息只有
+/// 少数节点会用到。这些信息放在单独的结构中，第一次修改时才创建，其余节点只需要一个空指针。
+struct EnvSideTables {
+  /// 当前 `Env` 直到 `root Env` 使用过的变量名，用于在插入新增变量时检查变量名是否重复。
+  std::unordered_set<Symbol> used_var_names;
+
+  /// 特征名。
+  std::string feature_name;
+
+  /// 特征类型。
+  std::string feature_type;
+
+  /// action 表达式对应的 `bs` 表达式。
+  std::string bs_action_expr;
+
+  /// action 表达式对应的叶子字段。
+  ///
+  /// `action_detail_info` 中 `map` 保存的是 `message` 结构，取叶子节点需要通过嵌套结构进行获取。
+  ///
+  /// 示例:
+  /// ```cpp
+  /// int no = 1;
+  /// const auto& ad_action = adlog.user_info().explore_long_term_ad_action();
+  /// auto action_no_iter = ad_action.find(no);
+  /// if (action_no_iter != ad_action.end()) {
+  ///   const auto& action_no_list = action_no_iter->second.list();
+  ///   for (int k = 0; k < action_no_list.size() && k < 100; ++k) {
+  ///     uint64_t photo_id = action_no_list[k].photo_id();
+  ///     ...
+  ///   }
+  /// }
+  /// ```
+  std::vector<std::string> action_leaf_fields;
+
+  /// 循环表达式。
+  std::vector<clang::Expr *> loop_exprs;
+
+  /// 删除过的变量名。
+  std::set<std::string> deleted_vars;
+
+  /// 新增变量定义。
+  ///
+  /// 用于中间节点逻辑插入新的 `field` 定义。
+  std::map<std::string, absl::optional<NewVarDef>> new_defs;
+
+  /// adlog.user_info.xxx 这种格式, 创建 ActionDetailInfo 时候再转换。
+  absl::optional<std::string> action_detail_prefix_adlog;
+
+  /// switch case 信息。
+  absl::optional<SwitchCaseInfo> switch_case_info;
+
+  /// 赋值信息。
+  absl::optional<AssignInfo> assign_info;
+
+  /// `action_detail` 字段相关信息。
+  absl::optional<ActionDetailInfo> action_detail_info;
+
+  /// 通过模板参数传递的 `action number` 对应的 `action_detail` 字段固定信息。
+  absl::optional<ActionDetailFixedInfo> action_detail_fixed_info;
+
+  /// 普通 `common info` 信息。如 `common info` 枚举等。
+  absl::optional<CommonInfoNormal> common_info_normal;
+
+  /// 多个 `common info` 保存到 `vector` 中对应的信息。
+  absl::optional<CommonInfoMultiMap> common_info_multi_map;
+
+  /// 多个 `common info` `int list` 对应的信息。
+  absl::optional<CommonInfoMultiIntList> common_info_multi_int_list;
+
+  /// `common info` 对应的枚举通过模板参数传递对应的信息。
+  absl::optional<CommonInfoFixed> common_info_fixed;
+
+  /// 多个 `common info` 对应的枚举通过模板参数传递。
+  absl::optional<CommonInfoFixedList> common_info_fixed_list;
+
+  /// 用于枚举可能通过参数传递而出现在后面的情况，需要先创建 `common info` 部分信息，之后再更新枚举等。
+  absl::optional<CommonInfoPrepare> common_info_prepare;
+
+  /// `PhotoInfo` 等中间节点信息。
+  absl::optional<MiddleNodeInfo> middle_node_info;
+
+  /// `protobuf` `repeated` 字段对应的信息。
+  absl::optional<SeqListInfo> seq_list_info;
+
+  /// `photo_list` 固定字段对应的信息。
+  absl::optional<ProtoListInfo> proto_list_info;
+
+  /// `proto` 字段对应的 `bs` 字段信息。
+  absl::optional<BSFieldInfo> bs_field_info;
+};
+
 /// 保存解析 `ast` 节点时获取的各种信息，用于之后的改写。
 ///
 /// 由于不同的改写规则需要不同的信息，而解析 `ast` 时并不知道此信息是用于哪个改写规则，因此
@@ -46,20 +142,32 @@ namespace convert {
 /// 是在 find(no) 中。不同的信息格式不一样，每种信息对应了一个 struct。详细的 info 定义可参考 `info/Info.h`。
 class Env {
  private:
+  /// 所有 `Env` 的修改次数，每个线程一个，见 `generation`。
+  static thread_local uint64_t generation_;
+
   /// 父节点 `Env`，用于保存代码的递归结构信息。
   Env *parent_ = nullptr;
 
   /// 子节点。
   std::vector<Env *> children_;
 
-  /// 当前 `Env` 直到 `root Env` 使用过的变量名，用于在插入新增变量时检查变量名是否重复。
-  std::unordered_set<std::string> used_var_names_;
+  /// 变量名查找用的符号表，由根节点创建，子节点共享。
+  std::unique_ptr<ScopedSymbolTable> own_symbol_table_;
+  ScopedSymbolTable* symbol_table_ = nullptr;
 
-  /// 特征名。
-  std::string feature_name_;
+  /// 当前 `Env` 在符号表中对应的 scope。
+  ScopedSymbolTable::ScopeId scope_ = 0;
 
-  /// 特征类型。
-  std::string feature_type_;
+  /// 不常用的信息，见 `EnvSideTables`。
+  std::unique_ptr<EnvSideTables> side_tables_;
+
+  /// 缓存的根节点、最近的循环节点以及最外层的循环和 `if` 节点，避免每次沿着 `parent` 查找。
+  ///
+  /// 在创建时以及 `set_is_loop`、`set_is_if` 时更新，这两个方法都是在创建子节点之前调用的。
+  Env* root_ = nullptr;
+  Env* loop_env_ = nullptr;
+  Env* outer_loop_ = nullptr;
+  Env* outer_if_ = nullptr;
 
   /// 是否是循环。
   bool is_loop_ = false;
@@ -87,37 +195,12 @@ class Env {
   /// ```
   clang::Expr *action_expr_ = nullptr;
 
-  /// action 表达式对应的 `bs` 表达式。
-  std::string bs_action_expr_;
-
-  /// action 表达式对应的叶子字段。
-  ///
-  /// `action_detail_info` 中 `map` 保存的是 `message` 结构，取叶子节点需要通过嵌套结构进行获取。
-  ///
-  /// 示例:
-  /// ```cpp
-  /// int no = 1;
-  /// const auto& ad_action = adlog.user_info().explore_long_term_ad_action();
-  /// auto action_no_iter = ad_action.find(no);
-  /// if (action_no_iter != ad_action.end()) {
-  ///   const auto& action_no_list = action_no_iter->second.list();
-  ///   for (int k = 0; k < action_no_list.size() && k < 100; ++k) {
-  ///     uint64_t photo_id = action_no_list[k].photo_id();
-  ///     ...
-  ///   }
-  /// }
-  /// ```
-  std::vector<std::string> action_leaf_fields_;
-
   /// 出现过的变量声明。`key` 是变量名，`value` 是解析的 `clang::Expr` 表达式。
   std::map<std::string, clang::Expr *> var_decls_;
 
   /// 循环变量名。
   std::vector<std::string> loop_var_names_;
 
-  /// 循环表达式。
-  std::vector<clang::Expr *> loop_exprs_;
-
   /// common attr 枚举 int 值。
   int common_attr_int_value_ = 0;
 
@@ -130,9 +213,6 @@ class Env {
   /// 出现过的变量声明。`key` 是变量名，`value` 是解析的 `clang::DeclStmt` 表达式。
   std::map<std::string, clang::DeclStmt *> decl_stmts_;
 
-  /// 删除过的变量名。
-  std::set<std::string> deleted_vars_;
-
   /// `c++` `for range` 循环表达式。
   clang::CXXForRangeStmt *cxx_for_range_stmt_ = nullptr;
 
@@ -174,14 +254,6 @@ class Env {
   /// 方法名。
   std::string method_name_;
 
-  /// 新增变量定义。
-  ///
-  /// 用于中间节点逻辑插入新的 `field` 定义。
-  std::map<std::string, absl::optional<NewVarDef>> new_defs_;
-
-  /// adlog.user_info.xxx 这种格式, 创建 ActionDetailInfo 时候再转换。
-  absl::optional<std::string> action_detail_prefix_adlog_;
-
   /// `if` 语句信息。
   absl::optional<IfInfo> if_info_;
 
@@ -194,48 +266,6 @@ class Env {
   /// 二元操作信息。
   absl::optional<BinaryOpInfo> binary_op_info_;
 
-  /// switch case 信息。
-  absl::optional<SwitchCaseInfo> switch_case_info_;
-
-  /// 赋值信息。
-  absl::optional<AssignInfo> assign_info_;
-
-  /// `action_detail` 字段相关信息。
-  absl::optional<ActionDetailInfo> action_detail_info_;
-
-  /// 通过模板参数传递的 `action number` 对应的 `action_detail` 字段固定信息。
-  absl::optional<ActionDetailFixedInfo> action_detail_fixed_info_;
-
-  /// 普通 `common info` 信息。如 `common info` 枚举等。
-  absl::optional<CommonInfoNormal> common_info_normal_;
-
-  /// 多个 `common info` 保存到 `vector` 中对应的信息。
-  absl::optional<CommonInfoMultiMap> common_info_multi_map_;
-
-  /// 多个 `common info` `int list` 对应的信息。
-  absl::optional<CommonInfoMultiIntList> common_info_multi_int_list_;
-
-  /// `common info` 对应的枚举通过模板参数传递对应的信息。
-  absl::optional<CommonInfoFixed> common_info_fixed_;
-
-  /// 多个 `common info` 对应的枚举通过模板参数传递。
-  absl::optional<CommonInfoFixedList> common_info_fixed_list_;
-
-  /// 用于枚举可能通过参数传递而出现在后面的情况，需要先创建 `common info` 部分信息，之后再更新枚举等。
-  absl::optional<CommonInfoPrepare> common_info_prepare_;
-
-  /// `PhotoInfo` 等中间节点信息。
-  absl::optional<MiddleNodeInfo> middle_node_info_;
-
-  /// `protobuf` `repeated` 字段对应的信息。
-  absl::optional<SeqListInfo> seq_list_info_;
-
-  /// `photo_list` 固定字段对应的信息。
-  absl::optional<ProtoListInfo> proto_list_info_;
-
-  /// `proto` 字段对应的 `bs` 字段信息。
-  absl::optional<BSFieldInfo> bs_field_info_;
-
   /// 特征构造函数相关信息。只保留其指针，用于修改其内容。
   ConstructorInfo *constructor_info_ = nullptr;
 
@@ -243,12 +273,25 @@ class Env {
   FeatureInfo *feature_info_ = nullptr;
 
  public:
-  Env() = default;
+  Env();
 
   /// 创建 `Env` 节点。传递其父节点作为参数。
-  explicit Env(Env* parent): parent_(parent) {
-    parent_->add_child(this);
-  }
+  explicit Env(Env* parent);
+
+  ~Env();
+
+  Env(const Env&) = delete;
+  Env& operator=(const Env&) = delete;
+
+  /// 当前线程所有 `Env` 的修改次数。
+  ///
+  /// 非 `const` 的方法修改 `Env` 或者返回可以修改的信息时都会增加, 包括 `FeatureInfo`、`ConstructorInfo`
+  /// 的指针。只返回其他 `Env` 的方法不增加，修改其他 `Env` 时由其自己的方法增加。用于判断 `parse_expr`
+  /// 缓存的结果是否还有效，见 `ParseExprScope`。
+  static uint64_t generation() { return generation_; }
+
+  /// 增加修改次数，使之前缓存的 `parse_expr` 结果失效。
+  static void bump_generation() { generation_++; }
 
   /// 获取当前 `Env` 中所有变量声明。
   const std::map<std::string, clang::Expr*>& var_decls() const { return var_decls_; }
@@ -312,7 +355,7 @@ class Env {
   bool is_loop() const { return is_loop_; }
 
   /// 设置当前 `Env` 是否是循环。
-  void set_is_loop(bool is_loop) { is_loop_ = is_loop; }
+  void set_is_loop(bool is_loop);
 
   /// 获取循环 `Env` 的 `const` 父节点。
   ///
@@ -347,7 +390,7 @@ class Env {
   Env *mutable_outer_if_parent();
 
   /// 获取循环 `Env`。
-  const Env* get_loop_env() const;
+  const Env* get_loop_env() const { return loop_env_; }
 
   /// 获取循环 `Env` 的可变版本。
   Env* mutable_loop_env();
@@ -395,7 +438,10 @@ class Env {
   int if_index() const { return if_index_; }
 
   /// 增加 `if` 语句索引。
-  void increase_if_index() { if_index_++; }
+  void increase_if_index() {
+    bump_generation();
+    if_index_++;
+  }
 
   /// 当前 `Env` 是否是在 `if` 语句中。
   bool is_in_if() const;
@@ -521,7 +567,7 @@ class Env {
   bool add_deleted_var_by_expr_str(const std::string& expr_str);
 
   /// 获取删除的变量。
-  const std::set<std::string>& deleted_vars() const { return deleted_vars_; }
+  const std::set<std::string>& deleted_vars() const { return side_tables().deleted_vars; }
 
   /// 删除变量。用于删除改写后不再需要的 `proto` 变量相关逻辑。
   void pop_deleted_var(const std::string& name);
@@ -589,6 +635,15 @@ class Env {
   /// 添加 `bs_enum_str` 作为 `meta` 信息。
   void add_attr_meta(const std::string& bs_enum_str);
 
+  /// 记录 `bs_enum_str` 的访问方式以及是否在循环中，见 FeatureInfo::add_field_access。
+  ///
+  /// 是否在循环中由当前 env 判断，因此必须用表达式所在的 env 调用，不能用定义所在的 parent env。
+  /// 不是 adlog 字段的会跳过。
+  void add_field_access(const std::string& bs_enum_str, absl::optional<NewVarType> new_var_type);
+
+  /// 记录 common info 字段的访问方式，map 同时记录 `_key` 和 `_value`, 同 add_common_info_detail_def。
+  void add_common_info_field_access(const CommonInfoLeaf& common_info_detail);
+
   /// 添加字段详细信息，包括:
   /// 1. adlog_field, 如: adlog.user_info.id
   /// 2. bs_field_enum, 如: adlog_user_info_id
@@ -612,7 +667,7 @@ class Env {
   absl::optional<NewVarDef>& find_mutable_new_def(const std::string& bs_enum_str);
 
   /// 获取所有新的变量定义。用于最后添加代码。
-  const std::map<std::string, absl::optional<NewVarDef>>& new_defs() const { return new_defs_; }
+  const std::map<std::string, absl::optional<NewVarDef>>& new_defs() const { return side_tables().new_defs; }
 
   /// 根据字符串拼接规则查找有效的新的变量名。
   std::string find_valid_new_name(const std::string& bs_enum_str) const;
@@ -639,25 +694,37 @@ class Env {
   std::string get_all_new_defs() const;
 
   /// 设置第一个 `if` 语句。
-  void set_first_if_stmt(clang::IfStmt* if_stmt) { first_if_stmt_ = if_stmt; }
+  void set_first_if_stmt(clang::IfStmt* if_stmt) {
+    bump_generation();
+    first_if_stmt_ = if_stmt;
+  }
 
   /// 获取第一个 `if` 语句。
   clang::IfStmt* first_if_stmt() const { return first_if_stmt_; }
 
   /// 设置是否是第一个 `if` 语句的 item 位置条件检查。
-  void set_is_first_if_check_item_pos_cond(bool v) { is_first_if_check_item_pos_cond_ = v; }
+  void set_is_first_if_check_item_pos_cond(bool v) {
+    bump_generation();
+    is_first_if_check_item_pos_cond_ = v;
+  }
 
   /// 是否是第一个 `if` 语句的 item 位置条件检查。
   bool is_first_if_check_item_pos_cond() const { return is_first_if_check_item_pos_cond_; }
 
   /// 设置是否是第一个 `if` 语句的 item 位置条件检查包含其他逻辑。
-  void set_is_first_if_check_item_pos_include_cond(bool v) { is_first_if_check_item_pos_include_cond_ = v; }
+  void set_is_first_if_check_item_pos_include_cond(bool v) {
+    bump_generation();
+    is_first_if_check_item_pos_include_cond_ = v;
+  }
 
   /// 第一个 `if` 语句的 item 位置条件检查是否包含其他逻辑。
   bool is_first_if_check_item_pos_include_cond() const { return is_first_if_check_item_pos_include_cond_; }
 
   /// 设置 action number。
-  void set_action(int action) { action_ = action; }
+  void set_action(int action) {
+    bump_generation();
+    action_ = action;
+  }
 
   /// 获取 action number。
   int get_action();
@@ -723,7 +790,7 @@ class Env {
   /// 在 `photo list` 第一次出现的地方创建 `ProtoListInfo` 信息。
   absl::optional<ProtoListInfo>& touch_proto_list_info(const std::string& prefix_adlog);
 
-  /// 在 `bs field` 第一次出现的地方创建 `BSFieldInfo` 信息。
+  /// 在 `bs field` 第一次出现的地方创建 `BSFieldInfo` 信息。找不到 `bs_var_name` 的定义时返回空值，不能修改。
   absl::optional<BSFieldInfo>& touch_bs_field_info(const std::string& bs_var_name);
 
   /// 设置 `common_info` 前缀。
@@ -765,7 +832,10 @@ class Env {
   const std::string& method_name() const { return method_name_; }
 
   /// 设置方法名。
-  void set_method_name(const std::string& method_name) { method_name_ = method_name; }
+  void set_method_name(const std::string& method_name) {
+    bump_generation();
+    method_name_ = method_name;
+  }
 
   /// 是否是 feature 其他方法。
   bool is_feature_other_method(const std::string& method_name) const;
@@ -804,7 +874,7 @@ class Env {
   const absl::optional<LoopInfo>& cur_loop_info() const { return loop_info_; }
 
   /// 当前 `Env` 的 `const` `switch case` 信息。
-  const absl::optional<SwitchCaseInfo>& cur_switch_case_info() const { return switch_case_info_; }
+  const absl::optional<SwitchCaseInfo>& cur_switch_case_info() const { return side_tables().switch_case_info; }
 
   /// 当前 `Env` 的 `const` `Decl` 信息。
   const absl::optional<DeclInfo>& cur_decl_info() const { return decl_info_; }
@@ -813,221 +883,245 @@ class Env {
   const absl::optional<BinaryOpInfo>& cur_binary_op_info() const { return binary_op_info_; }
 
   /// 当前 `Env` 的 `const` `AssignInfo` 信息。
-  const absl::optional<AssignInfo>& cur_assign_info() const { return assign_info_; }
+  const absl::optional<AssignInfo>& cur_assign_info() const { return side_tables().assign_info; }
 
   /// 当前 `Env` 的 `const` `ActionDetailInfo` 信息。
-  const absl::optional<ActionDetailInfo>& cur_action_detail_info() const { return action_detail_info_; }
+  const absl::optional<ActionDetailInfo>& cur_action_detail_info() const { return side_tables().action_detail_info; }
 
   /// 当前 `Env` 的 `const` `ActionDetailFixedInfo` 信息。
   const absl::optional<ActionDetailFixedInfo>& cur_action_detail_fixed_info() const {
-    return action_detail_fixed_info_;
+    return side_tables().action_detail_fixed_info;
   }
 
   /// 当前 `Env` 的 `const` `CommonInfoNormal` 信息。
-  const absl::optional<CommonInfoNormal>& cur_common_info_normal() const { return common_info_normal_; }
+  const absl::optional<CommonInfoNormal>& cur_common_info_normal() const { return side_tables().common_info_normal; }
 
   /// 当前 `Env` 的 `const` `CommonInfoMultiMap` 信息。
   const absl::optional<CommonInfoMultiMap>& cur_common_info_multi_map() const {
-    return common_info_multi_map_;
+    return side_tables().common_info_multi_map;
   }
 
   /// 当前 `Env` 的 `const` `CommonInfoMultiIntList` 信息。
   const absl::optional<CommonInfoMultiIntList>& cur_common_info_multi_int_list() const {
-    return common_info_multi_int_list_;
+    return side_tables().common_info_multi_int_list;
   }
 
   /// 当前 `Env` 的 `const` `CommonInfoFixed` 信息。
-  const absl::optional<CommonInfoFixed>& cur_common_info_fixed() const { return common_info_fixed_; }
+  const absl::optional<CommonInfoFixed>& cur_common_info_fixed() const { return side_tables().common_info_fixed; }
 
   /// 当前 `Env` 的 `const` `CommonInfoFixedList` 信息。
   const absl::optional<CommonInfoFixedList>& cur_common_info_fixed_list() const {
-    return common_info_fixed_list_;
+    return side_tables().common_info_fixed_list;
   }
 
   /// 当前 `Env` 的 `const` `CommonInfoPrepare` 信息。
-  const absl::optional<CommonInfoPrepare>& cur_common_info_prepare() const { return common_info_prepare_; }
+  const absl::optional<CommonInfoPrepare>& cur_common_info_prepare() const { return side_tables().common_info_prepare; }
 
   /// 当前 `Env` 的 `const` `MiddleNodeInfo` 信息。
-  const absl::optional<MiddleNodeInfo>& cur_middle_node_info() const { return middle_node_info_; }
+  const absl::optional<MiddleNodeInfo>& cur_middle_node_info() const { return side_tables().middle_node_info; }
 
   /// 当前 `Env` 的 `const` `SeqListInfo` 信息。
-  const absl::optional<SeqListInfo>& cur_seq_list_info() const { return seq_list_info_; }
+  const absl::optional<SeqListInfo>& cur_seq_list_info() const { return side_tables().seq_list_info; }
 
   /// 当前 `Env` 的 `const` `ProtoListInfo` 信息。
-  const absl::optional<ProtoListInfo>& cur_proto_list_info() const { return proto_list_info_; }
+  const absl::optional<ProtoListInfo>& cur_proto_list_info() const { return side_tables().proto_list_info; }
 
   /// 当前 `Env` 的 `const` `BSFieldInfo` 信息。
-  const absl::optional<BSFieldInfo>& cur_bs_field_info() const { return bs_field_info_; }
+  const absl::optional<BSFieldInfo>& cur_bs_field_info() const { return side_tables().bs_field_info; }
 
 
   /// 当前 `Env` 的 `mutable` `if` 信息。
-  absl::optional<IfInfo>& cur_mutable_if_info() { return if_info_; }
+  absl::optional<IfInfo>& cur_mutable_if_info() {
+    bump_generation();
+    return if_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `loop` 信息。
-  absl::optional<LoopInfo>& cur_mutable_loop_info() { return loop_info_; }
+  absl::optional<LoopInfo>& cur_mutable_loop_info() {
+    bump_generation();
+    return loop_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `switch case` 信息。
-  absl::optional<SwitchCaseInfo>& cur_mutable_switch_case_info() { return switch_case_info_; }
+  absl::optional<SwitchCaseInfo>& cur_mutable_switch_case_info() { return mutable_side_tables().switch_case_info; }
 
   /// 当前 `Env` 的 `mutable` `Decl` 信息。
-  absl::optional<DeclInfo>& cur_mutable_decl_info() { return decl_info_; }
+  absl::optional<DeclInfo>& cur_mutable_decl_info() {
+    bump_generation();
+    return decl_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `BinaryOperator` 信息。
-  absl::optional<BinaryOpInfo>& cur_mutable_binary_op_info() { return binary_op_info_; }
+  absl::optional<BinaryOpInfo>& cur_mutable_binary_op_info() {
+    bump_generation();
+    return binary_op_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `AssignInfo` 信息。
-  absl::optional<AssignInfo>& cur_mutable_assign_info() { return assign_info_; }
+  absl::optional<AssignInfo>& cur_mutable_assign_info() { return mutable_side_tables().assign_info; }
 
   /// 当前 `Env` 的 `mutable` `ActionDetailInfo` 信息。
-  absl::optional<ActionDetailInfo>& cur_mutable_action_detail_info() { return action_detail_info_; }
+  absl::optional<ActionDetailInfo>& cur_mutable_action_detail_info() { return mutable_side_tables().action_detail_info; }
 
   /// 当前 `Env` 的 `mutable` `ActionDetailFixedInfo` 信息。
   absl::optional<ActionDetailFixedInfo>& cur_mutable_action_detail_fixed_info() {
-    return action_detail_fixed_info_;
+    return mutable_side_tables().action_detail_fixed_info;
   }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoNormal` 信息。
-  absl::optional<CommonInfoNormal>& cur_mutable_common_info_normal() { return common_info_normal_; }
+  absl::optional<CommonInfoNormal>& cur_mutable_common_info_normal() { return mutable_side_tables().common_info_normal; }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoMultiMap` 信息。
-  absl::optional<CommonInfoMultiMap>& cur_mutable_common_info_multi_map() { return common_info_multi_map_; }
+  absl::optional<CommonInfoMultiMap>& cur_mutable_common_info_multi_map() { return mutable_side_tables().common_info_multi_map; }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoMultiIntList` 信息。
   absl::optional<CommonInfoMultiIntList>& cur_mutable_common_info_multi_int_list() {
-    return common_info_multi_int_list_;
+    return mutable_side_tables().common_info_multi_int_list;
   }
 
   /// 当前 `Env` 的 `CommonInfoFixed` 信息。
-  absl::optional<CommonInfoFixed>& cur_mutable_common_info_fixed() { return common_info_fixed_; }
+  absl::optional<CommonInfoFixed>& cur_mutable_common_info_fixed() { return mutable_side_tables().common_info_fixed; }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoFixedList` 信息。
   absl::optional<CommonInfoFixedList>& cur_mutable_common_info_fixed_list() {
-    return common_info_fixed_list_;
+    return mutable_side_tables().common_info_fixed_list;
   }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoPrepare` 信息。
-  absl::optional<CommonInfoPrepare>& cur_mutable_common_info_prepare() { return common_info_prepare_; }
+  absl::optional<CommonInfoPrepare>& cur_mutable_common_info_prepare() { return mutable_side_tables().common_info_prepare; }
 
   /// 当前 `Env` 的 `mutable` `MiddleNodeInfo` 信息。
-  absl::optional<MiddleNodeInfo>& cur_mutable_middle_node_info() { return middle_node_info_; }
+  absl::optional<MiddleNodeInfo>& cur_mutable_middle_node_info() { return mutable_side_tables().middle_node_info; }
 
   /// 当前 `Env` 的 `mutable` `SeqListInfo` 信息。
-  absl::optional<SeqListInfo>& cur_mutable_seq_list_info() { return seq_list_info_; }
+  absl::optional<SeqListInfo>& cur_mutable_seq_list_info() { return mutable_side_tables().seq_list_info; }
 
   /// 当前 `Env` 的 `mutable` `ProtoListInfo` 信息。
-  absl::optional<ProtoListInfo>& cur_mutable_proto_list_info() { return proto_list_info_; }
+  absl::optional<ProtoListInfo>& cur_mutable_proto_list_info() { return mutable_side_tables().proto_list_info; }
 
   /// 当前 `Env` 的 `mutable` `BSFieldInfo` 信息。
-  absl::optional<BSFieldInfo>& cur_mutable_bs_field_info() { return bs_field_info_; }
+  absl::optional<BSFieldInfo>& cur_mutable_bs_field_info() { return mutable_side_tables().bs_field_info; }
 
   /// 当前 `Env` 的 `mutable` `if` 信息。
-  absl::optional<IfInfo>& cur_info(const IfInfo& v) { return if_info_; }
+  absl::optional<IfInfo>& cur_info(const IfInfo& v) {
+    bump_generation();
+    return if_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `loop` 信息。
-  absl::optional<LoopInfo>& cur_info(const LoopInfo& v) { return loop_info_; }
+  absl::optional<LoopInfo>& cur_info(const LoopInfo& v) {
+    bump_generation();
+    return loop_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `switch case` 信息。
-  absl::optional<SwitchCaseInfo>& cur_info(const SwitchCaseInfo& v) { return switch_case_info_; }
+  absl::optional<SwitchCaseInfo>& cur_info(const SwitchCaseInfo& v) { return mutable_side_tables().switch_case_info; }
 
   /// 当前 `Env` 的 `mutable` `Decl` 信息。
-  absl::optional<DeclInfo>& cur_info(const DeclInfo& v) { return decl_info_; }
+  absl::optional<DeclInfo>& cur_info(const DeclInfo& v) {
+    bump_generation();
+    return decl_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `BinaryOperator` 信息。
-  absl::optional<BinaryOpInfo>& cur_info(const BinaryOpInfo& v) { return binary_op_info_; }
+  absl::optional<BinaryOpInfo>& cur_info(const BinaryOpInfo& v) {
+    bump_generation();
+    return binary_op_info_;
+  }
 
   /// 当前 `Env` 的 `mutable` `AssignInfo` 信息。
-  absl::optional<AssignInfo>& cur_info(const AssignInfo& v) { return assign_info_; }
+  absl::optional<AssignInfo>& cur_info(const AssignInfo& v) { return mutable_side_tables().assign_info; }
 
   /// 当前 `Env` 的 `ActionDetailInfo` 信息。
-  absl::optional<ActionDetailInfo>& cur_info(const ActionDetailInfo& v) { return action_detail_info_; }
+  absl::optional<ActionDetailInfo>& cur_info(const ActionDetailInfo& v) { return mutable_side_tables().action_detail_info; }
 
   /// 当前 `Env` 的 `mutable` `ActionDetailFixedInfo` 信息。
   absl::optional<ActionDetailFixedInfo>& cur_info(const ActionDetailFixedInfo& v) {
-    return action_detail_fixed_info_;
+    return mutable_side_tables().action_detail_fixed_info;
   }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoNormal` 信息。
-  absl::optional<CommonInfoNormal>& cur_info(const CommonInfoNormal& v) { return common_info_normal_; }
+  absl::optional<CommonInfoNormal>& cur_info(const CommonInfoNormal& v) { return mutable_side_tables().common_info_normal; }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoMultiMap` 信息。
   absl::optional<CommonInfoMultiMap>& cur_info(const CommonInfoMultiMap& v) {
-    return common_info_multi_map_;
+    return mutable_side_tables().common_info_multi_map;
   }
 
   /// 当前 `Env` 的 `CommonInfoMultiIntList` 信息。
   absl::optional<CommonInfoMultiIntList>& cur_info(const CommonInfoMultiIntList& v) {
-    return common_info_multi_int_list_;
+    return mutable_side_tables().common_info_multi_int_list;
   }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoFixed` 信息。
-  absl::optional<CommonInfoFixed>& cur_info(const CommonInfoFixed& v) { return common_info_fixed_; }
+  absl::optional<CommonInfoFixed>& cur_info(const CommonInfoFixed& v) { return mutable_side_tables().common_info_fixed; }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoFixedList` 信息。
   absl::optional<CommonInfoFixedList>& cur_info(const CommonInfoFixedList& v) {
-    return common_info_fixed_list_;
+    return mutable_side_tables().common_info_fixed_list;
   }
 
   /// 当前 `Env` 的 `mutable` `CommonInfoPrepare` 信息。
-  absl::optional<CommonInfoPrepare>& cur_info(const CommonInfoPrepare& v) { return common_info_prepare_; }
+  absl::optional<CommonInfoPrepare>& cur_info(const CommonInfoPrepare& v) { return mutable_side_tables().common_info_prepare; }
 
   /// 当前 `Env` 的 `mutable` `MiddleNodeInfo` 信息。
-  absl::optional<MiddleNodeInfo>& cur_info(const MiddleNodeInfo& v) { return middle_node_info_; }
+  absl::optional<MiddleNodeInfo>& cur_info(const MiddleNodeInfo& v) { return mutable_side_tables().middle_node_info; }
 
   /// 当前 `Env` 的 `mutable` `SeqListInfo` 信息。
-  absl::optional<SeqListInfo>& cur_info(const SeqListInfo& v) { return seq_list_info_; }
+  absl::optional<SeqListInfo>& cur_info(const SeqListInfo& v) { return mutable_side_tables().seq_list_info; }
 
   /// 当前 `Env` 的 `mutable` `ProtoListInfo` 信息。
-  absl::optional<ProtoListInfo>& cur_info(const ProtoListInfo& v) { return proto_list_info_; }
+  absl::optional<ProtoListInfo>& cur_info(const ProtoListInfo& v) { return mutable_side_tables().proto_list_info; }
 
   /// 当前 `Env` 的 `mutable` `BSFieldInfo` 信息。
-  absl::optional<BSFieldInfo>& cur_info(const BSFieldInfo& v) { return bs_field_info_; }
+  absl::optional<BSFieldInfo>& cur_info(const BSFieldInfo& v) { return mutable_side_tables().bs_field_info; }
 
   const absl::optional<IfInfo>& cur_info(const IfInfo& v) const { return if_info_; }
 
   const absl::optional<LoopInfo>& cur_info(const LoopInfo& v) const { return loop_info_; }
 
   const absl::optional<SwitchCaseInfo>& cur_info(const SwitchCaseInfo& v) const {
-    return switch_case_info_;
+    return side_tables().switch_case_info;
   }
 
   const absl::optional<DeclInfo>& cur_info(const DeclInfo& v) const { return decl_info_; }
   const absl::optional<BinaryOpInfo>& cur_info(const BinaryOpInfo& v) const { return binary_op_info_; }
-  const absl::optional<AssignInfo>& cur_info(const AssignInfo& v) const { return assign_info_; }
+  const absl::optional<AssignInfo>& cur_info(const AssignInfo& v) const { return side_tables().assign_info; }
   const absl::optional<ActionDetailInfo>& cur_info(const ActionDetailInfo& v) const {
-    return action_detail_info_;
+    return side_tables().action_detail_info;
   }
   const absl::optional<ActionDetailFixedInfo>& cur_info(const ActionDetailFixedInfo& v) const {
-    return action_detail_fixed_info_;
+    return side_tables().action_detail_fixed_info;
   }
   const absl::optional<CommonInfoNormal>& cur_info(const CommonInfoNormal& v) const {
-    return common_info_normal_;
+    return side_tables().common_info_normal;
   }
   const absl::optional<CommonInfoMultiMap>& cur_info(const CommonInfoMultiMap& v) const {
-    return common_info_multi_map_;
+    return side_tables().common_info_multi_map;
   }
   const absl::optional<CommonInfoMultiIntList>& cur_info(const CommonInfoMultiIntList& v) const {
-    return common_info_multi_int_list_;
+    return side_tables().common_info_multi_int_list;
   }
   const absl::optional<CommonInfoFixed>& cur_info(const CommonInfoFixed& v) const {
-    return common_info_fixed_;
+    return side_tables().common_info_fixed;
   }
   const absl::optional<CommonInfoFixedList>& cur_info(const CommonInfoFixedList& v) const {
-    return common_info_fixed_list_;
+    return side_tables().common_info_fixed_list;
   }
   const absl::optional<CommonInfoPrepare>& cur_info(const CommonInfoPrepare& v) const {
-    return common_info_prepare_;
+    return side_tables().common_info_prepare;
   }
   const absl::optional<MiddleNodeInfo>& cur_info(const MiddleNodeInfo& v) const {
-    return middle_node_info_;
+    return side_tables().middle_node_info;
   }
   const absl::optional<SeqListInfo>& cur_info(const SeqListInfo& v) const {
-    return seq_list_info_;
+    return side_tables().seq_list_info;
   }
   const absl::optional<ProtoListInfo>& cur_info(const ProtoListInfo& v) const {
-    return proto_list_info_;
+    return side_tables().proto_list_info;
   }
 
-  const absl::optional<BSFieldInfo> &cur_info(const BSFieldInfo &v) const {return bs_field_info_;}
+  const absl::optional<BSFieldInfo> &cur_info(const BSFieldInfo &v) const {return side_tables().bs_field_info;}
 
   /// 获取 `info` 的通用模板函数。从当前 `Env` 开始查找，如果当前 `Env` 没有，则查找父 `Env`, 一直到根节点。
   template<typename T>
@@ -1047,6 +1141,7 @@ class Env {
 
   template<typename T>
   absl::optional<T>& get_info() {
+    bump_generation();
     const absl::optional<T>& info = const_cast<const Env*>(this)->get_info<T>();
     return const_cast<absl::optional<T>&>(info);
   }
@@ -1125,10 +1220,22 @@ class Env {
 
   const ConstructorInfo* cur_constructor_info() const { return constructor_info_; }
   const FeatureInfo* cur_feature_info() const { return feature_info_; }
-  ConstructorInfo* cur_mutable_constructor_info() { return constructor_info_; }
-  FeatureInfo* cur_mutable_feature_info() { return feature_info_; }
-  ConstructorInfo* cur_info(const ConstructorInfo& v) { return constructor_info_; }
-  FeatureInfo* cur_info(const FeatureInfo& v) { return feature_info_; }
+  ConstructorInfo* cur_mutable_constructor_info() {
+    bump_generation();
+    return constructor_info_;
+  }
+  FeatureInfo* cur_mutable_feature_info() {
+    bump_generation();
+    return feature_info_;
+  }
+  ConstructorInfo* cur_info(const ConstructorInfo& v) {
+    bump_generation();
+    return constructor_info_;
+  }
+  FeatureInfo* cur_info(const FeatureInfo& v) {
+    bump_generation();
+    return feature_info_;
+  }
   const ConstructorInfo* cur_info(const ConstructorInfo& v) const { return constructor_info_; }
   const FeatureInfo* cur_info(const FeatureInfo& v) const { return feature_info_; }
 
@@ -1156,16 +1263,32 @@ class Env {
   void update_assign_info(clang::BinaryOperator* binary_operator);
 
   /// 清空 `Decl` 信息。
-  void clear_decl_info() { decl_info_ = absl::nullopt; }
+  void clear_decl_info() {
+    bump_generation();
+    decl_info_ = absl::nullopt;
+  }
 
   /// 清空 `BinaryOperator` 信息。
-  void clear_binary_op_info() {binary_op_info_ = absl::nullopt;}
+  void clear_binary_op_info() {
+    bump_generation();
+    binary_op_info_ = absl::nullopt;
+  }
 
   /// 清空 `switch case` 信息。
-  void clear_switch_case_info() { switch_case_info_ = absl::nullopt; }
+  void clear_switch_case_info() {
+    bump_generation();
+    if (side_tables_ != nullptr) {
+      side_tables_->switch_case_info = absl::nullopt;
+    }
+  }
 
   /// 清空 `AssignInfo` 信息。
-  void clear_assign_info() { assign_info_ = absl::nullopt; }
+  void clear_assign_info() {
+    bump_generation();
+    if (side_tables_ != nullptr) {
+      side_tables_->assign_info = absl::nullopt;
+    }
+  }
 
   bool is_decl_in_parent_env(const std::string& var_name) const;
   bool is_decl_in_cur_env(const std::string& var_name) const;
@@ -1178,6 +1301,16 @@ class Env {
   find_bs_field_detail_ptr_by_var_name(const std::string& var_name);
 
   bool is_in_parent_else() const;
+
+ private:
+  /// 根据 `is_loop_`、`is_if_` 以及父节点的缓存更新当前节点缓存的循环和 `if` 节点。
+  void update_kind_cache();
+
+  /// 还没有创建时返回空的 `EnvSideTables`, 不会创建。
+  const EnvSideTables& side_tables() const;
+
+  /// 还没有创建时创建。
+  EnvSideTables& mutable_side_tables();
 };
 
 }  // namespace convert
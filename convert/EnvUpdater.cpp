@@ -0,0 +1,134 @@
+#include <glog/logging.h>
+
+#include "EnvUpdater.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+const char* env_updater_name(EnvUpdater updater) {
+  switch (updater) {
+    case EnvUpdater::COMMON_INFO_PREPARE: return "common_info_prepare";
+    case EnvUpdater::COMMON_INFO_NORMAL: return "common_info_normal";
+    case EnvUpdater::COMMON_INFO_FIXED_LIST: return "common_info_fixed_list";
+    case EnvUpdater::COMMON_INFO_MULTI_MAP: return "common_info_multi_map";
+    case EnvUpdater::COMMON_INFO_MULTI_INT_LIST: return "common_info_multi_int_list";
+    case EnvUpdater::ACTION_DETAIL: return "action_detail";
+    case EnvUpdater::ACTION_DETAIL_FIXED: return "action_detail_fixed";
+    case EnvUpdater::MIDDLE_NODE: return "middle_node";
+    case EnvUpdater::DOUBLE_LIST: return "double_list";
+    case EnvUpdater::GET_SEQ_LIST: return "get_seq_list";
+    case EnvUpdater::PROTO_LIST: return "proto_list";
+    case EnvUpdater::QUERY_TOKEN: return "query_token";
+    case EnvUpdater::GENERAL: return "general";
+    case EnvUpdater::BS_FIELD: return "bs_field";
+    default: return "unknown";
+  }
+}
+
+ExprClass classify_expr(ExprInfo* expr_info_ptr) {
+  ExprClass res;
+
+  res.is_from_middle_node = expr_info_ptr->is_from_middle_node();
+  res.is_from_action_detail_map = expr_info_ptr->is_from_action_detail_map();
+  res.is_from_seq_list = expr_info_ptr->is_from_seq_list();
+  res.is_from_query_token = expr_info_ptr->is_from_query_token() || expr_info_ptr->is_from_photo_text();
+
+  // 以上几种都属于 adlog, 其中任一种成立时不需要再判断一遍。
+  res.is_from_adlog = res.is_from_middle_node ||
+                      res.is_from_action_detail_map ||
+                      res.is_from_seq_list ||
+                      res.is_from_query_token ||
+                      expr_info_ptr->is_from_adlog();
+
+  res.is_cxx_member_call_expr = expr_info_ptr->is_cxx_member_call_expr();
+  res.is_subscript_call = expr_info_ptr->callee_name() == "operator[]";
+  res.is_middle_node_root = expr_info_ptr->is_middle_node_root();
+  res.is_nullptr = expr_info_ptr->is_nullptr();
+  res.is_in_decl_stmt = expr_info_ptr->is_in_decl_stmt();
+
+  auto select = [&res](EnvUpdater updater, bool cond) {
+    if (cond) {
+      res.updaters |= uint32_t(1) << static_cast<int>(updater);
+    }
+  };
+
+  // 依赖 Env 中 common info 的状态，无法提前判断。
+  select(EnvUpdater::COMMON_INFO_PREPARE, true);
+  select(EnvUpdater::COMMON_INFO_NORMAL, true);
+  select(EnvUpdater::COMMON_INFO_FIXED_LIST, true);
+  select(EnvUpdater::COMMON_INFO_MULTI_MAP, true);
+
+  // action_name2list[userAttr.name_value()]
+  select(EnvUpdater::COMMON_INFO_MULTI_INT_LIST, res.is_subscript_call);
+
+  // action 参数定义来自任意的成员函数调用。
+  select(EnvUpdater::ACTION_DETAIL, res.is_from_action_detail_map || res.is_cxx_member_call_expr);
+  select(EnvUpdater::ACTION_DETAIL_FIXED, res.is_from_action_detail_map);
+
+  // if (photo_info == nullptr) 中的 nullptr。
+  select(EnvUpdater::MIDDLE_NODE, res.is_from_middle_node || res.is_middle_node_root || res.is_nullptr);
+
+  select(EnvUpdater::DOUBLE_LIST, res.is_from_adlog);
+  select(EnvUpdater::GET_SEQ_LIST, res.is_from_seq_list);
+  select(EnvUpdater::PROTO_LIST, res.is_from_adlog);
+  select(EnvUpdater::QUERY_TOKEN, res.is_from_query_token);
+
+  // 处理 decl_info、binary_op_info、loop_info 等，与表达式来源无关。
+  select(EnvUpdater::GENERAL, true);
+
+  select(EnvUpdater::BS_FIELD, res.is_in_decl_stmt);
+
+  return res;
+}
+
+std::atomic<uint64_t> EnvUpdaterStats::total_{0};
+std::atomic<uint64_t> EnvUpdaterStats::selected_[static_cast<int>(EnvUpdater::COUNT)] = {};
+std::atomic<uint64_t> EnvUpdaterStats::missed_[static_cast<int>(EnvUpdater::COUNT)] = {};
+
+void EnvUpdaterStats::add(const ExprClass& expr_class) {
+  total_.fetch_add(1, std::memory_order_relaxed);
+  for (int i = 0; i < static_cast<int>(EnvUpdater::COUNT); i++) {
+    if (expr_class.has(static_cast<EnvUpdater>(i))) {
+      selected_[i].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void EnvUpdaterStats::add_missed(EnvUpdater updater) {
+  missed_[static_cast<int>(updater)].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t EnvUpdaterStats::missed() {
+  uint64_t res = 0;
+  for (int i = 0; i < static_cast<int>(EnvUpdater::COUNT); i++) {
+    res += missed_[i].load(std::memory_order_relaxed);
+  }
+
+  return res;
+}
+
+void EnvUpdaterStats::log() {
+  uint64_t total = total_.load(std::memory_order_relaxed);
+  if (total == 0) {
+    return;
+  }
+
+  LOG(INFO) << "parse_expr total: " << total;
+  for (int i = 0; i < static_cast<int>(EnvUpdater::COUNT); i++) {
+    uint64_t selected = selected_[i].load(std::memory_order_relaxed);
+    LOG(INFO) << "update_env_" << env_updater_name(static_cast<EnvUpdater>(i))
+              << ", selected: " << selected
+              << ", hit rate: " << static_cast<double>(selected) / total;
+
+    uint64_t missed = missed_[i].load(std::memory_order_relaxed);
+    if (missed > 0) {
+      LOG(ERROR) << "update_env_" << env_updater_name(static_cast<EnvUpdater>(i))
+                 << " skipped by gate but changed env, missed: " << missed;
+    }
+  }
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "ExprInfo.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// parse_expr 中的 update_env_*, 按执行顺序排列。
+enum class EnvUpdater {
+  COMMON_INFO_PREPARE,
+  COMMON_INFO_NORMAL,
+  COMMON_INFO_FIXED_LIST,
+  COMMON_INFO_MULTI_MAP,
+  COMMON_INFO_MULTI_INT_LIST,
+  ACTION_DETAIL,
+  ACTION_DETAIL_FIXED,
+  MIDDLE_NODE,
+  DOUBLE_LIST,
+  GET_SEQ_LIST,
+  PROTO_LIST,
+  QUERY_TOKEN,
+  GENERAL,
+  BS_FIELD,
+  COUNT
+};
+
+static_assert(static_cast<int>(EnvUpdater::COUNT) <= 32, "EnvUpdater must fit in uint32_t");
+
+const char* env_updater_name(EnvUpdater updater);
+
+/// 表达式的分类，parse_expr_simple 之后计算一次，用于选择需要执行的 update_env_*。
+///
+/// 大部分 update_env_* 只处理某一种来源的表达式，如中间节点、action_detail、seq_list 等，
+/// 其他表达式进去之后第一个判断就返回了。这里先按表达式的来源、调用形式以及类型判断一次，
+/// 每个 update_env_* 的条件都是其内部判断的必要条件，不满足时一定什么都不做，可以直接跳过。
+///
+/// 依赖 Env 状态的 update_env_* 无法提前判断，始终执行，如 common_info 的前几个阶段以及 general。
+struct ExprClass {
+  /// 来源。
+  bool is_from_adlog = false;
+  bool is_from_middle_node = false;
+  bool is_from_action_detail_map = false;
+  bool is_from_seq_list = false;
+
+  /// GetQueryToken 或者 GetPhotoText。
+  bool is_from_query_token = false;
+
+  /// 调用形式。
+  bool is_cxx_member_call_expr = false;
+  bool is_subscript_call = false;
+  bool is_middle_node_root = false;
+  bool is_nullptr = false;
+  bool is_in_decl_stmt = false;
+
+  /// 每一位对应一个 EnvUpdater。
+  uint32_t updaters = 0;
+
+  bool has(EnvUpdater updater) const {
+    return updaters & (uint32_t(1) << static_cast<int>(updater));
+  }
+};
+
+ExprClass classify_expr(ExprInfo* expr_info_ptr);
+
+/// 每个 update_env_* 被选中的次数，用于观察分类的效果。多线程共用。
+class EnvUpdaterStats {
+ public:
+  static void add(const ExprClass& expr_class);
+
+  /// 记录一次被跳过但是修改了 Env 的 update_env_*, 见 GlobalConfig::check_env_updater_gate。
+  static void add_missed(EnvUpdater updater);
+
+  /// 所有被跳过但是修改了 Env 的次数。
+  static uint64_t missed();
+
+  /// 输出每个 update_env_* 的命中率。
+  static void log();
+
+ private:
+  static std::atomic<uint64_t> total_;
+  static std::atomic<uint64_t> selected_[static_cast<int>(EnvUpdater::COUNT)];
+  static std::atomic<uint64_t> missed_[static_cast<int>(EnvUpdater::COUNT)];
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -363,8 +363,8 @@ std::string ExprInfo::get_bs_field_value_query_token() const {
 
 std::string ExprInfo::get_bs_field_value_reco_user_info() const {
   std::string text = origin_expr_str();
-  static std::regex p("^(adlog|ad_log)");
-  return std::regex_replace(text, p, "bslog");
+  static const tool::TextReplacer replacer({{"^(adlog|ad_log)", "bslog"}});
+  return replacer.replace(text);
 }
 
 std::string ExprInfo::get_bs_middle_node_leaf() const {
@@ -800,7 +800,8 @@ std::string ExprInfo::get_adlog_field_str() const {
         oss << ".key:" << *enum_value;
       }
     } else if (is_repeated_common_info_size()) {
-      oss << std::regex_replace(callee_name_, std::regex("_size$"), ".size");
+      static const tool::TextReplacer replacer_size({{"_size$", ".size"}});
+      oss << replacer_size.replace(callee_name_);
     } else if (is_action_detail_find_expr()) {
       // 确定 action 后的其他 expr
       if (const auto& action_detail_info = env_ptr_->get_action_detail_info()) {
@@ -845,8 +846,8 @@ absl::optional<std::string> ExprInfo::get_common_info_prefix() const {
 
   std::string s = get_bs_enum_str();
   if (s.find("_key_") != std::string::npos) {
-    std::regex p("(.*)_key_(.*)");
-    return absl::optional<std::string>(std::regex_replace(s, p, "$1"));
+    static const tool::TextReplacer replacer({{"(.*)_key_(.*)", "$1"}});
+    return absl::optional<std::string>(replacer.replace(s));
   } else {
     return absl::optional<std::string>(s);
   }
@@ -857,12 +858,12 @@ absl::optional<std::string> ExprInfo::get_common_info_prefix_adlog() const {
     std::string s = get_adlog_field_str();
 
     if (is_repeated_common_info_size()) {
-      static std::regex p_size("\\.size$");
-      return absl::optional<std::string>(std::regex_replace(s, p_size, ""));
+      static const tool::TextReplacer replacer_size({{"\\.size$", ""}});
+      return absl::optional<std::string>(replacer_size.replace(s));
     } else {
       if (s.find(".key:") != std::string::npos) {
-        std::regex p("(.*)\\.key:(.*)");
-        return absl::optional<std::string>(std::regex_replace(s, p, "$1"));
+        static const tool::TextReplacer replacer({{"(.*)\\.key:(.*)", "$1"}});
+        return absl::optional<std::string>(replacer.replace(s));
       } else {
         return absl::optional<std::string>(s);
       }
@@ -1157,8 +1158,8 @@ absl::optional<std::string> ExprInfo::get_action_detail_prefix_adlog() const {
     if (ends_with(s, ".")) {
       return s.substr(0, s.size() - 1);
     } else if (s.find(".key:") != std::string::npos) {
-      std::regex p("(.*)\\.key:(.*)");
-      return absl::optional<std::string>(std::regex_replace(s, p, "$1"));
+      static const tool::TextReplacer replacer({{"(.*)\\.key:(.*)", "$1"}});
+      return absl::optional<std::string>(replacer.replace(s));
     } else {
       return absl::optional<std::string>(s);
     }
@@ -1924,7 +1925,7 @@ std::string ExprInfo::callee_with_params(const StrictRewriter& rewriter) const {
   return "";
 }
 
-void ExprInfo::add_call_expr_param(std::shared_ptr<ExprInfo> expr_info_ptr) {
+void ExprInfo::add_call_expr_param(ExprInfo* expr_info_ptr) {
   call_expr_params_.push_back(expr_info_ptr);
 }
 
@@ -1933,7 +1934,7 @@ ExprInfo* ExprInfo::call_expr_param(size_t index) const {
     return nullptr;
   }
 
-  return call_expr_params_[index].get();
+  return call_expr_params_[index];
 }
 
 bool ExprInfo::is_cxx_operator_call_expr() const {
@@ -2163,14 +2164,10 @@ bool ExprInfo::is_parent_repeated_action_info() const {
 }
 
 ExprInfo* ExprInfo::caller_info() const {
-  if (caller_info_ != nullptr) {
-    return caller_info_.get();
-  } else {
-    return nullptr;
-  }
+  return caller_info_;
 }
 
-void ExprInfo::set_caller_info(std::shared_ptr<ExprInfo> caller_info) {
+void ExprInfo::set_caller_info(ExprInfo* caller_info) {
   caller_info_ = caller_info;
 }
 
@@ -77,7 +77,7 @@ class ExprInfo {
   void set_origin_expr(clang::DeclRefExpr* origin_expr) { origin_expr_ = origin_expr; }
   std::string origin_expr_str() const;
 
-  void set_parent(std::shared_ptr<ExprInfo> parent) { parent_ = parent; }
+  void set_parent(ExprInfo* parent) { parent_ = parent; }
   void set_env_ptr(Env* env_ptr) { env_ptr_ = env_ptr; }
   void set_expr(clang::Expr* expr) { expr_ = expr; }
   void set_callee_name(const std::string& callee_name) { callee_name_ = callee_name; }
@@ -195,7 +195,7 @@ class ExprInfo {
 
   bool contains_loop_var() const;
 
-  std::shared_ptr<ExprInfo> parent() const { return parent_; }
+  ExprInfo* parent() const { return parent_; }
 
   bool has_decl_ref() const;
 
@@ -234,7 +234,7 @@ class ExprInfo {
   bool is_parent_str_ref() const;
   bool is_caller_loop_var() const;
   std::string callee_with_params(const StrictRewriter& rewriter) const;
-  void add_call_expr_param(std::shared_ptr<ExprInfo> expr_info_ptr);
+  void add_call_expr_param(ExprInfo* expr_info_ptr);
   ExprInfo* call_expr_param(size_t index) const;
   size_t call_expr_params_size() const { return call_expr_params_.size(); }
 
@@ -278,7 +278,7 @@ class ExprInfo {
   void set_caller(clang::Expr* caller) { caller_ = caller; }
 
   ExprInfo* caller_info() const;
-  void set_caller_info(std::shared_ptr<ExprInfo> caller_info);
+  void set_caller_info(ExprInfo* caller_info);
 
   bool is_seq_list_root() const;
   bool is_seq_list_root_ref() const;
@@ -401,7 +401,7 @@ class ExprInfo {
   std::string callee_name_;
 
   clang::Expr* caller_ = nullptr;
-  std::shared_ptr<ExprInfo> caller_info_;
+  ExprInfo* caller_info_ = nullptr;
 
   std::string value_type_;
 
@@ -417,12 +417,12 @@ class ExprInfo {
   std::string map_value_str_;
 
   std::vector<clang::Expr*> params_;
-  std::shared_ptr<ExprInfo> parent_;
+  ExprInfo* parent_ = nullptr;
 
   /// 原始的表达式。
   std::string raw_expr_str_;
 
-  std::vector<std::shared_ptr<ExprInfo>> call_expr_params_;
+  std::vector<ExprInfo*> call_expr_params_;
 
   static std::unordered_set<std::string> ignore_callee_;
 };
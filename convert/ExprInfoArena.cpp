@@ -0,0 +1,37 @@
+#include "ExprInfoArena.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+namespace {
+
+thread_local ExprInfoArena thread_arena;
+
+thread_local ExprInfoArena* current_arena = nullptr;
+
+}  // namespace
+
+ExprInfoArena* ExprInfoArena::current() {
+  if (current_arena != nullptr) {
+    return current_arena;
+  }
+
+  return &thread_arena;
+}
+
+void ExprInfoArena::clear_thread_arena() {
+  thread_arena.clear();
+}
+
+ExprInfoArenaScope::ExprInfoArenaScope(): prev_(current_arena) {
+  current_arena = &arena_;
+}
+
+ExprInfoArenaScope::~ExprInfoArenaScope() {
+  current_arena = prev_;
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "llvm/Support/Allocator.h"
+
+#include "ExprInfo.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// ExprInfo 的 arena。
+///
+/// parse_expr_simple 对每个节点都会创建一个 ExprInfo, 节点之间通过 parent、caller_info 以及
+/// call_expr_params 互相引用。所有 ExprInfo 都从 arena 中分配，节点之间的引用都是不拥有所有权的裸指针，
+/// arena 释放时统一析构。
+///
+/// 每个方法的处理对应一个 ExprInfoArenaScope, 方法处理完后释放该方法中解析的所有 ExprInfo。
+/// 不在任何 ExprInfoArenaScope 中时使用当前线程默认的 arena, 每个源文件开始处理时清空。
+class ExprInfoArena {
+ public:
+  ExprInfoArena() = default;
+  ExprInfoArena(const ExprInfoArena&) = delete;
+  ExprInfoArena& operator=(const ExprInfoArena&) = delete;
+
+  /// 当前线程正在使用的 arena。
+  static ExprInfoArena* current();
+
+  /// 清空当前线程默认的 arena。
+  static void clear_thread_arena();
+
+  ExprInfo* create(clang::Expr* expr, Env* env_ptr) {
+    return new (allocator_.Allocate()) ExprInfo(expr, env_ptr);
+  }
+
+  /// 析构并释放所有 ExprInfo。
+  void clear() { allocator_.DestroyAll(); }
+
+ private:
+  llvm::SpecificBumpPtrAllocator<ExprInfo> allocator_;
+
+};
+
+/// 在该范围内创建的 ExprInfo 都从一个新的 arena 中分配，范围结束时全部释放。
+class ExprInfoArenaScope {
+ public:
+  ExprInfoArenaScope();
+  ~ExprInfoArenaScope();
+
+  ExprInfoArenaScope(const ExprInfoArenaScope&) = delete;
+  ExprInfoArenaScope& operator=(const ExprInfoArenaScope&) = delete;
+
+ private:
+  ExprInfoArena arena_;
+  ExprInfoArena* prev_ = nullptr;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
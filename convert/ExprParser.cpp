@@ -2,6 +2,8 @@
 #include <thread>
 #include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 
@@ -9,6 +11,8 @@
 #include "clang/AST/ExprCXX.h"
 
 #include "./Deleter.h"
+#include "./EnvUpdater.h"
+#include "./ExprInfoArena.h"
 #include "./ExprParser.h"
 #include "./ExprParserDetail.h"
 #include "./ExprParserBSField.h"
@@ -20,14 +24,14 @@ namespace ad_algorithm {
 namespace convert {
 
 // 解析表达式。
-std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
+ExprInfo* parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
   if (expr == nullptr) {
     LOG(INFO) << "expr is null";
     return nullptr;
   }
 
   if (clang::CXXMemberCallExpr* cxx_member_call_expr = dyn_cast<clang::CXXMemberCallExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     ExprInfo& expr_info = *expr_info_ptr;
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
 
@@ -35,7 +39,7 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
     if (clang::MemberExpr* callee = dyn_cast<clang::MemberExpr>(cxx_member_call_expr->getCallee())) {
       std::string callee_name = callee->getMemberDecl()->getNameAsString();
 
-      expr_info.set_parent(std::move(parse_expr_simple(caller, env_ptr)));
+      expr_info.set_parent(parse_expr_simple(caller, env_ptr));
 
       // for loop, begin is loop var
       if (callee_name == "begin") {
@@ -49,7 +53,7 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
         expr_info.add_param(cxx_member_call_expr->getArg(i));
         auto param_expr_info_ptr = parse_expr_simple(cxx_member_call_expr->getArg(i), env_ptr);
         param_expr_info_ptr->set_caller_info(expr_info_ptr);
-        expr_info_ptr->add_call_expr_param(std::move(param_expr_info_ptr));
+        expr_info_ptr->add_call_expr_param(param_expr_info_ptr);
       }
 
       return expr_info_ptr;
@@ -61,8 +65,8 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
   } else if (clang::MemberExpr* member_expr = dyn_cast<clang::MemberExpr>(expr)) {
     clang::Expr* caller = member_expr->getBase();
     std::string member_str = tool::trim_this(member_expr->getMemberDecl()->getNameAsString());
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
-    expr_info_ptr->set_parent(std::move(parse_expr_simple(caller, env_ptr)));
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
+    expr_info_ptr->set_parent(parse_expr_simple(caller, env_ptr));
     expr_info_ptr->set_callee_name(member_str);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
 
@@ -82,36 +86,36 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
   } else if (clang::ParenExpr* paren_expr = dyn_cast<clang::ParenExpr>(expr)) {
     return parse_expr_simple(paren_expr->getSubExpr(), env_ptr);
   } else if (clang::UnaryOperator* unary_operator = dyn_cast<clang::UnaryOperator>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
     auto op_str = clang::UnaryOperator::getOpcodeStr(unary_operator->getOpcode());
     std::string op(op_str.data(), op_str.size());
     expr_info_ptr->set_callee_name(op);
-    expr_info_ptr->set_parent(std::move(parse_expr_simple(unary_operator->getSubExpr(), env_ptr)));
+    expr_info_ptr->set_parent(parse_expr_simple(unary_operator->getSubExpr(), env_ptr));
 
     auto param_expr_info = parse_expr_simple(unary_operator->getSubExpr(), env_ptr);
     expr_info_ptr->add_param(unary_operator->getSubExpr());
     param_expr_info->set_caller_info(expr_info_ptr);
-    expr_info_ptr->add_call_expr_param(std::move(param_expr_info));
+    expr_info_ptr->add_call_expr_param(param_expr_info);
 
     return expr_info_ptr;
   } else if (clang::CXXOperatorCallExpr* cxx_operator_call_expr = dyn_cast<clang::CXXOperatorCallExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
 
     std::string op = stmt_to_string(cxx_operator_call_expr->getCallee());
     expr_info_ptr->set_callee_name(op);
-    expr_info_ptr->set_parent(std::move(parse_expr_simple(cxx_operator_call_expr->getArg(0), env_ptr)));
+    expr_info_ptr->set_parent(parse_expr_simple(cxx_operator_call_expr->getArg(0), env_ptr));
 
     for (size_t i = 0; i < cxx_operator_call_expr->getNumArgs(); i++) {
       auto param_expr_info_ptr = parse_expr_simple(cxx_operator_call_expr->getArg(i), env_ptr);
       param_expr_info_ptr->set_caller_info(expr_info_ptr);
-      expr_info_ptr->add_call_expr_param(std::move(param_expr_info_ptr));
+      expr_info_ptr->add_call_expr_param(param_expr_info_ptr);
     }
 
     return expr_info_ptr;
   } else if (clang::BinaryOperator* binary_operator = dyn_cast<clang::BinaryOperator>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
 
     std::string op = binary_operator->getOpcodeStr().str();
@@ -119,15 +123,15 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
 
     auto left = parse_expr_simple(binary_operator->getLHS(), env_ptr);
     left->set_caller_info(expr_info_ptr);
-    expr_info_ptr->add_call_expr_param(std::move(left));
+    expr_info_ptr->add_call_expr_param(left);
 
     auto right = parse_expr_simple(binary_operator->getRHS(), env_ptr);
     right->set_caller_info(expr_info_ptr);
-    expr_info_ptr->add_call_expr_param(std::move(right));
+    expr_info_ptr->add_call_expr_param(right);
 
     return expr_info_ptr;
   } else if (clang::CallExpr* call_expr = dyn_cast<clang::CallExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
     expr_info_ptr->set_callee_name(tool::trim_this(stmt_to_string(call_expr->getCallee())));
     clang::Expr* caller = call_expr->getCallee();
@@ -139,50 +143,50 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
     for (size_t i = 0; i < call_expr->getNumArgs(); i++) {
       auto param_expr_info_ptr = parse_expr_simple(call_expr->getArg(i), env_ptr);
       param_expr_info_ptr->set_caller_info(expr_info_ptr);
-      expr_info_ptr->add_call_expr_param(std::move(param_expr_info_ptr));
+      expr_info_ptr->add_call_expr_param(param_expr_info_ptr);
     }
 
     return expr_info_ptr;
   } else if (clang::CXXDependentScopeMemberExpr* cxx_dependent_scope_member_expr =
               dyn_cast<clang::CXXDependentScopeMemberExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_callee_name(cxx_dependent_scope_member_expr->getMember().getAsString());
     clang::Expr* base = cxx_dependent_scope_member_expr->getBase();
-    expr_info_ptr->set_parent(std::move(parse_expr_simple(base, env_ptr)));
+    expr_info_ptr->set_parent(parse_expr_simple(base, env_ptr));
 
     return expr_info_ptr;
   } else if (clang::ArraySubscriptExpr* array_subscript_expr = dyn_cast<clang::ArraySubscriptExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_callee_name("[]");
-    expr_info_ptr->set_parent(std::move(parse_expr_simple(array_subscript_expr->getBase(), env_ptr)));
+    expr_info_ptr->set_parent(parse_expr_simple(array_subscript_expr->getBase(), env_ptr));
 
     return expr_info_ptr;
   } else if (clang::CXXConstructExpr* cxx_construct_expr = dyn_cast<clang::CXXConstructExpr>(expr)) {
     // 正常只有一个参数
     if (cxx_construct_expr->getNumArgs() == 1) {
-      auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
-      expr_info_ptr->set_parent(std::move(parse_expr_simple(cxx_construct_expr->getArg(0), env_ptr)));
+      auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
+      expr_info_ptr->set_parent(parse_expr_simple(cxx_construct_expr->getArg(0), env_ptr));
       expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
       return expr_info_ptr;
     } else {
-      auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+      auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
       expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
       return expr_info_ptr;
     }
   } else if (clang::CXXFunctionalCastExpr* cxx_functional_cast_expr = dyn_cast<clang::CXXFunctionalCastExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
 
     auto param_info_ptr = parse_expr_simple(cxx_functional_cast_expr->getSubExpr(), env_ptr);
     param_info_ptr->set_caller_info(expr_info_ptr);
-    expr_info_ptr->add_call_expr_param(std::move(param_info_ptr));
+    expr_info_ptr->add_call_expr_param(param_info_ptr);
 
     return expr_info_ptr;
   } else if (clang::ConstantExpr* constant_expr = dyn_cast<clang::ConstantExpr>(expr)) {
     return parse_expr_simple(constant_expr->getSubExpr(), env_ptr);
   } else if (clang::DeclRefExpr* decl_ref_expr = dyn_cast<clang::DeclRefExpr>(expr)) {
     LOG(INFO) << "parse decl_ref_expr: " << stmt_to_string(decl_ref_expr);
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_origin_expr(decl_ref_expr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
 
@@ -224,25 +228,25 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
 
     return expr_info_ptr;
   } else if (clang::IntegerLiteral* integer_literal = dyn_cast<clang::IntegerLiteral>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
     return expr_info_ptr;
   } else if (clang::CXXThisExpr* cxx_this_expr = dyn_cast<clang::CXXThisExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
     return expr_info_ptr;
   } else if (clang::CXXNullPtrLiteralExpr* cxx_null_ptr_literal_expr =
              dyn_cast<clang::CXXNullPtrLiteralExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
     return expr_info_ptr;
   } else if (clang::GNUNullExpr* gnu_null_expr = dyn_cast<clang::GNUNullExpr>(expr)) {
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
     return expr_info_ptr;
   } else {
     LOG(INFO) << "unknown type, expr: " << stmt_to_string(expr);
-    auto expr_info_ptr = std::make_shared<ExprInfo>(expr, env_ptr);
+    auto expr_info_ptr = ExprInfoArena::current()->create(expr, env_ptr);
     expr_info_ptr->set_raw_expr_str(stmt_to_string(expr));
     return expr_info_ptr;
   }
@@ -251,31 +255,149 @@ std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr) {
   return nullptr;
 }
 
-std::shared_ptr<ExprInfo> parse_expr(clang::Expr* expr, Env* env_ptr) {
-  auto expr_info_ptr = parse_expr_simple(expr, env_ptr);
-  if (expr_info_ptr == nullptr) {
-    LOG(INFO) << "parse expr error, return nullptr! expr: " << stmt_to_string(expr);
-    return nullptr;
+namespace {
+
+struct ParseExprKeyHash {
+  size_t operator()(const std::pair<clang::Expr*, Env*>& key) const {
+    return std::hash<clang::Expr*>()(key.first) ^ (std::hash<Env*>()(key.second) << 1);
   }
+};
+
+/// 缓存的解析结果，以及解析完成时 Env 的修改次数。
+struct ParseExprCacheEntry {
+  ExprInfo* expr_info_ptr = nullptr;
+  uint64_t generation = 0;
+};
+
+using ParseExprCache = std::unordered_map<std::pair<clang::Expr*, Env*>, ParseExprCacheEntry, ParseExprKeyHash>;
+
+/// ParseExprScope 的嵌套层数, 大于 0 时缓存 parse_expr 的结果。
+thread_local int parse_expr_scope_depth = 0;
+
+thread_local ParseExprCache parse_expr_cache;
+
+/// parse_expr_uncached 的嵌套层数。
+thread_local int parse_expr_uncached_depth = 0;
+
+/// 最外层 parse_expr_uncached 中 Env 的修改次数之和，见 ParseExprRuleScope。
+thread_local uint64_t parse_expr_env_changes = 0;
 
-  update_env_common_info(expr_info_ptr.get(), env_ptr);
+ExprInfo* parse_expr_uncached(clang::Expr* expr, Env* env_ptr);
 
-  update_env_action_detail(expr_info_ptr.get(), env_ptr);
-  update_env_action_detail_fixed(expr_info_ptr.get(), env_ptr);
+using EnvUpdaterFunc = void (*)(ExprInfo* expr_info_ptr, Env* env_ptr);
 
-  update_env_middle_node(expr_info_ptr.get(), env_ptr);
-  update_env_double_list(expr_info_ptr.get(), env_ptr);
-  update_env_get_seq_list(expr_info_ptr.get(), env_ptr);
-  update_env_proto_list(expr_info_ptr.get(), env_ptr);
-  update_env_query_token(expr_info_ptr.get(), env_ptr);
+const std::pair<EnvUpdater, EnvUpdaterFunc> env_updaters[] = {
+  {EnvUpdater::COMMON_INFO_PREPARE, update_env_common_info_prepare},
+  {EnvUpdater::COMMON_INFO_NORMAL, update_env_common_info_normal},
+  {EnvUpdater::COMMON_INFO_FIXED_LIST, update_env_common_info_fixed_list},
+  {EnvUpdater::COMMON_INFO_MULTI_MAP, update_env_common_info_multi_map},
+  {EnvUpdater::COMMON_INFO_MULTI_INT_LIST, update_env_common_info_multi_int_list},
+  {EnvUpdater::ACTION_DETAIL, update_env_action_detail},
+  {EnvUpdater::ACTION_DETAIL_FIXED, update_env_action_detail_fixed},
+  {EnvUpdater::MIDDLE_NODE, update_env_middle_node},
+  {EnvUpdater::DOUBLE_LIST, update_env_double_list},
+  {EnvUpdater::GET_SEQ_LIST, update_env_get_seq_list},
+  {EnvUpdater::PROTO_LIST, update_env_proto_list},
+  {EnvUpdater::QUERY_TOKEN, update_env_query_token},
+  {EnvUpdater::GENERAL, update_env_general},
+  {EnvUpdater::BS_FIELD, update_env_bs_field},
+};
 
-  update_env_general(expr_info_ptr.get(), env_ptr);
+static_assert(sizeof(env_updaters) / sizeof(env_updaters[0]) == static_cast<size_t>(EnvUpdater::COUNT),
+              "every EnvUpdater must have an update function");
 
-  update_env_bs_field(expr_info_ptr.get(), env_ptr);
+}  // namespace
 
+ParseExprScope::ParseExprScope() {
+  parse_expr_scope_depth++;
+}
+
+ParseExprScope::~ParseExprScope() {
+  parse_expr_scope_depth--;
+  if (parse_expr_scope_depth == 0) {
+    parse_expr_cache.clear();
+  }
+}
+
+ExprInfo* parse_expr(clang::Expr* expr, Env* env_ptr) {
+  if (parse_expr_scope_depth == 0) {
+    return parse_expr_uncached(expr, env_ptr);
+  }
+
+  // 缓存之后 Env 有任何修改都需要重新解析，结果可能不同。
+  auto key = std::make_pair(expr, env_ptr);
+  auto it = parse_expr_cache.find(key);
+  if (it != parse_expr_cache.end() && it->second.generation == Env::generation()) {
+    return it->second.expr_info_ptr;
+  }
+
+  auto expr_info_ptr = parse_expr_uncached(expr, env_ptr);
+  parse_expr_cache[key] = ParseExprCacheEntry{expr_info_ptr, Env::generation()};
   return expr_info_ptr;
 }
 
+ParseExprRuleScope::ParseExprRuleScope():
+  generation_(Env::generation()),
+  parse_env_changes_(parse_expr_env_changes) {
+}
+
+ParseExprRuleScope::~ParseExprRuleScope() {
+  uint64_t changes = Env::generation() - generation_;
+  uint64_t parse_changes = parse_expr_env_changes - parse_env_changes_;
+  if (changes > parse_changes) {
+    Env::bump_generation();
+  }
+}
+
+namespace {
+
+ExprInfo* parse_expr_uncached_impl(clang::Expr* expr, Env* env_ptr);
+
+ExprInfo* parse_expr_uncached(clang::Expr* expr, Env* env_ptr) {
+  uint64_t generation = Env::generation();
+  parse_expr_uncached_depth++;
+  auto expr_info_ptr = parse_expr_uncached_impl(expr, env_ptr);
+  parse_expr_uncached_depth--;
+  if (parse_expr_uncached_depth == 0) {
+    parse_expr_env_changes += Env::generation() - generation;
+  }
+
+  return expr_info_ptr;
+}
+
+ExprInfo* parse_expr_uncached_impl(clang::Expr* expr, Env* env_ptr) {
+  auto expr_info_ptr = parse_expr_simple(expr, env_ptr);
+  if (expr_info_ptr == nullptr) {
+    LOG(INFO) << "parse expr error, return nullptr! expr: " << stmt_to_string(expr);
+    return nullptr;
+  }
+
+  // 只执行与表达式相关的 update_env_*, 顺序与 EnvUpdater 一致。
+  ExprClass expr_class = classify_expr(expr_info_ptr);
+  EnvUpdaterStats::add(expr_class);
+
+  // 检查模式下跳过的也执行，通过 Env::generation() 判断是否修改了 Env。获取可修改的信息也会增加
+  // generation, 因此只会多报，不会漏报。
+  bool check_gate = GlobalConfig::Instance()->check_env_updater_gate;
+  for (const auto& updater : env_updaters) {
+    if (expr_class.has(updater.first)) {
+      updater.second(expr_info_ptr, env_ptr);
+    } else if (check_gate) {
+      uint64_t generation = Env::generation();
+      updater.second(expr_info_ptr, env_ptr);
+      if (Env::generation() != generation) {
+        EnvUpdaterStats::add_missed(updater.first);
+        LOG(ERROR) << "update_env_" << env_updater_name(updater.first)
+                   << " skipped by gate but changed env, expr: " << expr_info_ptr->origin_expr_str();
+      }
+    }
+  }
+
+  return expr_info_ptr;
+}
+
+}  // namespace
+
 void update_env_common_info(ExprInfo* expr_info_ptr, Env* env_ptr) {
   update_env_common_info_prepare(expr_info_ptr, env_ptr);
   update_env_common_info_normal(expr_info_ptr, env_ptr);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glog/logging.h>
+#include <cstdint>
 #include <memory>
 
 #include "clang/AST/Type.h"
@@ -15,10 +16,47 @@ namespace ad_algorithm {
 namespace convert {
 
 /// 解析表达式中基本的信息, 如 callee_nem_, parent_ 等, 用于下一步与 env_ptr 更新参数。
-std::shared_ptr<ExprInfo> parse_expr_simple(clang::Expr* expr, Env* env_ptr);
+ExprInfo* parse_expr_simple(clang::Expr* expr, Env* env_ptr);
 
 /// 更新 expr 中的各种信息到 env_ptr 中, 用于之后的替换。
-std::shared_ptr<ExprInfo> parse_expr(clang::Expr* expr, Env* env_ptr);
+///
+/// 在 ParseExprScope 中时，同一个 expr 和 env_ptr 在 Env 没有修改时只解析一次，之后直接返回同一个 ExprInfo。
+ExprInfo* parse_expr(clang::Expr* expr, Env* env_ptr);
+
+/// 表达式只解析一次的范围。
+///
+/// AdlogFieldHandler 处理一个节点时会依次调用所有规则，大部分规则都会对同一个节点调用 parse_expr,
+/// 每次都需要重新执行 parse_expr_simple 以及所有 update_env_*。在该范围内 parse_expr 的结果会被缓存，
+/// 所有规则共用同一个 ExprInfo, env 也只更新一次。范围可以嵌套，最外层结束时清空缓存。
+///
+/// 缓存时会记录 Env::generation(), 之后任何 Env 被修改 (包括规则中的修改) 都会重新解析，
+/// 保证结果与不缓存时一致。
+class ParseExprScope {
+ public:
+  ParseExprScope();
+  ~ParseExprScope();
+
+  ParseExprScope(const ParseExprScope&) = delete;
+  ParseExprScope& operator=(const ParseExprScope&) = delete;
+};
+
+/// 一个规则处理节点的范围。
+///
+/// 规则可能先拿到 Env 中信息的指针 (此时增加 Env::generation()), 在 parse_expr 之后再通过指针修改，
+/// 此时 generation 不会变化。因此规则自己修改过 Env 时, 结束时再增加一次 generation, 使其中缓存的结果失效。
+/// parse_expr 内部的修改已经反映在缓存的 generation 中，不需要处理。
+class ParseExprRuleScope {
+ public:
+  ParseExprRuleScope();
+  ~ParseExprRuleScope();
+
+  ParseExprRuleScope(const ParseExprRuleScope&) = delete;
+  ParseExprRuleScope& operator=(const ParseExprRuleScope&) = delete;
+
+ private:
+  uint64_t generation_ = 0;
+  uint64_t parse_env_changes_ = 0;
+};
 
 void update_env_common_info(ExprInfo* expr_info_ptr, Env* env_ptr);
 void update_env_action_detail(ExprInfo* expr_info_ptr, Env* env_ptr);
@@ -393,6 +393,7 @@ void update_env_common_info_normal_detail_def(ExprInfo* expr_info_ptr, Env* env_
                     << ", method_name: " << last_detail->method_name()
                     << ", bs_enum_str: " << last_detail->get_bs_enum_str();
           parent_env_ptr->add_common_info_detail_def(*last_detail);
+          env_ptr->add_common_info_field_access(*last_detail);
         }
       }
     }
@@ -411,6 +412,7 @@ void update_env_common_info_normal_detail_def(ExprInfo* expr_info_ptr, Env* env_
               common_info_detail->update_method_name(parent->callee_name());
               LOG(INFO) << "add common info list detail def, expr: " << expr_info_ptr->origin_expr_str();
               parent_env_ptr->add_common_info_detail_def(*common_info_detail);
+              env_ptr->add_common_info_field_access(*common_info_detail);
             }
           }
         }
@@ -615,6 +617,7 @@ void update_env_common_info_normal_helper_def(ExprInfo *expr_info_ptr, Env *env_
                       parent_env->add_new_def_meta(last_detail->get_bs_enum_str(),
                                                    last_detail->get_bs_list_def(env_ptr),
                                                    NewVarType::LIST);
+                      env_ptr->add_field_access(last_detail->get_bs_enum_str(), NewVarType::LIST);
                     }
                   }
                 }
@@ -830,7 +833,8 @@ void update_env_common_info_fixed_list_list_def(ExprInfo* expr_info_ptr, Env* en
                                               last_detail->get_functor_name(),
                                               last_detail->get_bs_list_field_def(env_ptr),
                                               NewVarType::LIST,
-                                              AdlogVarType::COMMON_INFO_FIXED);
+                                              AdlogVarType::COMMON_INFO_FIXED,
+                                              env_ptr->is_in_loop());
                   feature_info->set_common_info_prefix_name_value(bs_enum_str,
                                                                   last_detail->prefix_adlog(),
                                                                   last_detail->int_name());
@@ -863,7 +867,8 @@ void update_env_common_info_fixed_list_map_def(ExprInfo* expr_info_ptr, Env* env
                                             last_detail->get_functor_name(),
                                             last_detail->get_bs_map_field_def(env_ptr),
                                             NewVarType::MAP,
-                                            AdlogVarType::COMMON_INFO_FIXED);
+                                            AdlogVarType::COMMON_INFO_FIXED,
+                                            env_ptr->is_in_loop());
                 feature_info->set_common_info_prefix_name_value(last_detail->get_bs_enum_str(),
                                                                 last_detail->prefix_adlog(),
                                                                 last_detail->int_name());
@@ -896,7 +901,8 @@ void update_env_common_info_fixed_list_scalar_def(ExprInfo* expr_info_ptr, Env*
                                             last_detail->get_exists_functor_name(),
                                             last_detail->get_bs_scalar_exists_field_def(env_ptr),
                                             NewVarType::SCALAR,
-                                            AdlogVarType::COMMON_INFO_FIXED);
+                                            AdlogVarType::COMMON_INFO_FIXED,
+                                            env_ptr->is_in_loop());
                 feature_info->set_common_info_prefix_name_value(last_detail->get_bs_enum_str(),
                                                                 last_detail->prefix_adlog(),
                                                                 last_detail->int_name());
@@ -1024,7 +1030,8 @@ void update_env_common_info_multi_int_list_def(ExprInfo* expr_info_ptr, Env* env
                                                     common_info_multi_int_list->get_functor_name(v),
                                                     common_info_multi_int_list->get_bs_list_field_def(v),
                                                     NewVarType::LIST,
-                                                    AdlogVarType::COMMON_INFO_MULTI_INT_LIST);
+                                                    AdlogVarType::COMMON_INFO_MULTI_INT_LIST,
+                                                    env_ptr->is_in_loop());
                       }
                     }
                   }
@@ -1095,12 +1102,14 @@ void update_env_action_detail_check_cond(ExprInfo* expr_info_ptr, Env* env_ptr)
                 env_ptr->add_new_exists_def_helper(*bs_enum_str,
                                                    action_detail_info->get_action_detail_exists_def(env_ptr));
                 env_ptr->add_attr_meta(*bs_enum_str);
+                env_ptr->add_field_access(*bs_enum_str, absl::nullopt);
                 return;
               }
             }
 
             env_ptr->add_new_exists_def_meta(*bs_enum_str,
                                              action_detail_info->get_action_detail_exists_def(env_ptr));
+            env_ptr->add_field_access(*bs_enum_str, absl::nullopt);
           }
         } else {
           LOG(INFO) << "cannot get action_detail_info, expr: " << stmt_to_string(expr_info_ptr->expr());
@@ -1151,7 +1160,8 @@ void update_env_action_detail_fixed_touch(ExprInfo* expr_info_ptr, Env* env_ptr)
                                         action_detail_fixed_info->get_action_detail_exists_field_def(env_ptr),
                                         NewVarType::SCALAR,
                                         ExprType::ACTION_DETAIL_FIXED_HAS,
-                                        AdlogVarType::ACTION_DETAIL_FIXED);
+                                        AdlogVarType::ACTION_DETAIL_FIXED,
+                                        env_ptr->is_in_loop());
             feature_info->set_action_var_name(action_detail_fixed_info->get_bs_enum_str("list.size"), *action_name);
 
             if (auto constructor_info = env_ptr->mutable_constructor_info()) {
@@ -1202,7 +1212,8 @@ void update_env_action_detail_fixed_var_def(ExprInfo* expr_info_ptr, Env* env_pt
                                                                                       qual_type),
                                       NewVarType::LIST,
                                       ExprType::ACTION_DETAIL_FIXED_GET,
-                                      AdlogVarType::ACTION_DETAIL_FIXED);
+                                      AdlogVarType::ACTION_DETAIL_FIXED,
+                                      env_ptr->is_in_loop());
           feature_info->set_action_var_name(bs_enum_str, *field_name);
         } else {
           LOG(INFO) << "error, cannot find field_name from: " << expr_info_ptr->to_string();
@@ -1236,7 +1247,8 @@ void update_env_middle_node_root(ExprInfo* expr_info_ptr, Env* env_ptr) {
                                       leaf,
                                       middle_node_info->get_root_bs_exists_field_def(env_ptr),
                                       NewVarType::SCALAR,
-                                      AdlogVarType::MIDDLE_NODE_ROOT);
+                                      AdlogVarType::MIDDLE_NODE_ROOT,
+                                      env_ptr->is_in_loop());
           feature_info->set_middle_node_info(leaf, middle_node_info->name(), "");
         }
       }
@@ -1260,7 +1272,7 @@ void update_env_middle_node_leaf_def(ExprInfo* expr_info_ptr, Env* env_ptr) {
     // str 比较特殊，不能用最后的方法, 比如 x.size(), x.data()
     if (expr_info_ptr->parent() != nullptr &&
         expr_info_ptr->is_parent_str_type()) {
-      new_expr_info_ptr = expr_info_ptr->parent().get();
+      new_expr_info_ptr = expr_info_ptr->parent();
     }
 
     if (auto feature_info = env_ptr->mutable_feature_info()) {
@@ -1285,17 +1297,17 @@ void update_env_middle_node_leaf_def(ExprInfo* expr_info_ptr, Env* env_ptr) {
                                           middle_node_leaf,
                                           exists_field_def,
                                           NewVarType::SCALAR,
-                                          AdlogVarType::MIDDLE_NODE_LEAF);
+                                          AdlogVarType::MIDDLE_NODE_LEAF,
+                                          env_ptr->is_in_loop());
               feature_info->set_middle_node_info(bs_enum_str, middle_node_info->name(), new_expr_info_ptr->get_middle_node_field());
             } else if (expr_info_ptr->is_middle_node_leaf_list_size_method()) {
               // leaf list size 方法，需要处理 list。
               // 注意， 需要根据 bs_enum_str 从 feature_info 中获取相应的信息。
               bs_enum_str = expr_info_ptr->get_bs_enum_str_trim_size();
               middle_node_leaf = expr_info_ptr->get_bs_middle_node_leaf_trim_size();
-              const auto& middle_node_bs_enum_var_type = feature_info->middle_node_bs_enum_var_type();
-              auto it = middle_node_bs_enum_var_type.find(bs_enum_str);
-              if (it != middle_node_bs_enum_var_type.end()) {
-                if (const auto& list_inner_type = it->second.list_inner_type()) {
+              const NewVarDef* var_def = feature_info->find_middle_node_bs_enum_var_type(bs_enum_str);
+              if (var_def != nullptr) {
+                if (const auto& list_inner_type = var_def->list_inner_type()) {
                   std::string list_def = middle_node_info->get_bs_list_def(
                     env_ptr, bs_enum_str, middle_node_leaf, *list_inner_type);
                   LOG(INFO) << "add middle node list var def, bs_enum_str: " << bs_enum_str
@@ -1308,19 +1320,20 @@ void update_env_middle_node_leaf_def(ExprInfo* expr_info_ptr, Env* env_ptr) {
                   std::string list_field_def =
                     middle_node_info->get_bs_list_field_def(env_ptr,
                                                             middle_node_leaf,
-                                                            it->second.adlog_field(),
+                                                            var_def->adlog_field(),
                                                             *list_inner_type);
 
                   LOG(INFO) << "add middle node field def, bs_enum_str: " << bs_enum_str
                             << ", list field def : " << list_field_def
-                            << ", adlog_field: " << it->second.adlog_field()
+                            << ", adlog_field: " << var_def->adlog_field()
                             << ", inner_type: " << *list_inner_type;
                   feature_info->add_field_def(bs_enum_str,
                                               middle_node_leaf,
                                               list_field_def,
                                               NewVarType::LIST,
-                                              AdlogVarType::MIDDLE_NODE_LEAF);
-                  feature_info->set_middle_node_info(bs_enum_str, middle_node_info->name(), it->second.adlog_field());
+                                              AdlogVarType::MIDDLE_NODE_LEAF,
+                                              env_ptr->is_in_loop());
+                  feature_info->set_middle_node_info(bs_enum_str, middle_node_info->name(), var_def->adlog_field());
                 } else {
                   LOG(INFO) << "cannot find middle node list inner type in feature_info"
                             << ", bs_enum_str: " << bs_enum_str
@@ -1360,7 +1373,8 @@ void update_env_middle_node_leaf_def(ExprInfo* expr_info_ptr, Env* env_ptr) {
                                               middle_node_leaf,
                                               list_field_def,
                                               NewVarType::LIST,
-                                              AdlogVarType::MIDDLE_NODE_LEAF);
+                                              AdlogVarType::MIDDLE_NODE_LEAF,
+                                              env_ptr->is_in_loop());
                   feature_info->set_middle_node_info(bs_enum_str,
                                                      middle_node_info->name(),
                                                      new_expr_info_ptr->get_middle_node_field());
@@ -1392,7 +1406,8 @@ void update_env_middle_node_leaf_def(ExprInfo* expr_info_ptr, Env* env_ptr) {
                                             middle_node_leaf,
                                             field_def,
                                             NewVarType::SCALAR,
-                                            AdlogVarType::MIDDLE_NODE_LEAF);
+                                            AdlogVarType::MIDDLE_NODE_LEAF,
+                                            env_ptr->is_in_loop());
                 feature_info->set_middle_node_info(bs_enum_str,
                                                    middle_node_info->name(),
                                                    new_expr_info_ptr->get_middle_node_field());
@@ -1635,6 +1650,7 @@ void update_env_general_basic_scalar_def(ExprInfo* expr_info_ptr, Env* env_ptr)
                 bs_enum_str, decl_info->name(),
                 expr_info_ptr->get_bs_scalar_def(decl_info->name()),
                 NewVarType::SCALAR);
+              env_ptr->add_field_access(bs_enum_str, NewVarType::SCALAR);
               target_env->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
             } else {
               LOG(INFO) << "add basic sclar, bs_enum_str: " << bs_enum_str
@@ -1643,6 +1659,7 @@ void update_env_general_basic_scalar_def(ExprInfo* expr_info_ptr, Env* env_ptr)
               target_env->add_new_def_meta(
                 bs_enum_str, expr_info_ptr->get_bs_scalar_def(),
                 NewVarType::SCALAR);
+              env_ptr->add_field_access(bs_enum_str, NewVarType::SCALAR);
               target_env->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
             }
           }
@@ -1654,6 +1671,7 @@ void update_env_general_basic_scalar_def(ExprInfo* expr_info_ptr, Env* env_ptr)
           target_env->add_new_def_meta(bs_enum_str,
                                     expr_info_ptr->get_bs_scalar_def(),
                                     NewVarType::SCALAR);
+          env_ptr->add_field_access(bs_enum_str, NewVarType::SCALAR);
           target_env->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
         }
       }
@@ -1681,11 +1699,13 @@ void update_env_general_str_call(ExprInfo* expr_info_ptr, Env* env_ptr) {
               LOG(INFO) << "add loop var str list def, bs_enum_str: " << bs_enum_str
                         << ", list def: " << expr_parent->get_bs_list_def();
               env_ptr->add_new_def_meta(bs_enum_str, expr_parent->get_bs_list_def(), NewVarType::LIST);
+              env_ptr->add_field_access(bs_enum_str, NewVarType::LIST);
               env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_parent->get_adlog_field_str());
             } else {
               LOG(INFO) << "add scalar var str def, bs_enum_str: " << bs_enum_str
                         << ", scalar def: " << expr_parent->get_bs_scalar_def();
               env_ptr->add_new_def_meta(bs_enum_str, expr_parent->get_bs_scalar_def(), NewVarType::SCALAR);
+              env_ptr->add_field_access(bs_enum_str, NewVarType::SCALAR);
               env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_parent->get_adlog_field_str());
             }
           }
@@ -1719,6 +1739,7 @@ void update_env_general_loop_var_method(ExprInfo *expr_info_ptr, Env *env_ptr) {
               env_ptr->add_new_def_meta(bs_enum_str,
                                         expr_parent->get_bs_list_def(),
                                         NewVarType::LIST);
+              env_ptr->add_field_access(bs_enum_str, NewVarType::LIST);
               env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_parent->get_adlog_field_str());
             }
           }
@@ -1807,6 +1828,7 @@ void update_env_general_basic_expr(ExprInfo* expr_info_ptr, Env* env_ptr) {
                     << ", def: " << expr_info_ptr->get_bs_list_def()
                     << ", expr: " << expr_info_ptr->origin_expr_str();
           env_ptr->add_new_def_meta(bs_enum_str, expr_info_ptr->get_bs_list_def(), NewVarType::LIST);
+          env_ptr->add_field_access(bs_enum_str, NewVarType::LIST);
           env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
           if (auto& loop_info = env_ptr->mutable_loop_info()) {
             std::string var_name = env_ptr->find_new_var_name(bs_enum_str);
@@ -1837,12 +1859,14 @@ void update_env_general_basic_expr(ExprInfo* expr_info_ptr, Env* env_ptr) {
                     << ", def: " << expr_info_ptr->get_bs_list_def()
                     << ", expr: " << expr_info_ptr->origin_expr_str();
           env_ptr->add_new_def_meta(bs_enum_str, expr_info_ptr->get_bs_list_def(), NewVarType::LIST);
+          env_ptr->add_field_access(bs_enum_str, NewVarType::LIST);
           env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
         } else if (absl::optional<std::string> int_param = expr_info_ptr->find_int_param()) {
           LOG(INFO) << "add list var def with meta, has int_param, bs_enum_str: " << bs_enum_str
                     << ", def: " << expr_info_ptr->get_bs_list_def()
                     << ", expr: " << expr_info_ptr->origin_expr_str();
           env_ptr->add_new_def_meta(bs_enum_str, expr_info_ptr->get_bs_list_def(), NewVarType::LIST);
+          env_ptr->add_field_access(bs_enum_str, NewVarType::LIST);
           env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
         } else {
           LOG(INFO) << "cannot find loop parent, expr: " << stmt_to_string(expr_info_ptr->expr());
@@ -1865,6 +1889,7 @@ void update_env_general_basic_expr(ExprInfo* expr_info_ptr, Env* env_ptr) {
                 env_ptr->add_new_def_meta(bs_enum_str, decl_info->name(),
                                              expr_info_ptr->get_bs_scalar_def(decl_info->name()),
                                              NewVarType::SCALAR);
+                env_ptr->add_field_access(bs_enum_str, NewVarType::SCALAR);
                 env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
               } else {
                 LOG(INFO) << "add scalar def, bs_enum_str: " << bs_enum_str
@@ -1872,6 +1897,7 @@ void update_env_general_basic_expr(ExprInfo* expr_info_ptr, Env* env_ptr) {
                 env_ptr->add_new_def_meta(bs_enum_str,
                                              expr_info_ptr->get_bs_scalar_def(),
                                              NewVarType::SCALAR);
+                env_ptr->add_field_access(bs_enum_str, NewVarType::SCALAR);
                 env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
               }
             }
@@ -1881,6 +1907,7 @@ void update_env_general_basic_expr(ExprInfo* expr_info_ptr, Env* env_ptr) {
             env_ptr->add_new_def_meta(bs_enum_str,
                                          expr_info_ptr->get_bs_scalar_def(),
                                          NewVarType::SCALAR);
+            env_ptr->add_field_access(bs_enum_str, NewVarType::SCALAR);
             env_ptr->set_normal_adlog_field_info(bs_enum_str, expr_info_ptr->get_adlog_field_str());
           }
         }
@@ -2113,6 +2140,11 @@ void update_env_general_proto_map_loop(ExprInfo* expr_info_ptr, Env* env_ptr) {
                                   NewVarType::MAP);
               parent->add_attr_meta(bs_enum_str + "_key");
               parent->add_attr_meta(bs_enum_str + "_value");
+
+              // 访问方式以当前 env 为准，定义在 parent 中。
+              env_ptr->add_field_access(bs_enum_str, NewVarType::MAP);
+              env_ptr->add_field_access(bs_enum_str + "_key", absl::nullopt);
+              env_ptr->add_field_access(bs_enum_str + "_value", absl::nullopt);
             }
           }
         }
@@ -2126,13 +2158,14 @@ void update_env_general_proto_list_size_method(ExprInfo* expr_info_ptr, Env* env
   // end 来自循环变量
   if (!expr_info_ptr->is_from_repeated_common_info()) {
     if (expr_info_ptr->callee_name() == "size" || expr_info_ptr->is_from_implicit_loop_var()) {
-      if (auto parent = expr_info_ptr->parent().get()) {
+      if (auto parent = expr_info_ptr->parent()) {
         if (parent->is_repeated_proto_list_leaf_type()) {
           std::string bs_enum_str = parent->get_bs_enum_str();
           if (bs_enum_str.size() > 0 && tool::is_adlog_field(bs_enum_str)) {
             LOG(INFO) << "add proto list leaf def, bs_enum_str: " << bs_enum_str
                       << ", list def: " << parent->get_bs_list_def();
             env_ptr->add_new_def_meta(bs_enum_str, parent->get_bs_list_def(), NewVarType::LIST);
+            env_ptr->add_field_access(bs_enum_str, NewVarType::LIST);
             env_ptr->set_normal_adlog_field_info(bs_enum_str, parent->get_adlog_field_str());
           }
         }
@@ -0,0 +1,89 @@
+#include <memory>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "clang/Basic/SourceManager.h"
+#include "clang/Lex/PPCallbacks.h"
+
+#include "ConvertCache.h"
+#include "IncludeGraph.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+namespace {
+
+/// 进入新的文件时，通过 include 的位置找到包含它的文件。
+class IncludeGraphCallbacks : public clang::PPCallbacks {
+ public:
+  IncludeGraphCallbacks(const clang::SourceManager& source_manager, IncludeGraph* include_graph):
+    source_manager_(source_manager), include_graph_(include_graph) {}
+
+  void FileChanged(clang::SourceLocation loc,
+                   FileChangeReason reason,
+                   clang::SrcMgr::CharacteristicKind file_type,
+                   clang::FileID prev_fid) override {
+    if (reason != EnterFile || clang::SrcMgr::isSystem(file_type)) {
+      return;
+    }
+
+    clang::FileID file_id = source_manager_.getFileID(loc);
+    clang::SourceLocation include_loc = source_manager_.getIncludeLoc(file_id);
+    if (include_loc.isInvalid()) {
+      return;
+    }
+
+    const clang::FileEntry* file_entry = source_manager_.getFileEntryForID(file_id);
+    const clang::FileEntry* includer_entry =
+      source_manager_.getFileEntryForID(source_manager_.getFileID(include_loc));
+    if (file_entry == nullptr || includer_entry == nullptr) {
+      return;
+    }
+
+    include_graph_->add_include(ConvertCache::to_absolute_path(includer_entry->getName().str()),
+                                ConvertCache::to_absolute_path(file_entry->getName().str()));
+  }
+
+ private:
+  const clang::SourceManager& source_manager_;
+  IncludeGraph* include_graph_ = nullptr;
+};
+
+}  // namespace
+
+void IncludeGraph::attach_to_preprocessor(clang::Preprocessor& preprocessor) {
+  preprocessor.addPPCallbacks(std::make_unique<IncludeGraphCallbacks>(preprocessor.getSourceManager(), this));
+}
+
+std::vector<std::string> IncludeGraph::get_transitive_includes(const std::string& filename) const {
+  std::set<std::string> visited = {filename};
+  std::queue<std::string> q;
+  q.push(filename);
+
+  while (!q.empty()) {
+    auto it = includes_.find(q.front());
+    q.pop();
+    if (it == includes_.end()) {
+      continue;
+    }
+
+    for (const std::string& included : it->second) {
+      if (visited.insert(included).second) {
+        q.push(included);
+      }
+    }
+  }
+
+  return std::vector<std::string>(visited.begin(), visited.end());
+}
+
+void IncludeGraph::add_include(const std::string& includer, const std::string& included) {
+  includes_[includer].insert(included);
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
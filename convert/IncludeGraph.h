@@ -0,0 +1,35 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "clang/Lex/Preprocessor.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// 源文件中非系统头文件之间的包含关系，用于计算特征类所在头文件的依赖，见 `ConvertCache`。
+///
+/// `clang::DependencyCollector` 只能得到源文件的所有依赖，一个源文件中可能有多个头文件中的类，
+/// 每个类的缓存只需要依赖类所在的头文件以及它直接或者间接包含的头文件。预编译头中的头文件不会出现在这里。
+class IncludeGraph {
+ public:
+  /// 在预处理器中注册回调，预处理时记录包含关系。
+  void attach_to_preprocessor(clang::Preprocessor& preprocessor);
+
+  /// filename 以及它直接或者间接包含的所有头文件，都是绝对路径。
+  std::vector<std::string> get_transitive_includes(const std::string& filename) const;
+
+  void add_include(const std::string& includer, const std::string& included);
+
+ private:
+  /// 文件的绝对路径到其直接包含的头文件。
+  std::unordered_map<std::string, std::set<std::string>> includes_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
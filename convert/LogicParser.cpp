@@ -3,7 +3,6 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
-#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <regex>
@@ -17,6 +16,9 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/AST/ASTConsumer.h"
 
+#include "Tool.h"
+#include "ExprInfoArena.h"
+#include "TypeCategory.h"
 #include "LogicParser.h"
 
 namespace ks {
@@ -37,11 +39,12 @@ using clang::ast_matchers::isExpandedFromMacro;
 using clang::ast_matchers::isDerivedFrom;
 
 LogicConsumer::LogicConsumer(clang::Rewriter &R):
-  bs_feature_decl_callback_(R) {
+  bs_feature_decl_callback_(R),
+  deferred_bs_feature_decl_callback_(&bs_feature_decl_callback_) {
   // 目前只能匹配到 typeAliasDecl(), 可能会有更好的匹配。
   auto BSTypeAliasMatcher = decl(typeAliasDecl(),
                                  namedDecl(matchesName("BSExtract.*"))).bind("BSTypeAlias");
-  bs_type_alias_finder_.addMatcher(BSTypeAliasMatcher, &bs_type_alias_callback_);
+  bs_match_finder_.addMatcher(BSTypeAliasMatcher, &bs_type_alias_callback_);
 
   // TK_IgnoreUnlessSpelledInSource 用来忽略模板
   auto BSFeatureDeclMatcher = traverse(TK_IgnoreUnlessSpelledInSource,
@@ -49,50 +52,67 @@ LogicConsumer::LogicConsumer(clang::Rewriter &R):
                                                      unless(isExpandedFromMacro("DISALLOW_COPY_AND_ASSIGN")),
                                                      unless(isExpandedFromMacro("REGISTER_BS_EXTRACTOR")))).bind("BSFeatureDecl");  // NOLINT
 
-  bs_match_finder_.addMatcher(BSFeatureDeclMatcher, &bs_feature_decl_callback_);
+  bs_match_finder_.addMatcher(BSFeatureDeclMatcher, &deferred_bs_feature_decl_callback_);
 }
 
 void LogicConsumer::HandleTranslationUnit(clang::ASTContext &Context) {
-  // 解析模板参数, 这一步必须在解析 Extract 之前, 因为这些参数会被用到。
-  bs_type_alias_finder_.matchAST(Context);
+  // 只遍历特征相关文件中的 decl。
+  tool::restrict_traversal_scope(&Context, GlobalConfig::Instance()->allowed_paths);
 
-  // 解析 BSExtract 逻辑。
+  // 只遍历一次 ast, 遍历时直接解析模板参数，BSExtract 只保存匹配结果。
   bs_match_finder_.matchAST(Context);
+
+  // 解析 BSExtract 逻辑。模板参数在遍历时已经解析完，因此必须在遍历之后。
+  deferred_bs_feature_decl_callback_.flush();
 }
 
 void LogicParser::EndSourceFileAction() {
   auto config = GlobalConfig::Instance();
   {
-    std::lock_guard<std::mutex> lock(config->mu);
-
-    std::string cmd_format("clang-format "
-                           "--style=\"{BasedOnStyle: Google, ColumnLimit: 110, IndentCaseLabels: true}\" -i ");  // NOLINT
-
-    for (auto it = config->feature_info.begin(); it != config->feature_info.end(); it++) {
-      const std::string& bs_extractor_name = it->first;
-      const FeatureInfo& feature_info = it->second;
+    // 一个源文件的所有改动只需要写一次，直接在内存中格式化后写入。
+    clang::SourceManager& source_manager = rewriter_.getSourceMgr();
+    for (auto it = rewriter_.buffer_begin(); it != rewriter_.buffer_end(); it++) {
+      const clang::FileEntry* file_entry = source_manager.getFileEntryForID(it->first);
+      if (file_entry == nullptr) {
+        continue;
+      }
 
-      const std::string& origin_file = feature_info.origin_file();
-      if (origin_file.size() == 0) {
-        LOG(INFO) << "origin_file is empty! feature_name: " << bs_extractor_name;
+      // 公共头文件可能同时被其他线程改写。
+      std::string filename = file_entry->getName().str();
+      if (!config->claim_emission(filename)) {
+        LOG(INFO) << "already rewritten by other source file, skip! filename: " << filename;
         continue;
       }
 
-      if (rewriter_.overwriteChangedFiles()) {
-        LOG(INFO) << "rewrite to file: " << origin_file;
+      std::string content;
+      llvm::raw_string_ostream raw_string(content);
+      it->second.write(raw_string);
+      raw_string.flush();
+
+      if (tool::write_formatted_file(filename, content)) {
+        LOG(INFO) << "rewrite to file: " << filename;
       }
+    }
+
+    for (const std::string& bs_extractor_name : config->cur_file_features) {
+      FeatureInfo* feature_info = config->feature_info_ptr(bs_extractor_name);
+      feature_info->set_is_emitted(true);
 
-      std::system((cmd_format + origin_file).c_str());
-      if (const auto& cc_filename = it->second.cc_filename()) {
-        std::system((cmd_format + cc_filename.value()).c_str());
+      if (feature_info->origin_file().size() == 0) {
+        LOG(INFO) << "origin_file is empty! feature_name: " << bs_extractor_name;
       }
     }
+
+    config->cur_file_features.clear();
   }
 }
 
 std::unique_ptr<clang::ASTConsumer> LogicParser::CreateASTConsumer(clang::CompilerInstance &CI,   // NOLINT
                                                                    llvm::StringRef file) {
   rewriter_.setSourceMgr(CI.getSourceManager(), CI.getLangOpts());
+  clear_stmt_string_cache();
+  ExprInfoArena::clear_thread_arena();
+  TypeCategoryCache::clear();
 
   return std::make_unique<LogicConsumer>(rewriter_);
 }
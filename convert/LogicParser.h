@@ -17,6 +17,7 @@
 
 #include "matcher_callback/BSTypeAliasCallback.h"
 #include "matcher_callback/BSFeatureDeclCallback.h"
+#include "matcher_callback/DeferredCallback.h"
 
 namespace ks {
 namespace ad_algorithm {
@@ -29,11 +30,14 @@ class LogicConsumer : public clang::ASTConsumer {
   void HandleTranslationUnit(clang::ASTContext &Context) override;  // NOLINT
 
  public:
+  /// `BSTypeAliasDecl` 和 `BSFeatureDecl` 放在同一个 `MatchFinder` 中，只遍历一次 ast。
   clang::ast_matchers::MatchFinder bs_match_finder_;
-  clang::ast_matchers::MatchFinder bs_type_alias_finder_;
 
   BSFeatureDeclCallback bs_feature_decl_callback_;
   BSTypeAliasCallback bs_type_alias_callback_;
+
+  /// `BSFeatureDecl` 依赖 `BSTypeAliasDecl` 解析出的模板参数，需要等遍历结束后再处理。
+  DeferredCallback deferred_bs_feature_decl_callback_;
 };
 
 class LogicParser : public clang::ASTFrontendAction {
@@ -0,0 +1,102 @@
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+#include "Config.h"
+#include "ConvertAction.h"
+#include "ParallelRunner.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+ParallelRunner::ParallelRunner(const clang::tooling::CompilationDatabase& compilations,
+                               const std::vector<std::string>& source_paths,
+                               int jobs):
+  compilations_(compilations),
+  source_paths_(source_paths),
+  jobs_(jobs),
+  file_field_outputs_(source_paths.size(), json::object()) {
+  if (jobs_ <= 0) {
+    jobs_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+void ParallelRunner::append_arguments_adjuster(clang::tooling::ArgumentsAdjuster adjuster) {
+  arguments_adjuster_ = clang::tooling::combineAdjusters(std::move(arguments_adjuster_), std::move(adjuster));
+}
+
+int ParallelRunner::run(clang::tooling::FrontendActionFactory* action_factory) {
+  size_t num_threads = std::min(static_cast<size_t>(jobs_), source_paths_.size());
+  LOG(INFO) << "start parallel run, files: " << source_paths_.size()
+            << ", threads: " << num_threads;
+
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < num_threads; i++) {
+    workers.emplace_back(&ParallelRunner::run_worker, this, action_factory);
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  return ret_.load();
+}
+
+void ParallelRunner::run_worker(clang::tooling::FrontendActionFactory* action_factory) {
+  while (true) {
+    size_t index = next_index_.fetch_add(1);
+    if (index >= source_paths_.size()) {
+      break;
+    }
+
+    const std::string& path = source_paths_[index];
+    GlobalConfig::clear_thread_state();
+
+    // 每个线程使用单独的文件系统, 避免 ClangTool 修改工作目录时相互影响。
+    clang::tooling::ClangTool tool(compilations_,
+                                   {path},
+                                   std::make_shared<clang::PCHContainerOperations>(),
+                                   llvm::vfs::createPhysicalFileSystem());
+    if (arguments_adjuster_) {
+      tool.appendArgumentsAdjuster(arguments_adjuster_);
+    }
+
+    if (tool.run(action_factory) != 0) {
+      LOG(ERROR) << "run failed, path: " << path;
+      ret_.store(1);
+    }
+
+    json& field_output = file_field_outputs_[index];
+    field_output = ConvertAction::gen_field_output();
+
+    LOG(INFO) << "done, path: " << path << ", features: " << field_output.size();
+  }
+
+  GlobalConfig::clear_thread_state();
+}
+
+json ParallelRunner::merge_field_output() const {
+  json res = json::object();
+
+  for (size_t i = 0; i < file_field_outputs_.size(); i++) {
+    for (auto it = file_field_outputs_[i].begin(); it != file_field_outputs_[i].end(); it++) {
+      if (res.contains(it.key())) {
+        continue;
+      }
+
+      res[it.key()] = it.value();
+    }
+  }
+
+  return res;
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Tooling.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+using nlohmann::json;
+
+/// 多线程处理多个源文件。
+///
+/// 每个线程依次领取一个源文件，单独创建 `ClangTool` 进行处理。`FeatureInfo` 等解析状态在 `GlobalConfig`
+/// 中是 `thread_local` 的，每个源文件处理前会清空，因此各个源文件之间互不影响。
+///
+/// 每个源文件处理完后会按源文件下标保存其特征的 `output`, 所有源文件处理完后按源文件顺序合并，
+/// 同名特征以最靠前的源文件为准，保证结果和线程调度顺序无关。
+class ParallelRunner {
+ public:
+  explicit ParallelRunner(const clang::tooling::CompilationDatabase& compilations,
+                          const std::vector<std::string>& source_paths,
+                          int jobs);
+
+  /// 每个 `ClangTool` 都会添加的参数调整，如预编译头。
+  void append_arguments_adjuster(clang::tooling::ArgumentsAdjuster adjuster);
+
+  /// 返回值和 `ClangTool::run` 一致，有任何一个源文件处理失败则返回 1。
+  int run(clang::tooling::FrontendActionFactory* action_factory);
+
+  /// 合并所有源文件的特征字段信息。
+  json merge_field_output() const;
+
+ private:
+  void run_worker(clang::tooling::FrontendActionFactory* action_factory);
+
+ private:
+  const clang::tooling::CompilationDatabase& compilations_;
+  std::vector<std::string> source_paths_;
+  int jobs_ = 1;
+
+  clang::tooling::ArgumentsAdjuster arguments_adjuster_;
+
+  /// 下一个待处理的源文件下标。
+  std::atomic<size_t> next_index_{0};
+
+  std::atomic<int> ret_{0};
+
+  /// 每个源文件对应的特征字段信息，下标和 source_paths_ 一致。
+  std::vector<json> file_field_outputs_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,210 @@
+#include <absl/strings/str_join.h>
+#include <absl/strings/str_split.h>
+#include <glog/logging.h>
+
+#include <memory>
+#include <sstream>
+
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
+
+#include "Tool.h"
+#include "PchManager.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+namespace {
+
+/// 生成预编译头，同时输出依赖文件。输出路径直接在 CompilerInstance 中设置，不依赖 driver 对参数的处理。
+class BuildPchAction : public clang::GeneratePCHAction {
+ public:
+  BuildPchAction(const std::string& pch_filename, const std::string& dep_filename):
+    pch_filename_(pch_filename), dep_filename_(dep_filename) {}
+
+  bool BeginInvocation(clang::CompilerInstance& CI) override {
+    CI.getFrontendOpts().OutputFile = pch_filename_;
+    CI.getDependencyOutputOpts().OutputFile = dep_filename_;
+    CI.getDependencyOutputOpts().Targets = {pch_filename_};
+    return clang::GeneratePCHAction::BeginInvocation(CI);
+  }
+
+ private:
+  std::string pch_filename_;
+  std::string dep_filename_;
+};
+
+class BuildPchActionFactory : public clang::tooling::FrontendActionFactory {
+ public:
+  BuildPchActionFactory(const std::string& pch_filename, const std::string& dep_filename):
+    pch_filename_(pch_filename), dep_filename_(dep_filename) {}
+
+  std::unique_ptr<clang::FrontendAction> create() override {
+    return std::make_unique<BuildPchAction>(pch_filename_, dep_filename_);
+  }
+
+ private:
+  std::string pch_filename_;
+  std::string dep_filename_;
+};
+
+}  // namespace
+
+PchManager::PchManager(const clang::tooling::CompilationDatabase& compilations,
+                       const std::string& pch_header,
+                       const std::string& pch_dir):
+  compilations_(compilations),
+  pch_header_(pch_header),
+  pch_dir_(pch_dir) {
+}
+
+absl::optional<std::string> PchManager::prepare(const std::string& sample_source) {
+  std::vector<clang::tooling::CompileCommand> commands = compilations_.getCompileCommands(sample_source);
+  if (commands.size() == 0) {
+    LOG(ERROR) << "cannot find compile command, sample_source: " << sample_source;
+    return absl::nullopt;
+  }
+
+  // 去掉编译器、源文件以及输出相关的参数，只保留影响解析的参数。
+  const clang::tooling::CompileCommand& command = commands[0];
+  llvm::StringRef source_name = llvm::sys::path::filename(command.Filename);
+
+  std::vector<std::string> args;
+  for (size_t i = 1; i < command.CommandLine.size(); i++) {
+    const std::string& arg = command.CommandLine[i];
+    if (arg == "-o" || arg == "-MT" || arg == "-MF" || arg == "-MQ") {
+      i++;
+      continue;
+    }
+
+    if (arg == "-c" || arg == "-M" || arg == "-MM" || arg == "-MD" || arg == "-MMD") {
+      continue;
+    }
+
+    if (arg.size() > 0 && arg[0] != '-' && llvm::sys::path::filename(arg) == source_name) {
+      continue;
+    }
+
+    args.push_back(arg);
+  }
+
+  std::ostringstream oss;
+  oss << std::hex << llvm::xxHash64(pch_header_ + "\n" + absl::StrJoin(args, " "));
+
+  // 编译时的工作目录是编译参数中的目录，因此需要使用绝对路径。
+  llvm::SmallString<256> abs_pch_dir(pch_dir_);
+  llvm::sys::fs::make_absolute(abs_pch_dir);
+
+  std::string stem = llvm::sys::path::stem(pch_header_).str();
+  std::string pch_filename = abs_pch_dir.str().str() + "/" + stem + "_" + oss.str() + ".pch";
+  std::string dep_filename = pch_filename + ".d";
+
+  // 头文件没有修改时直接复用，不再检查所有依赖。
+  absl::optional<llvm::sys::TimePoint<>> header_mtime = get_header_mtime();
+  auto it_checked = checked_pch_.find(pch_filename);
+  if (it_checked != checked_pch_.end() && header_mtime && it_checked->second == *header_mtime) {
+    return absl::make_optional(pch_filename);
+  }
+
+  if (!is_stale(pch_filename, dep_filename)) {
+    LOG(INFO) << "reuse pch: " << pch_filename;
+    if (header_mtime) {
+      checked_pch_[pch_filename] = *header_mtime;
+    }
+    return absl::make_optional(pch_filename);
+  }
+
+  if (std::error_code ec = llvm::sys::fs::create_directories(abs_pch_dir)) {
+    LOG(ERROR) << "create pch dir failed, pch_dir: " << pch_dir_ << ", err: " << ec.message();
+    return absl::nullopt;
+  }
+
+  if (!build(args, command.Directory, pch_filename, dep_filename)) {
+    llvm::sys::fs::remove(pch_filename);
+    llvm::sys::fs::remove(dep_filename);
+    checked_pch_.erase(pch_filename);
+    return absl::nullopt;
+  }
+
+  LOG(INFO) << "build pch done: " << pch_filename;
+  if (header_mtime) {
+    checked_pch_[pch_filename] = *header_mtime;
+  }
+  return absl::make_optional(pch_filename);
+}
+
+absl::optional<llvm::sys::TimePoint<>> PchManager::get_header_mtime() const {
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(pch_header_, status)) {
+    return absl::nullopt;
+  }
+
+  return absl::make_optional(status.getLastModificationTime());
+}
+
+clang::tooling::ArgumentsAdjuster PchManager::get_include_pch_adjuster(const std::string& pch_filename) {
+  return clang::tooling::getInsertArgumentAdjuster({"-include-pch", pch_filename},
+                                                   clang::tooling::ArgumentInsertPosition::BEGIN);
+}
+
+bool PchManager::is_stale(const std::string& pch_filename, const std::string& dep_filename) const {
+  llvm::sys::fs::file_status pch_status;
+  if (llvm::sys::fs::status(pch_filename, pch_status)) {
+    return true;
+  }
+
+  // make 格式的依赖文件: target: dep1 dep2 \ ...
+  std::string dep_content = tool::read_file_to_string(dep_filename);
+  if (dep_content.size() == 0) {
+    return true;
+  }
+
+  std::vector<std::string> deps = absl::StrSplit(dep_content, absl::ByAnyChar(" \t\r\n\\"), absl::SkipEmpty());
+  for (const std::string& dep : deps) {
+    if (dep.back() == ':') {
+      continue;
+    }
+
+    llvm::sys::fs::file_status dep_status;
+    if (llvm::sys::fs::status(dep, dep_status)) {
+      LOG(INFO) << "pch dep not exists, dep: " << dep;
+      return true;
+    }
+
+    if (dep_status.getLastModificationTime() > pch_status.getLastModificationTime()) {
+      LOG(INFO) << "pch dep changed, dep: " << dep;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool PchManager::build(const std::vector<std::string>& args,
+                       const std::string& directory,
+                       const std::string& pch_filename,
+                       const std::string& dep_filename) const {
+  std::vector<std::string> pch_args = {"-x", "c++-header"};
+  pch_args.insert(pch_args.end(), args.begin(), args.end());
+
+  clang::tooling::FixedCompilationDatabase pch_compilations(directory, pch_args);
+  clang::tooling::ClangTool tool(pch_compilations, {pch_header_});
+
+  BuildPchActionFactory factory(pch_filename, dep_filename);
+  if (tool.run(&factory) != 0) {
+    LOG(ERROR) << "build pch failed, pch_header: " << pch_header_;
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <absl/types/optional.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/Support/Chrono.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// 管理公共头文件的预编译头。
+///
+/// 每个特征都会 include 大量相同的头文件，如 protobuf、`ad_joint_labeled_log.pb.h` 以及 frame 中的头文件，
+/// 每个源文件都需要重新解析一遍。将这些头文件 include 到 `--pch-header` 指定的头文件中，转换前先用第一个
+/// 源文件的编译参数生成预编译头，之后每个源文件通过 `-include-pch` 直接加载。
+///
+/// 预编译头保存在 `--pch-dir` 中，文件名由头文件路径和编译参数的 hash 决定，多次运行之间可以复用。
+/// 生成时同时输出依赖文件，如果预编译头不存在或者任意一个依赖比预编译头新，则重新生成。
+///
+/// 同一个进程中检查过的预编译头会记录下来，serve 模式下之后的请求只要编译参数相同、`--pch-header`
+/// 没有修改，就直接复用，不再检查所有依赖。
+class PchManager {
+ public:
+  explicit PchManager(const clang::tooling::CompilationDatabase& compilations,
+                      const std::string& pch_header,
+                      const std::string& pch_dir);
+
+  /// 生成或者复用预编译头，返回预编译头路径，失败则返回 absl::nullopt, 此时按原来的方式解析。
+  absl::optional<std::string> prepare(const std::string& sample_source);
+
+  /// 添加 `-include-pch` 参数。
+  static clang::tooling::ArgumentsAdjuster get_include_pch_adjuster(const std::string& pch_filename);
+
+ private:
+  /// 预编译头不存在或者依赖有变化。
+  bool is_stale(const std::string& pch_filename, const std::string& dep_filename) const;
+
+  bool build(const std::vector<std::string>& args,
+             const std::string& directory,
+             const std::string& pch_filename,
+             const std::string& dep_filename) const;
+
+  /// pch_header_ 的修改时间，获取失败返回 absl::nullopt。
+  absl::optional<llvm::sys::TimePoint<>> get_header_mtime() const;
+
+ private:
+  const clang::tooling::CompilationDatabase& compilations_;
+  std::string pch_header_;
+  std::string pch_dir_;
+
+  /// 已经检查过的预编译头以及检查时 pch_header_ 的修改时间。
+  std::unordered_map<std::string, llvm::sys::TimePoint<>> checked_pch_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
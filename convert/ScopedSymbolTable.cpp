@@ -0,0 +1,131 @@
+#include <glog/logging.h>
+
+#include <algorithm>
+
+#include "ScopedSymbolTable.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+ScopedSymbolTable::ScopeId ScopedSymbolTable::push_scope() {
+  ScopeId scope = next_scope_++;
+  scopes_.emplace_back();
+  scopes_.back().scope = scope;
+  return scope;
+}
+
+void ScopedSymbolTable::pop_scope(ScopeId scope) {
+  if (scopes_.size() == 0 || scopes_.back().scope != scope) {
+    LOG(ERROR) << "pop scope out of order, scope: " << scope;
+    return;
+  }
+
+  // 绑定可能已经被 unbind 删除，只弹出栈顶仍属于该 scope 的绑定。
+  const std::vector<Trail>& trail = scopes_.back().trail;
+  for (size_t i = trail.size(); i-- > 0;) {
+    std::vector<Binding>& stack = stacks_[static_cast<size_t>(trail[i].kind)][trail[i].symbol];
+    if (stack.size() > 0 && stack.back().scope == scope) {
+      stack.pop_back();
+    }
+  }
+
+  scopes_.pop_back();
+}
+
+void ScopedSymbolTable::bind(ScopeId scope,
+                             Kind kind,
+                             const std::string& name,
+                             Env* env,
+                             clang::Stmt* value,
+                             bool is_multi) {
+  auto it_scope = std::lower_bound(scopes_.begin(),
+                                   scopes_.end(),
+                                   scope,
+                                   [](const ScopeTrail& x, ScopeId id) { return x.scope < id; });
+  if (it_scope == scopes_.end() || it_scope->scope != scope) {
+    LOG(ERROR) << "bind to scope not exists, scope: " << scope << ", name: " << name;
+    return;
+  }
+
+  Symbol symbol = Symbol::intern(name);
+  std::vector<Binding>& stack = stacks_[static_cast<size_t>(kind)][symbol];
+
+  // 内层 scope 的绑定在上面，插入到它们下面。
+  size_t pos = stack.size();
+  while (pos > 0 && stack[pos - 1].scope > scope) {
+    pos--;
+  }
+
+  if (!is_multi && pos > 0 && stack[pos - 1].scope == scope) {
+    stack[pos - 1].value = value;
+    return;
+  }
+
+  Binding binding;
+  binding.scope = scope;
+  binding.env = env;
+  binding.value = value;
+  stack.insert(stack.begin() + pos, binding);
+
+  it_scope->trail.push_back(Trail{kind, symbol});
+}
+
+void ScopedSymbolTable::unbind(ScopeId scope, Kind kind, const std::string& name) {
+  std::vector<Binding>* stack = find_stack(kind, name);
+  if (stack == nullptr) {
+    return;
+  }
+
+  size_t pos = stack->size();
+  while (pos > 0 && (*stack)[pos - 1].scope > scope) {
+    pos--;
+  }
+
+  if (pos > 0 && (*stack)[pos - 1].scope == scope) {
+    stack->erase(stack->begin() + (pos - 1));
+  }
+}
+
+const ScopedSymbolTable::Binding* ScopedSymbolTable::lookup(ScopeId scope,
+                                                            Kind kind,
+                                                            const std::string& name) const {
+  const std::vector<Binding>* stack = find_stack(kind, name);
+  if (stack == nullptr) {
+    return nullptr;
+  }
+
+  // 栈顶可能是更内层 scope 的绑定，需要跳过。
+  for (size_t i = stack->size(); i-- > 0;) {
+    if ((*stack)[i].scope <= scope) {
+      return &(*stack)[i];
+    }
+  }
+
+  return nullptr;
+}
+
+std::vector<ScopedSymbolTable::Binding>* ScopedSymbolTable::find_stack(Kind kind, const std::string& name) {
+  const ScopedSymbolTable* self = this;
+  return const_cast<std::vector<Binding>*>(self->find_stack(kind, name));
+}
+
+const std::vector<ScopedSymbolTable::Binding>* ScopedSymbolTable::find_stack(Kind kind,
+                                                                             const std::string& name) const {
+  absl::optional<Symbol> symbol = Symbol::find(name);
+  if (!symbol) {
+    return nullptr;
+  }
+
+  const std::unordered_map<Symbol, std::vector<Binding>>& stacks = stacks_[static_cast<size_t>(kind)];
+  auto it = stacks.find(*symbol);
+  if (it == stacks.end()) {
+    return nullptr;
+  }
+
+  return &it->second;
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
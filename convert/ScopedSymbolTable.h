@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "clang/AST/Stmt.h"
+
+#include "Symbol.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+class Env;
+
+/// `Env` 中按变量名向上查找的符号表。
+///
+/// `Env::find`、`Env::get_decl_stmt` 等原来需要沿着 `parent` 逐层查找每个 `Env` 中的 `std::map`,
+/// 嵌套较深时每次查找都是 O(depth * log n) 次字符串比较。一个根 `Env` 及其所有子 `Env` 共享一个
+/// `ScopedSymbolTable`, 每个 `Env` 对应一个 scope。
+///
+/// 变量名通过 `Symbol` 转换为整数 id, 每个 (kind, id) 对应一个绑定栈，栈顶是最内层 scope 的绑定。
+/// `Env` 都是递归遍历时的局部变量，严格按栈的顺序创建和销毁，因此 scope id 单调递增，并且还存在的
+/// 绑定都属于当前路径上的 scope。从某个 scope 查找时，第一个 scope id 不大于它的绑定就是沿着 `parent`
+/// 查找能找到的绑定。
+///
+/// 也可以在外层还存在的 scope 中添加绑定，如 `operator=` 在子 `Env` 中处理时会添加到 `parent` 中。
+/// 绑定按 scope id 插入到栈中对应的位置，每个栈始终按 scope id 有序，内层 scope 的同名绑定依然在上面。
+///
+/// 每个 scope 单独记录自己的绑定，scope 结束时逐个弹出，不需要遍历整个表。结束的 scope 一定是最内层的，
+/// 其绑定都在各自栈的最上面。
+class ScopedSymbolTable {
+ public:
+  using ScopeId = uint32_t;
+
+  enum class Kind {
+    VAR_DECL,
+    DECL_STMT,
+    LOOP_VAR,
+    COUNT
+  };
+
+  struct Binding {
+    ScopeId scope = 0;
+    Env* env = nullptr;
+    clang::Stmt* value = nullptr;
+  };
+
+  ScopedSymbolTable() = default;
+  ScopedSymbolTable(const ScopedSymbolTable&) = delete;
+  ScopedSymbolTable& operator=(const ScopedSymbolTable&) = delete;
+
+  /// 创建新的 scope, 返回其 id。
+  ScopeId push_scope();
+
+  /// 删除 scope 中的所有绑定，必须是最内层的 scope。
+  void pop_scope(ScopeId scope);
+
+  /// 在 scope 中添加绑定，scope 可以是任意一个还存在的 scope。同一个 scope 中已有同名绑定时，is_multi 为
+  /// false 则覆盖，否则再添加一个。
+  void bind(ScopeId scope, Kind kind, const std::string& name, Env* env, clang::Stmt* value, bool is_multi = false);
+
+  /// 删除 scope 中最后添加的同名绑定。
+  void unbind(ScopeId scope, Kind kind, const std::string& name);
+
+  /// 从 scope 开始向外查找，找不到返回 nullptr。
+  const Binding* lookup(ScopeId scope, Kind kind, const std::string& name) const;
+
+ private:
+  struct Trail {
+    Kind kind;
+    Symbol symbol;
+  };
+
+  /// 一个还存在的 scope 中按添加顺序记录的绑定。
+  struct ScopeTrail {
+    ScopeId scope = 0;
+    std::vector<Trail> trail;
+  };
+
+  std::vector<Binding>* find_stack(Kind kind, const std::string& name);
+  const std::vector<Binding>* find_stack(Kind kind, const std::string& name) const;
+
+ private:
+  ScopeId next_scope_ = 0;
+
+  std::unordered_map<Symbol, std::vector<Binding>> stacks_[static_cast<size_t>(Kind::COUNT)];
+
+  /// 所有还存在的 scope, 按 scope id 有序。
+  std::vector<ScopeTrail> scopes_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,131 @@
+#include <glog/logging.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include "Symbol.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+namespace {
+
+/// 字符串按 id 分块保存，块一旦分配就不再移动，`str()` 不需要加锁。
+constexpr uint32_t kChunkBits = 12;
+constexpr uint32_t kChunkSize = 1u << kChunkBits;
+constexpr uint32_t kMaxChunks = 1u << 14;
+
+class SymbolPool {
+ public:
+  static SymbolPool& instance() {
+    static SymbolPool pool;
+    return pool;
+  }
+
+  uint32_t intern(const std::string& s) {
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      auto it = ids_.find(std::string_view(s));
+      if (it != ids_.end()) {
+        return it->second;
+      }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(std::string_view(s));
+    if (it != ids_.end()) {
+      return it->second;
+    }
+
+    uint32_t id = size_;
+    uint32_t chunk_index = id >> kChunkBits;
+    if (chunk_index >= kMaxChunks) {
+      LOG(FATAL) << "too many symbols, size: " << size_;
+    }
+
+    std::string* chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      chunk = new std::string[kChunkSize];
+      chunks_[chunk_index].store(chunk, std::memory_order_release);
+    }
+
+    std::string& slot = chunk[id & (kChunkSize - 1)];
+    slot = s;
+    ids_.emplace(std::string_view(slot), id);
+    size_++;
+
+    return id;
+  }
+
+  absl::optional<uint32_t> find(const std::string& s) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(std::string_view(s));
+    if (it != ids_.end()) {
+      return absl::make_optional(it->second);
+    }
+
+    return absl::nullopt;
+  }
+
+  /// id 只能通过 intern 得到，得到 id 时对应的字符串已经写入。
+  const std::string& str(uint32_t id) const {
+    const std::string* chunk = chunks_[id >> kChunkBits].load(std::memory_order_acquire);
+    return chunk[id & (kChunkSize - 1)];
+  }
+
+ private:
+  SymbolPool() = default;
+
+ private:
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string_view, uint32_t> ids_;
+  uint32_t size_ = 0;
+  std::atomic<std::string*> chunks_[kMaxChunks] = {};
+};
+
+/// 每个线程缓存查找过的字符串，命中时不需要加锁。key 指向字符串池中的字符串，不额外保存一份。
+thread_local std::unordered_map<std::string_view, uint32_t> thread_ids;
+
+}  // namespace
+
+Symbol Symbol::intern(const std::string& s) {
+  auto it = thread_ids.find(std::string_view(s));
+  if (it != thread_ids.end()) {
+    return Symbol(it->second);
+  }
+
+  SymbolPool& pool = SymbolPool::instance();
+  uint32_t id = pool.intern(s);
+  thread_ids.emplace(std::string_view(pool.str(id)), id);
+
+  return Symbol(id);
+}
+
+absl::optional<Symbol> Symbol::find(const std::string& s) {
+  auto it = thread_ids.find(std::string_view(s));
+  if (it != thread_ids.end()) {
+    return absl::make_optional(Symbol(it->second));
+  }
+
+  SymbolPool& pool = SymbolPool::instance();
+  absl::optional<uint32_t> id = pool.find(s);
+  if (id) {
+    thread_ids.emplace(std::string_view(pool.str(*id)), *id);
+    return absl::make_optional(Symbol(*id));
+  }
+
+  return absl::nullopt;
+}
+
+const std::string& Symbol::str() const {
+  return SymbolPool::instance().str(id_);
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <absl/types/optional.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// 驻留的字符串，只保存一个 32 位的 id。
+///
+/// `bs_enum_str`、变量名等标识符会在很多 `map`、`set` 中重复保存并作为 key 比较。相同的字符串在进程内
+/// 的全局字符串池中只保存一份，`Symbol` 之间的比较和 hash 都是整数操作。
+///
+/// 字符串池只增不减，多线程安全。`id` 只在当前进程内有效，不能用于输出或者持久化，也不能用于需要按字符串
+/// 排序的地方。
+///
+/// 示例:
+/// ```cpp
+/// Symbol a = Symbol::intern("adlog_user_info_id");
+/// absl::optional<Symbol> b = Symbol::find("adlog_user_info_id");
+/// assert(b && *b == a && a.str() == "adlog_user_info_id");
+/// ```
+class Symbol {
+ public:
+  /// 返回字符串对应的 `Symbol`, 不存在则添加到字符串池中。
+  static Symbol intern(const std::string& s);
+
+  /// 只查找，不添加。字符串池中不存在时说明该字符串没有在任何地方被驻留过。
+  static absl::optional<Symbol> find(const std::string& s);
+
+  uint32_t id() const { return id_; }
+
+  /// 对应的字符串，引用在进程内一直有效。
+  const std::string& str() const;
+
+  bool operator==(const Symbol& other) const { return id_ == other.id_; }
+  bool operator!=(const Symbol& other) const { return id_ != other.id_; }
+
+ private:
+  explicit Symbol(uint32_t id): id_(id) {}
+
+ private:
+  uint32_t id_ = 0;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
+
+namespace std {
+
+template<>
+struct hash<ks::ad_algorithm::convert::Symbol> {
+  size_t operator()(const ks::ad_algorithm::convert::Symbol& symbol) const {
+    return std::hash<uint32_t>()(symbol.id());
+  }
+};
+
+}  // namespace std
@@ -0,0 +1,625 @@
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cctype>
+
+#include "TextReplacer.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+namespace tool {
+
+namespace {
+
+std::bitset<256> char_set(unsigned char c) {
+  std::bitset<256> res;
+  res.set(c);
+  return res;
+}
+
+std::bitset<256> class_set(int (*pred)(int)) {
+  std::bitset<256> res;
+  for (int c = 0; c < 256; c++) {
+    if (pred(c)) {
+      res.set(c);
+    }
+  }
+  return res;
+}
+
+int is_digit(int c) {
+  return std::isdigit(c);
+}
+
+int is_word(int c) {
+  return std::isalnum(c) || c == '_';
+}
+
+int is_space(int c) {
+  return std::isspace(c);
+}
+
+/// `\d` 等转义对应的字符集，普通转义返回字符本身。
+std::bitset<256> escape_set(char c) {
+  switch (c) {
+    case 'd':
+      return class_set(is_digit);
+    case 'D':
+      return ~class_set(is_digit);
+    case 'w':
+      return class_set(is_word);
+    case 'W':
+      return ~class_set(is_word);
+    case 's':
+      return class_set(is_space);
+    case 'S':
+      return ~class_set(is_space);
+    case 'n':
+      return char_set('\n');
+    case 'r':
+      return char_set('\r');
+    case 't':
+      return char_set('\t');
+    case 'f':
+      return char_set('\f');
+    case 'v':
+      return char_set('\v');
+    default:
+      return char_set(c);
+  }
+}
+
+size_t first_char(const std::bitset<256>& chars) {
+  for (size_t c = 0; c < chars.size(); c++) {
+    if (chars.test(c)) {
+      return c;
+    }
+  }
+
+  return 0;
+}
+
+}  // namespace
+
+/// 把规则解析成 Node。
+class TextReplacer::Parser {
+ public:
+  explicit Parser(const std::string& pattern): pattern_(pattern) {}
+
+  Node parse(int* group_count) {
+    Node root;
+    root.type = NodeType::GROUP;
+    root.alternatives = parse_alternatives();
+    if (pos_ < pattern_.size()) {
+      LOG(FATAL) << "unmatched ')', pattern: " << pattern_;
+    }
+
+    *group_count = group_count_;
+    return root;
+  }
+
+ private:
+  std::vector<Sequence> parse_alternatives() {
+    std::vector<Sequence> res;
+    res.emplace_back(parse_sequence());
+    while (pos_ < pattern_.size() && pattern_[pos_] == '|') {
+      pos_++;
+      res.emplace_back(parse_sequence());
+    }
+
+    return res;
+  }
+
+  Sequence parse_sequence() {
+    Sequence res;
+    while (pos_ < pattern_.size() && pattern_[pos_] != '|' && pattern_[pos_] != ')') {
+      res.emplace_back(parse_atom());
+      parse_quantifier(&res.back());
+    }
+
+    return res;
+  }
+
+  Node parse_atom() {
+    Node node;
+    char c = pattern_[pos_++];
+    switch (c) {
+      case '(': {
+        node.type = NodeType::GROUP;
+        if (pattern_.compare(pos_, 2, "?:") == 0) {
+          pos_ += 2;
+        } else if (pos_ < pattern_.size() && pattern_[pos_] == '?') {
+          LOG(FATAL) << "only (?: is supported, pattern: " << pattern_;
+        } else {
+          node.group = ++group_count_;
+        }
+
+        node.alternatives = parse_alternatives();
+        if (pos_ >= pattern_.size() || pattern_[pos_] != ')') {
+          LOG(FATAL) << "unmatched '(', pattern: " << pattern_;
+        }
+        pos_++;
+        break;
+      }
+      case '^':
+        node.type = NodeType::BEGIN;
+        break;
+      case '$':
+        node.type = NodeType::END;
+        break;
+      case '.':
+        node.chars.set();
+        node.chars.reset('\n');
+        node.chars.reset('\r');
+        break;
+      case '[':
+        node.chars = parse_bracket();
+        break;
+      case '\\':
+        if (pos_ >= pattern_.size()) {
+          LOG(FATAL) << "pattern ends with '\\', pattern: " << pattern_;
+        }
+        if (pattern_[pos_] == 'b' || pattern_[pos_] == 'B' || std::isdigit(pattern_[pos_])) {
+          LOG(FATAL) << "word boundary and back reference are not supported, pattern: " << pattern_;
+        }
+        node.chars = escape_set(pattern_[pos_++]);
+        break;
+      case '?':
+      case '*':
+      case '+':
+        LOG(FATAL) << "nothing to repeat, pattern: " << pattern_;
+        break;
+      default:
+        node.chars = char_set(c);
+        break;
+    }
+
+    return node;
+  }
+
+  std::bitset<256> parse_bracket() {
+    std::bitset<256> res;
+    bool is_negative = pos_ < pattern_.size() && pattern_[pos_] == '^';
+    if (is_negative) {
+      pos_++;
+    }
+
+    bool is_first = true;
+    while (pos_ < pattern_.size() && (pattern_[pos_] != ']' || is_first)) {
+      is_first = false;
+
+      // 转义的字符集不能作为范围的端点。
+      if (pattern_[pos_] == '\\' && pos_ + 1 < pattern_.size()) {
+        char c = pattern_[pos_ + 1];
+        pos_ += 2;
+        if (std::string("dDwWsS").find(c) != std::string::npos) {
+          res |= escape_set(c);
+          continue;
+        }
+
+        add_bracket_range(first_char(escape_set(c)), &res);
+        continue;
+      }
+
+      add_bracket_range(static_cast<unsigned char>(pattern_[pos_++]), &res);
+    }
+
+    if (pos_ >= pattern_.size()) {
+      LOG(FATAL) << "unmatched '[', pattern: " << pattern_;
+    }
+    pos_++;
+
+    if (is_negative) {
+      res.flip();
+    }
+
+    return res;
+  }
+
+  /// 已经读了范围的开始 first, 如果后面是 `-x` 则是一个范围。
+  void add_bracket_range(size_t first, std::bitset<256>* res) {
+    if (pos_ + 1 < pattern_.size() && pattern_[pos_] == '-' && pattern_[pos_ + 1] != ']') {
+      pos_++;
+      size_t last = 0;
+      if (pattern_[pos_] == '\\' && pos_ + 1 < pattern_.size()) {
+        last = first_char(escape_set(pattern_[pos_ + 1]));
+        pos_ += 2;
+      } else {
+        last = static_cast<unsigned char>(pattern_[pos_++]);
+      }
+
+      if (last < first) {
+        LOG(FATAL) << "invalid range in '[', pattern: " << pattern_;
+      }
+      for (size_t c = first; c <= last; c++) {
+        res->set(c);
+      }
+    } else {
+      res->set(first);
+    }
+  }
+
+  void parse_quantifier(Node* node) {
+    if (pos_ >= pattern_.size()) {
+      return;
+    }
+
+    char c = pattern_[pos_];
+    if (c == '?') {
+      node->min = 0;
+      node->max = 1;
+    } else if (c == '*') {
+      node->min = 0;
+      node->max = -1;
+    } else if (c == '+') {
+      node->min = 1;
+      node->max = -1;
+    } else if (c == '{') {
+      size_t end = pattern_.find('}', pos_);
+      if (end == std::string::npos) {
+        LOG(FATAL) << "unmatched '{', pattern: " << pattern_;
+      }
+
+      std::string range = pattern_.substr(pos_ + 1, end - pos_ - 1);
+      size_t comma = range.find(',');
+      node->min = std::stoi(range.substr(0, comma));
+      if (comma == std::string::npos) {
+        node->max = node->min;
+      } else if (comma + 1 == range.size()) {
+        node->max = -1;
+      } else {
+        node->max = std::stoi(range.substr(comma + 1));
+      }
+      pos_ = end;
+    } else {
+      return;
+    }
+    pos_++;
+
+    if (node->type == NodeType::BEGIN || node->type == NodeType::END) {
+      LOG(FATAL) << "anchor cannot be repeated, pattern: " << pattern_;
+    }
+
+    if (pos_ < pattern_.size() && pattern_[pos_] == '?') {
+      node->is_lazy = true;
+      pos_++;
+    }
+  }
+
+ private:
+  const std::string& pattern_;
+  size_t pos_ = 0;
+  int group_count_ = 0;
+};
+
+/// 回溯匹配，尝试的顺序与 ECMAScript 相同。
+///
+/// 每个函数匹配一部分之后调用 Cont 匹配剩下的部分，返回整个匹配结束的位置，失败返回 npos。
+class TextReplacer::Matcher {
+ public:
+  Matcher(const std::string& s, std::vector<std::pair<size_t, size_t>>* groups): s_(s), groups_(groups) {}
+
+  class Cont {
+   public:
+    virtual size_t run(size_t pos) const = 0;
+  };
+
+  /// 整个规则匹配完。
+  class Done: public Cont {
+   public:
+    size_t run(size_t pos) const override { return pos; }
+  };
+
+  size_t match_group(const Node& node, int count, size_t pos, const Cont& cont) const {
+    bool can_repeat = node.max < 0 || count < node.max;
+    bool can_stop = count >= node.min;
+
+    if (node.is_lazy && can_stop) {
+      size_t end = cont.run(pos);
+      if (end != std::string::npos) {
+        return end;
+      }
+    }
+
+    if (can_repeat) {
+      for (const Sequence& seq : node.alternatives) {
+        IterationEnd iteration_end(this, node, count, pos, cont);
+        size_t end = match_sequence(seq, 0, pos, iteration_end);
+        if (end != std::string::npos) {
+          return end;
+        }
+      }
+    }
+
+    if (!node.is_lazy && can_stop) {
+      return cont.run(pos);
+    }
+
+    return std::string::npos;
+  }
+
+ private:
+  /// 分组的一次重复匹配完，记录分组的位置，然后继续重复或者匹配后面的部分。
+  class IterationEnd: public Cont {
+   public:
+    IterationEnd(const Matcher* matcher, const Node& node, int count, size_t begin, const Cont& cont):
+      matcher_(matcher), node_(node), count_(count), begin_(begin), cont_(cont) {}
+
+    size_t run(size_t pos) const override {
+      // 与 ECMAScript 相同，满足最少次数之后不再接受空的重复，避免死循环。
+      if (pos == begin_ && count_ >= node_.min) {
+        return std::string::npos;
+      }
+
+      auto& group = (*matcher_->groups_)[node_.group];
+      auto old = group;
+      group = {begin_, pos};
+
+      size_t end = matcher_->match_group(node_, count_ + 1, pos, cont_);
+      if (end == std::string::npos) {
+        group = old;
+      }
+
+      return end;
+    }
+
+   private:
+    const Matcher* matcher_;
+    const Node& node_;
+    int count_;
+    size_t begin_;
+    const Cont& cont_;
+  };
+
+  /// 序列中后面的部分。
+  class SequenceRest: public Cont {
+   public:
+    SequenceRest(const Matcher* matcher, const Sequence& seq, size_t index, const Cont& cont):
+      matcher_(matcher), seq_(seq), index_(index), cont_(cont) {}
+
+    size_t run(size_t pos) const override {
+      return matcher_->match_sequence(seq_, index_, pos, cont_);
+    }
+
+   private:
+    const Matcher* matcher_;
+    const Sequence& seq_;
+    size_t index_;
+    const Cont& cont_;
+  };
+
+  size_t match_sequence(const Sequence& seq, size_t index, size_t pos, const Cont& cont) const {
+    if (index == seq.size()) {
+      return cont.run(pos);
+    }
+
+    const Node& node = seq[index];
+    switch (node.type) {
+      case NodeType::BEGIN:
+        return pos == 0 ? match_sequence(seq, index + 1, pos, cont) : std::string::npos;
+      case NodeType::END:
+        return pos == s_.size() ? match_sequence(seq, index + 1, pos, cont) : std::string::npos;
+      case NodeType::GROUP: {
+        SequenceRest rest(this, seq, index + 1, cont);
+        return match_group(node, 0, pos, rest);
+      }
+      case NodeType::CHARS:
+        break;
+    }
+
+    // 字符集的重复不会为空，直接计算最多能匹配的个数。
+    size_t max_count = 0;
+    size_t limit = node.max < 0 ? s_.size() - pos : static_cast<size_t>(node.max);
+    while (max_count < limit &&
+           pos + max_count < s_.size() &&
+           node.chars.test(static_cast<unsigned char>(s_[pos + max_count]))) {
+      max_count++;
+    }
+
+    size_t min_count = static_cast<size_t>(node.min);
+    if (max_count < min_count) {
+      return std::string::npos;
+    }
+
+    if (node.is_lazy) {
+      for (size_t count = min_count; count <= max_count; count++) {
+        size_t end = match_sequence(seq, index + 1, pos + count, cont);
+        if (end != std::string::npos) {
+          return end;
+        }
+      }
+    } else {
+      for (size_t count = max_count + 1; count-- > min_count;) {
+        size_t end = match_sequence(seq, index + 1, pos + count, cont);
+        if (end != std::string::npos) {
+          return end;
+        }
+      }
+    }
+
+    return std::string::npos;
+  }
+
+ private:
+  const std::string& s_;
+  std::vector<std::pair<size_t, size_t>>* groups_;
+};
+
+TextReplacer::TextReplacer(std::initializer_list<std::pair<std::string, std::string>> rules) {
+  for (const auto& pattern_and_replacement : rules) {
+    const std::string& pattern = pattern_and_replacement.first;
+    size_t index = rules_.size();
+
+    Rule rule;
+    rule.root = Parser(pattern).parse(&rule.group_count);
+    rule.replacement = pattern_and_replacement.second;
+
+    size_t min_len = static_cast<size_t>(-1);
+    std::bitset<256> first_chars;
+    for (const Sequence& seq : rule.root.alternatives) {
+      min_len = std::min(min_len, min_length(seq));
+      add_first_chars(seq, &first_chars);
+    }
+
+    if (min_len == 0) {
+      LOG(FATAL) << "pattern must not match empty string, pattern: " << pattern;
+    }
+
+    rules_.emplace_back(std::move(rule));
+    for (int c = 0; c < 256; c++) {
+      if (first_chars.test(c)) {
+        buckets_[c].push_back(index);
+      }
+    }
+  }
+}
+
+void TextReplacer::add_first_chars(const Sequence& seq, std::bitset<256>* first_chars) {
+  // 之前的节点都可以为空时，当前节点的第一个字符也可能是整个序列的第一个字符。
+  for (const Node& node : seq) {
+    if (node.type == NodeType::CHARS) {
+      *first_chars |= node.chars;
+    } else if (node.type == NodeType::GROUP) {
+      for (const Sequence& alternative : node.alternatives) {
+        add_first_chars(alternative, first_chars);
+      }
+    }
+
+    if (node.type == NodeType::BEGIN || node.type == NodeType::END) {
+      continue;
+    }
+
+    bool is_nullable = node.min == 0;
+    if (node.type == NodeType::GROUP) {
+      for (const Sequence& alternative : node.alternatives) {
+        is_nullable |= min_length(alternative) == 0;
+      }
+    }
+
+    if (!is_nullable) {
+      break;
+    }
+  }
+}
+
+size_t TextReplacer::min_length(const Sequence& seq) {
+  size_t res = 0;
+  for (const Node& node : seq) {
+    if (node.type == NodeType::CHARS) {
+      res += node.min;
+    } else if (node.type == NodeType::GROUP) {
+      size_t min_len = static_cast<size_t>(-1);
+      for (const Sequence& alternative : node.alternatives) {
+        min_len = std::min(min_len, min_length(alternative));
+      }
+      res += min_len * node.min;
+    }
+  }
+
+  return res;
+}
+
+void TextReplacer::append_replacement(const std::string& fmt,
+                                      const std::string& s,
+                                      size_t prefix_begin,
+                                      const std::vector<std::pair<size_t, size_t>>& groups,
+                                      std::string* out) const {
+  // 与 std::regex_replace 的 format_default 相同，`$` 后面最多读两位数字，编号不存在的分组输出为空。
+  auto append_group = [&s, &groups, out](size_t group) {
+    if (group < groups.size() && groups[group].first != std::string::npos) {
+      out->append(s, groups[group].first, groups[group].second - groups[group].first);
+    }
+  };
+
+  for (size_t i = 0; i < fmt.size(); i++) {
+    if (fmt[i] != '$' || i + 1 == fmt.size()) {
+      out->push_back(fmt[i]);
+      continue;
+    }
+
+    char c = fmt[i + 1];
+    if (c == '$') {
+      out->push_back('$');
+      i++;
+    } else if (c == '&') {
+      append_group(0);
+      i++;
+    } else if (c == '`') {
+      out->append(s, prefix_begin, groups[0].first - prefix_begin);
+      i++;
+    } else if (c == '\'') {
+      out->append(s, groups[0].second, std::string::npos);
+      i++;
+    } else if (std::isdigit(c)) {
+      size_t group = c - '0';
+      i++;
+      if (i + 1 < fmt.size() && std::isdigit(fmt[i + 1])) {
+        group = group * 10 + (fmt[i + 1] - '0');
+        i++;
+      }
+      append_group(group);
+    } else {
+      out->push_back('$');
+    }
+  }
+}
+
+std::string TextReplacer::replace(const std::string& s) const {
+  return replace_impl(s, nullptr, false);
+}
+
+std::string TextReplacer::replace(const std::string& s, const std::string& fmt) const {
+  return replace_impl(s, &fmt, false);
+}
+
+std::string TextReplacer::replace_first(const std::string& s, const std::string& fmt) const {
+  return replace_impl(s, &fmt, true);
+}
+
+std::string TextReplacer::replace_impl(const std::string& s, const std::string* fmt, bool is_first_only) const {
+  std::string res;
+  res.reserve(s.size());
+
+  std::vector<std::pair<size_t, size_t>> groups;
+
+  // 上一次替换结束的位置，`$\`` 输出的是从这里到匹配开始的内容。
+  size_t prefix_begin = 0;
+  size_t pos = 0;
+  while (pos < s.size()) {
+    bool is_replaced = false;
+    for (size_t rule_index : buckets_[static_cast<unsigned char>(s[pos])]) {
+      const Rule& rule = rules_[rule_index];
+      groups.assign(rule.group_count + 1, {std::string::npos, std::string::npos});
+
+      Matcher matcher(s, &groups);
+      Matcher::Done done;
+      size_t end = matcher.match_group(rule.root, 0, pos, done);
+      if (end != std::string::npos) {
+        groups[0] = {pos, end};
+        append_replacement(fmt == nullptr ? rule.replacement : *fmt, s, prefix_begin, groups, &res);
+        pos = end;
+        prefix_begin = end;
+        is_replaced = true;
+        break;
+      }
+    }
+
+    if (is_replaced && is_first_only) {
+      res.append(s, pos, std::string::npos);
+      break;
+    }
+
+    if (!is_replaced) {
+      res.push_back(s[pos]);
+      pos++;
+    }
+  }
+
+  return res;
+}
+
+}  // namespace tool
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
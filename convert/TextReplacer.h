@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+namespace tool {
+
+/// 编译好的多模式文本替换。
+///
+/// 改写生成代码时需要对整个文件做很多次 `std::regex_replace`, 每次都要完整扫描一遍，并且 `std::regex`
+/// 本身也很慢。`TextReplacer` 在构造时编译所有规则，`replace` 只从左到右扫描一遍: 在每个位置按规则的
+/// 顺序尝试匹配，第一个匹配上的规则生效，输出替换结果后从匹配结束的位置继续。规则按第一个字符分桶，
+/// 大部分位置不需要尝试任何规则。
+///
+/// 规则是 ECMAScript 正则的一个子集，匹配的优先级与 `std::regex` 相同:
+/// - 普通字符，`\` 转义，`.` 匹配除 `\n`、`\r` 外的任意字符，`\d`、`\w`、`\s`、`\D`、`\W`、`\S` 以及
+///   `[...]`、`[^...]` 字符集。
+/// - 分组 `(...)`、`(?:...)` 以及 `|`, 分组可以嵌套。
+/// - 任意字符、字符集或者分组之后的 `?`、`*`、`+`、`{n}`、`{n,}`、`{n,m}`, 后面再加 `?` 表示非贪婪。
+/// - `^` 和 `$` 只匹配整个字符串的开头和结尾。
+///
+/// 替换的格式与 `std::regex_replace` 相同，支持 `$n`、`$nn`、`$&`、`` $` ``、`$'`、`$$`。不能匹配空字符串，
+/// 规则不合法时直接退出。
+///
+/// 只有一条规则时结果与 `std::regex_replace` 完全一致。多条规则时替换的结果不会再被扫描，因此只有在
+/// 规则之间互不影响时才等价于依次替换: 前一条规则的结果不能拼出后一条规则能匹配的内容，不同规则的匹配
+/// 也不能重叠。不满足时需要单独写一条组合后的规则并放在前面，或者拆成多个 `TextReplacer` 依次替换。
+///
+/// 替换的内容每次不同时，可以在替换时再传入替换的格式。
+///
+/// 示例:
+/// ```cpp
+/// static const TextReplacer replacer({{"FastFeature", "BSFastFeature"}, {"(adlog|ad_log)\\.", "bslog."}});
+/// std::string s = replacer.replace(content);
+///
+/// static const TextReplacer replacer_name({{"(\\w+)_key_(\\w+)", ""}});
+/// std::string name = replacer_name.replace(s, prefix + "$2");
+/// ```
+class TextReplacer {
+ public:
+  explicit TextReplacer(std::initializer_list<std::pair<std::string, std::string>> rules);
+
+  /// 使用每条规则自己的替换格式。
+  std::string replace(const std::string& s) const;
+
+  /// 所有规则都使用 fmt 替换。
+  std::string replace(const std::string& s, const std::string& fmt) const;
+
+  /// 只替换第一个匹配，同 `std::regex_constants::format_first_only`。
+  std::string replace_first(const std::string& s, const std::string& fmt) const;
+
+ private:
+  enum class NodeType {
+    CHARS,
+    GROUP,
+    BEGIN,
+    END
+  };
+
+  struct Node;
+  using Sequence = std::vector<Node>;
+
+  struct Node {
+    NodeType type = NodeType::CHARS;
+    std::bitset<256> chars;
+
+    /// 分组的编号，0 表示不捕获。
+    int group = 0;
+    std::vector<Sequence> alternatives;
+
+    /// 重复次数，max 为 -1 表示不限。
+    int min = 1;
+    int max = 1;
+    bool is_lazy = false;
+  };
+
+  struct Rule {
+    /// 整个规则是编号为 0 的分组。
+    Node root;
+    std::string replacement;
+    int group_count = 0;
+  };
+
+  class Parser;
+  class Matcher;
+
+  static void add_first_chars(const Sequence& seq, std::bitset<256>* first_chars);
+  static size_t min_length(const Sequence& seq);
+
+  std::string replace_impl(const std::string& s, const std::string* fmt, bool is_first_only) const;
+
+  void append_replacement(const std::string& fmt,
+                          const std::string& s,
+                          size_t prefix_begin,
+                          const std::vector<std::pair<size_t, size_t>>& groups,
+                          std::string* out) const;
+
+ private:
+  std::vector<Rule> rules_;
+
+  /// 每个字符对应的可能匹配的规则下标，已按规则顺序排序。
+  std::array<std::vector<size_t>, 256> buckets_;
+};
+
+}  // namespace tool
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
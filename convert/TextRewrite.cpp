@@ -0,0 +1,97 @@
+#include <absl/strings/str_replace.h>
+
+#include <string>
+
+#include "TextReplacer.h"
+#include "TextRewrite.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+namespace tool {
+
+std::string replace_feature_text(const std::string& content, const std::string& class_name) {
+  // 原来依次替换的顺序是: class 名, `class (Extract.*) ?: ?public`, `\n *;`, `: *;`, 其余的规则，
+  // 最后是 `ExtractMultiAttrBSFastFeatureNoPrefix`。
+  //
+  // `\n *;` 删除之后可能拼出 `: *;`, 如 `:\n ;;`, 因此 `: *;` 及之后的规则单独扫描一遍。后面的规则中，
+  // 一条规则的结果被之后的规则再次匹配的情况写成了组合后的规则，并放在前面:
+  // - `REGISTER_EXTRACTOR` 之后会再匹配 `EXTRACTOR\(Extract`。
+  // - `FastFeature` 之后会再匹配 `ExtractMultiAttrBSFastFeatureNoPrefix`, 前面还可能有 `using `、
+  //   `EXTRACTOR(` 等。
+  static const TextReplacer replacer_class({
+      {"class (Extract.*) ?: ?public", "class BS$1: public"},
+      {"\n *;", ""}});
+
+  static const TextReplacer replacer({
+      {": *;", ";"},
+      {"const AdLog ?\\& ?(adlog|ad_log)", "const BSLog& bslog"},
+      {"REGISTER_EXTRACTOR\\(ExtractMultiAttrFastFeatureNoPrefix",
+       "REGISTER_BS_EXTRACTOR(BSBSExtractMultiAttrFastFeatureNoPrefix"},
+      {"REGISTER_EXTRACTOR\\(Extract", "REGISTER_BS_EXTRACTOR(BSExtract"},
+      {"REGISTER_EXTRACTOR", "REGISTER_BS_EXTRACTOR"},
+      {"REGISTER_SEQUENCE_EXTRACTOR\\(ExtractMultiAttrFastFeatureNoPrefix",
+       "REGISTER_BS_SEQUENCE_EXTRACTOR(BSBSExtractMultiAttrFastFeatureNoPrefix"},
+      {"REGISTER_SEQUENCE_EXTRACTOR\\(Extract", "REGISTER_BS_SEQUENCE_EXTRACTOR(BSExtract"},
+      {"REGISTER_SEQUENCE_EXTRACTOR", "REGISTER_BS_SEQUENCE_EXTRACTOR"},
+      {"using ExtractMultiAttrFastFeatureNoPrefix", "using BSBSExtractMultiAttrFastFeatureNoPrefix"},
+      {"using Extract", "using BSExtract"},
+      {"EXTRACTOR\\(ExtractMultiAttrFastFeatureNoPrefix", "EXTRACTOR(BSBSExtractMultiAttrFastFeatureNoPrefix"},
+      {"EXTRACTOR\\(Extract", "EXTRACTOR(BSExtract"},
+      {"ExtractMultiAttrFastFeatureNoPrefix", "BSExtractMultiAttrFastFeatureNoPrefix"},
+      {"FastFeature", "BSFastFeature"},
+      {"(::)?auto_cpp_rewriter::AdCallbackLog", "::bs::auto_cpp_rewriter::AdCallbackLog"},
+      {"(::)?auto_cpp_rewriter::CommonInfoAttr", "::bs::auto_cpp_rewriter::CommonInfoAttr"},
+      {"template ?<ItemType", "template<bs::ItemType"}});
+
+  // 类名每次都不一样，单独替换。
+  std::string s = absl::StrReplaceAll(content, {{class_name, std::string("BS") + class_name}});
+  s = replacer_class.replace(s);
+  s = replacer.replace(s);
+
+  return fix_std_string(s);
+}
+
+std::string replace_infer_filter_text(const std::string& content) {
+  static const TextReplacer replacer({
+      {"ItemFilter", "BSItemFilter"},
+      {"BSFieldEnum::item", "BSFieldEnum::adlog_item"},
+      {"\\(\\*bs", "(bs"},
+      {"static inline bool", "static bool"}});
+
+  return replacer.replace(content);
+}
+
+std::string fix_std_string(const std::string& s) {
+  if (s.find("include<") != std::string::npos ||
+      s.find("include <") != std::string::npos ||
+      s.find("std::string") != std::string::npos) {
+    return s;
+  }
+
+  static const TextReplacer replacer({{"([ <]?)string([ >,])", "$1std::string$2"}});
+  return replacer.replace(s);
+}
+
+std::string rm_continue_break(const std::string& s) {
+  // 删除 `continue;` 之后可能拼出 `break;`, 如 `breacontinue;k;`, 因此分两遍。
+  static const TextReplacer replacer_continue({{"continue ?;", ""}});
+  static const TextReplacer replacer_break({{"break ?;", ""}});
+
+  return replacer_break.replace(replacer_continue.replace(s));
+}
+
+std::string rm_empty_line(const std::string& s) {
+  static const TextReplacer replacer({{"\n *;", ""}});
+  return replacer.replace(s);
+}
+
+std::string replace_simple_text(const std::string &s) {
+  static const TextReplacer replacer({{"_Bool", "bool"}, {"\n *;", ""}});
+  return replacer.replace(s);
+}
+
+}  // namespace tool
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+namespace tool {
+
+/// 对生成代码的纯文本替换，不依赖 `clang`。
+///
+/// 这些替换原来都是依次调用的 `std::regex_replace`, 现在用 `TextReplacer` 实现，结果与原来逐字节相同，
+/// test/TextRewriteTest.cpp 中与原来的 `std::regex_replace` 做了对比。
+
+/// 特征类头文件中的固定替换，见 `ConvertAction::replace_simple`。
+std::string replace_feature_text(const std::string& content, const std::string& class_name);
+
+/// `filter` 类中的固定替换，见 `ConvertAction::replace_simple_infer_filter`。
+std::string replace_infer_filter_text(const std::string& content);
+
+std::string fix_std_string(const std::string& s);
+
+std::string rm_continue_break(const std::string& s);
+
+std::string rm_empty_line(const std::string& s);
+
+std::string replace_simple_text(const std::string &s);
+
+}  // namespace tool
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
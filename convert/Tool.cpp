@@ -6,14 +6,21 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 
 #include "clang/AST/ExprCXX.h"
+#include "clang/Format/Format.h"
+#include "clang/Tooling/Core/Replacement.h"
+#include "llvm/Support/Error.h"
 
 #include "Env.h"
 #include "Tool.h"
+#include "TextReplacer.h"
+#include "TypeCategory.h"
 #include "info/CommonInfo.h"
 
 namespace ks {
@@ -38,6 +45,22 @@ clang::SourceRange find_source_range(clang::Stmt* stmt) {
   return clang::SourceRange(stmt->getBeginLoc(), stmt->getEndLoc());
 }
 
+namespace {
+
+struct StmtStringKeyHash {
+  size_t operator()(const std::pair<const clang::Stmt*, unsigned>& key) const {
+    return std::hash<const clang::Stmt*>()(key.first) ^ key.second;
+  }
+};
+
+/// 当前源文件中已经打印过的 stmt, 每个 AST 节点只打印一次。
+///
+/// 不同源文件的 AST 节点地址可能重复，因此每个源文件开始处理时需要清空。
+thread_local std::unordered_map<std::pair<const clang::Stmt*, unsigned>, std::string, StmtStringKeyHash>
+  stmt_string_cache;
+
+}  // namespace
+
 std::string stmt_to_string(clang::Stmt* stmt, unsigned suppressTagKeyword) {
   if (stmt == nullptr) {
     return "";
@@ -48,13 +71,28 @@ std::string stmt_to_string(clang::Stmt* stmt, unsigned suppressTagKeyword) {
     return "nullptr";
   }
 
-  clang::LangOptions lo;
+  auto key = std::make_pair(static_cast<const clang::Stmt*>(stmt), suppressTagKeyword);
+  auto it = stmt_string_cache.find(key);
+  if (it != stmt_string_cache.end()) {
+    return it->second;
+  }
+
+  // LangOptions 和 PrintingPolicy 只和 suppressTagKeyword 有关，不需要每次都构造。
+  static const clang::LangOptions lo;
+  static const clang::PrintingPolicy default_policy(lo);
+  clang::PrintingPolicy printPolicy(default_policy);
+  printPolicy.SuppressTagKeyword = suppressTagKeyword;
+
   std::string out_str;
   llvm::raw_string_ostream outstream(out_str);
-  clang::PrintingPolicy printPolicy(lo);
-  printPolicy.SuppressTagKeyword = suppressTagKeyword;
   stmt->printPretty(outstream, nullptr, printPolicy);
-  return out_str;
+  outstream.flush();
+
+  return stmt_string_cache.emplace(key, std::move(out_str)).first->second;
+}
+
+void clear_stmt_string_cache() {
+  stmt_string_cache.clear();
 }
 
 clang::Expr* get_first_caller(clang::Expr* initExpr, const Env* env_ptr) {
@@ -332,12 +370,12 @@ json replace_enum(const json& d, const std::map<std::string, int>& enum_map) {
   return res;
 }
 
-bool is_basic_type(clang::QualType qual_type) {
+static bool is_basic_type_uncached(clang::QualType qual_type) {
   if (tool::is_ad_enum(qual_type)) {
     return true;
   }
 
-  std::string type_name = qual_type.getAsString();
+  std::string type_name = TypeCategoryCache::type_str(qual_type);
   if (type_name.find("algorithm") != std::string::npos) {
     return false;
   }
@@ -354,6 +392,10 @@ bool is_basic_type(clang::QualType qual_type) {
   return true;
 }
 
+bool is_basic_type(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::BASIC_TYPE, is_basic_type_uncached);
+}
+
 bool is_integer(const std::string & s){
   static const std::regex p(" ?[\\-\\+]?[0-9]+ ?");
   return std::regex_match(s, p);
@@ -544,13 +586,17 @@ bool is_middle_node_expr_root(clang::Expr* expr, const Env& env) {
   return is_middle_node_root(stmt_to_string(expr));
 }
 
-bool is_common_info_vector(clang::QualType qual_type) {
-  bool is_vector = qual_type.getAsString().find("std::vector") != std::string::npos;
+static bool is_common_info_vector_uncached(clang::QualType qual_type) {
+  bool is_vector = TypeCategoryCache::type_str(qual_type).find("std::vector") != std::string::npos;
   return is_common_info_enum(qual_type) && is_vector;
 }
 
-bool is_common_info_enum(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_common_info_vector(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::COMMON_INFO_VECTOR, is_common_info_vector_uncached);
+}
+
+static bool is_common_info_enum_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   if (type_str.find("auto_cpp_rewriter::") != std::string::npos &&
       type_str.find("CommonInfo") != std::string::npos &&
@@ -567,8 +613,12 @@ bool is_common_info_enum(clang::QualType qual_type) {
   return false;
 }
 
-bool is_common_info_struct(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_common_info_enum(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::COMMON_INFO_ENUM, is_common_info_enum_uncached);
+}
+
+static bool is_common_info_struct_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   if (type_str.find("auto_cpp_rewriter::") != std::string::npos &&
       type_str.find("CommonInfo") != std::string::npos &&
@@ -585,13 +635,21 @@ bool is_common_info_struct(clang::QualType qual_type) {
   return false;
 }
 
-bool is_repeated_common_info(clang::QualType qualType) {
-  std::string type_str = qualType.getAsString();
+bool is_common_info_struct(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::COMMON_INFO_STRUCT, is_common_info_struct_uncached);
+}
+
+static bool is_repeated_common_info_uncached(clang::QualType qualType) {
+  std::string type_str = TypeCategoryCache::type_str(qualType);
   bool is_repeated = (type_str.find("::RepeatedPtr") != std::string::npos);
   is_repeated &= (type_str.find("google::protobuf") != std::string::npos);
   return is_repeated && is_common_info_enum(qualType);
 }
 
+bool is_repeated_common_info(clang::QualType qualType) {
+  return TypeCategoryCache::get(qualType, TypeCategory::REPEATED_COMMON_INFO, is_repeated_common_info_uncached);
+}
+
 bool is_repeated_common_info_size(const std::string& method_name) {
   return CommonAttrInfo::is_repeated_common_info_size(method_name);
 }
@@ -641,7 +699,7 @@ bool is_reco_user_field(const std::string& s) {
 }
 
 bool is_item_type_enum(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   LOG(INFO) << "type_str: " << type_str;
   if (type_str.find("algorithm::ItemType") != std::string::npos) {
     return true;
@@ -650,8 +708,8 @@ bool is_item_type_enum(clang::QualType qual_type) {
   return false;
 }
 
-bool is_ad_callback_log_enum(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+static bool is_ad_callback_log_enum_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   if (type_str.find("auto_cpp_rewriter::AdCallbackLog") != std::string::npos) {
     return true;
   }
@@ -659,8 +717,12 @@ bool is_ad_callback_log_enum(clang::QualType qual_type) {
   return false;
 }
 
-bool is_ad_action_type_enum(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_ad_callback_log_enum(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::AD_CALLBACK_LOG_ENUM, is_ad_callback_log_enum_uncached);
+}
+
+static bool is_ad_action_type_enum_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   if (type_str.find("auto_cpp_rewriter::AdActionType") != std::string::npos) {
     return true;
   }
@@ -668,31 +730,47 @@ bool is_ad_action_type_enum(clang::QualType qual_type) {
   return false;
 }
 
-bool is_ad_enum(clang::QualType qual_type) {
+bool is_ad_action_type_enum(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::AD_ACTION_TYPE_ENUM, is_ad_action_type_enum_uncached);
+}
+
+static bool is_ad_enum_uncached(clang::QualType qual_type) {
   const clang::Type* type_ptr = qual_type.getTypePtr();
 
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   bool is_from_ad_proto = type_str.find("auto_cpp_rewriter::") != std::string::npos;
 
   return is_from_ad_proto && type_ptr->isEnumeralType();
 }
 
-bool is_basic_array(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_ad_enum(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::AD_ENUM, is_ad_enum_uncached);
+}
+
+static bool is_basic_array_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("(int|int64_t|uint64_t|float|double) \\[\\d+\\]");
   std::smatch sm;
   return std::regex_match(type_str, sm, p);
 }
 
-bool is_builtin_simple_type(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_basic_array(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::BASIC_ARRAY, is_basic_array_uncached);
+}
+
+static bool is_builtin_simple_type_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("(int|int64_t|uint32|uint64_t|float|double)");
   std::smatch sm;
   return std::regex_match(type_str, sm, p);
 }
 
+bool is_builtin_simple_type(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::BUILTIN_SIMPLE_TYPE, is_builtin_simple_type_uncached);
+}
+
 std::string get_bs_scalar_exists_expr(Env* env_ptr,
                                             const std::string& common_info_prefix,
                                             const std::string& value_type) {
@@ -719,9 +797,9 @@ bool is_int32_type(const std::string &type_str) {
 }
 
 std::string get_builtin_type_str(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
-  static std::regex p(" ?\\&$");
-  type_str = std::regex_replace(type_str, p, "");
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
+  static const TextReplacer replacer({{" ?\\&$", ""}});
+  type_str = replacer.replace(type_str);
 
   if (is_int32_type(type_str)) {
     return "int32_t";
@@ -757,25 +835,20 @@ std::string get_exists_name(const std::string& name) {
   return name + "_exists";
 }
 
-std::string fix_std_string(const std::string& s) {
-  if (s.find("include<") != std::string::npos ||
-      s.find("include <") != std::string::npos ||
-      s.find("std::string") != std::string::npos) {
-    return s;
-  }
-
-  static std::regex p_string("([ <]?)string([ >,])");
-  return std::regex_replace(s, p_string, "$1std::string$2");
-}
-
 std::string fix_string_view(const std::string& s) {
-  static std::regex p_string("std::string");
-  return std::regex_replace(s, p_string, "absl::string_view");
+  static const TextReplacer replacer({{"std::string", "absl::string_view"}});
+  return replacer.replace(s);
 }
 
 std::string get_bs_correspond_path(const std::string& filename) {
-  static std::regex p(".*teams/ad/ad_algorithm/feature/fast/impl/");
-  return std::regex_replace(filename, p, "teams/ad/ad_algorithm/bs_feature/fast/impl/bs_");
+  static const TextReplacer replacer({
+      {".*teams/ad/ad_algorithm/feature/fast/impl/", "teams/ad/ad_algorithm/bs_feature/fast/impl/bs_"}});
+  return replacer.replace(filename);
+}
+
+std::string get_cc_filename(const std::string& filename) {
+  static const TextReplacer replacer({{"\\.h", ".cc"}});
+  return replacer.replace(filename);
 }
 
 std::string read_file_to_string(const std::string& filename) {
@@ -819,14 +892,79 @@ bool is_file_exists(const std::string& name) {
   return (stat(name.c_str(), &buffer) == 0);
 }
 
-std::string rm_continue_break(const std::string& s) {
-  static std::regex p_continue("continue ?;");
-  static std::regex p_break("break ?;");
+void restrict_traversal_scope(clang::ASTContext* ast_context, const std::vector<std::string>& allowed_paths) {
+  if (allowed_paths.size() == 0) {
+    return;
+  }
 
-  std::string res = std::regex_replace(s, p_continue, "");
-  res = std::regex_replace(res, p_break, "");
+  const clang::SourceManager& source_manager = ast_context->getSourceManager();
 
-  return res;
+  std::vector<clang::Decl*> scope;
+  size_t total = 0;
+  for (clang::Decl* decl : ast_context->getTranslationUnitDecl()->decls()) {
+    total += 1;
+    clang::SourceLocation loc = source_manager.getExpansionLoc(decl->getLocation());
+    if (loc.isInvalid()) {
+      continue;
+    }
+
+    if (source_manager.isInMainFile(loc)) {
+      scope.push_back(decl);
+      continue;
+    }
+
+    std::string filename = source_manager.getFilename(loc).str();
+    for (const std::string& path : allowed_paths) {
+      if (filename.find(path) != std::string::npos) {
+        scope.push_back(decl);
+        break;
+      }
+    }
+  }
+
+  LOG(INFO) << "restrict traversal scope, top level decls: " << total << ", keep: " << scope.size();
+  ast_context->setTraversalScope(scope);
+}
+
+std::string format_code(const std::string& code, const std::string& filename) {
+  static const clang::format::FormatStyle style = [] {
+    clang::format::FormatStyle res = clang::format::getGoogleStyle(clang::format::FormatStyle::LK_Cpp);
+    res.ColumnLimit = 110;
+    res.IndentCaseLabels = true;
+    return res;
+  }();
+
+  // 和 clang-format 命令行一样，先排序 include, 再格式化。
+  clang::tooling::Replacements include_replaces =
+    clang::format::sortIncludes(style, code, {clang::tooling::Range(0, code.size())}, filename);
+  llvm::Expected<std::string> sorted = clang::tooling::applyAllReplacements(code, include_replaces);
+  if (!sorted) {
+    LOG(ERROR) << "sort includes failed, filename: " << filename
+               << ", err: " << llvm::toString(sorted.takeError());
+    return code;
+  }
+
+  clang::tooling::Replacements replaces =
+    clang::format::reformat(style, *sorted, {clang::tooling::Range(0, sorted->size())}, filename);
+  llvm::Expected<std::string> formatted = clang::tooling::applyAllReplacements(*sorted, replaces);
+  if (!formatted) {
+    LOG(ERROR) << "format failed, filename: " << filename
+               << ", err: " << llvm::toString(formatted.takeError());
+    return *sorted;
+  }
+
+  return *formatted;
+}
+
+bool write_formatted_file(const std::string& filename, const std::string& content) {
+  std::ofstream wfile(filename);
+  if (!wfile.is_open()) {
+    LOG(ERROR) << "cannot open file, filename: " << filename;
+    return false;
+  }
+
+  wfile << format_code(content, filename);
+  return true;
 }
 
 std::string find_last_include(const std::string& content) {
@@ -858,17 +996,21 @@ bool is_string(const std::string& type_str) {
 }
 
 // TODO(liuzhishan): fix
-bool is_string(clang::QualType qual_type) {
+static bool is_string_uncached(clang::QualType qual_type) {
   if (is_char_arr(qual_type)) {
     return true;
   }
 
-  std::string type_str = lower(qual_type.getAsString());
+  std::string type_str = lower(TypeCategoryCache::type_str(qual_type));
   return is_string(type_str);
 }
 
-bool is_char_arr(clang::QualType qual_type) {
-  std::string type_str = lower(qual_type.getAsString());
+bool is_string(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::STRING, is_string_uncached);
+}
+
+static bool is_char_arr_uncached(clang::QualType qual_type) {
+  std::string type_str = lower(TypeCategoryCache::type_str(qual_type));
 
   std::regex p("(const )?char \\[.+?\\]");
   std::smatch m;
@@ -879,6 +1021,10 @@ bool is_char_arr(clang::QualType qual_type) {
   return false;
 }
 
+bool is_char_arr(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::CHAR_ARR, is_char_arr_uncached);
+}
+
 std::string add_quote(const std::string& s) {
   std::ostringstream oss;
   oss << "\"" << s << "\"";
@@ -890,13 +1036,13 @@ bool is_from_info_util(const std::string& s) {
 }
 
 std::string fix_ad_enum(const std::string& s) {
-  static std::regex p("ad::class ");
-  return std::regex_replace(s, p, "ad::");
+  static const TextReplacer replacer({{"ad::class ", "ad::"}});
+  return replacer.replace(s);
 }
 
 std::string adlog_to_bs_enum_str(const std::string& s) {
-  std::string s1 = std::regex_replace(s, std::regex("\\."), "_");
-  return std::regex_replace(s1, std::regex(":"), "_");
+  static const TextReplacer replacer({{"\\.", "_"}, {":", "_"}});
+  return replacer.replace(s);
 }
 
 std::string dot_underscore_to_camel(const std::string& s) {
@@ -919,34 +1065,42 @@ std::string dot_underscore_to_camel(const std::string& s) {
   return oss.str();
 }
 
-bool is_var_proto_list(clang::QualType qualType) {
+static bool is_var_proto_list_uncached(clang::QualType qualType) {
   const clang::Type* type = qualType.getTypePtr();
   if (type == nullptr) {
     return false;
   }
   if (type->isRecordType() || type->isReferenceType()) {
-    return qualType.getAsString().find("google::protobuf::Repeated") != std::string::npos;
+    return TypeCategoryCache::type_str(qualType).find("google::protobuf::Repeated") != std::string::npos;
   }
 
   return false;
 }
 
-bool is_var_proto_map(clang::QualType qualType) {
+bool is_var_proto_list(clang::QualType qualType) {
+  return TypeCategoryCache::get(qualType, TypeCategory::VAR_PROTO_LIST, is_var_proto_list_uncached);
+}
+
+static bool is_var_proto_map_uncached(clang::QualType qualType) {
   const clang::Type* type = qualType.getTypePtr();
 
   if (type == nullptr) {
     return false;
   }
   if (type->isRecordType() || type->isReferenceType()) {
-    return qualType.getAsString().find("google::protobuf::Map") != std::string::npos;
+    return TypeCategoryCache::type_str(qualType).find("google::protobuf::Map") != std::string::npos;
   }
 
   return false;
 }
 
-bool is_var_proto_message(clang::QualType qual_type) {
+bool is_var_proto_map(clang::QualType qualType) {
+  return TypeCategoryCache::get(qualType, TypeCategory::VAR_PROTO_MAP, is_var_proto_map_uncached);
+}
+
+static bool is_var_proto_message_uncached(clang::QualType qual_type) {
   const clang::Type *type = qual_type.getTypePtr();
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   if (type == nullptr) {
     return false;
@@ -964,8 +1118,12 @@ bool is_var_proto_message(clang::QualType qual_type) {
   return false;
 }
 
-bool is_repeated_proto_message(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_var_proto_message(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::VAR_PROTO_MESSAGE, is_var_proto_message_uncached);
+}
+
+static bool is_repeated_proto_message_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   if (is_repeated_proto(qual_type)) {
     if (type_str.find("auto_cpp_rewriter::") != std::string::npos) {
       if (type_str.find("Map") == std::string::npos) {
@@ -977,6 +1135,10 @@ bool is_repeated_proto_message(clang::QualType qual_type) {
   return false;
 }
 
+bool is_repeated_proto_message(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::REPEATED_PROTO_MESSAGE, is_repeated_proto_message_uncached);
+}
+
 std::vector<int> find_common_info_values_in_file(const std::string& filename) {
   std::vector<int> res;
 
@@ -1070,14 +1232,14 @@ bool is_cxx_default_arg_expr(clang::Expr* expr) {
 }
 
 std::string trim_this(const std::string& s) {
-  static const std::regex p("this\\->");
-  return std::regex_replace(s, p, "");
+  static const TextReplacer replacer({{"this\\->", ""}});
+  return replacer.replace(s);
 }
 
-bool is_int_vector(clang::QualType qual_type) {
+static bool is_int_vector_uncached(clang::QualType qual_type) {
   const clang::Type* type = qual_type.getTypePtr();
   if (type != nullptr) {
-    if (qual_type.getAsString().find("vector<int") != std::string::npos) {
+    if (TypeCategoryCache::type_str(qual_type).find("vector<int") != std::string::npos) {
       return true;
     }
   }
@@ -1085,6 +1247,10 @@ bool is_int_vector(clang::QualType qual_type) {
   return false;
 }
 
+bool is_int_vector(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::INT_VECTOR, is_int_vector_uncached);
+}
+
 std::string rm_surround_big_parantheses(const std::string& s) {
   if (s.size() == 0) {
     return s;
@@ -1149,37 +1315,53 @@ bool is_action_info(const std::string& type_str) {
   return action_info_types.find(type_str) != action_info_types.end();
 }
 
-bool is_action_info(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+static bool is_action_info_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   return is_action_info(type_str);
 }
 
-bool is_repeated_proto(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_action_info(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::ACTION_INFO, is_action_info_uncached);
+}
+
+static bool is_repeated_proto_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("(const )?::google::protobuf::Repeated(Ptr)?Field< ?.*> ?\\&?");
   std::smatch m;
   return std::regex_match(type_str, m, p);
 }
 
-bool is_repeated_proto_iterator(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_repeated_proto(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::REPEATED_PROTO, is_repeated_proto_uncached);
+}
+
+static bool is_repeated_proto_iterator_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("(const )?(::)?google::protobuf::Repeated(Ptr)?Field< ?.*>::(const_)?iterator");
   std::smatch m;
   return std::regex_match(type_str, m, p);
 }
 
-bool is_map_proto(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_repeated_proto_iterator(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::REPEATED_PROTO_ITERATOR, is_repeated_proto_iterator_uncached);
+}
+
+static bool is_map_proto_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("(const )?::google::protobuf::Map< ?(.*)> ?\&?");
   std::smatch m;
   return std::regex_match(type_str, m, p);
 }
 
+bool is_map_proto(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::MAP_PROTO, is_map_proto_uncached);
+}
+
 bool is_map_proto_iterator(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   LOG(INFO) << "type_str: " << type_str;
 
@@ -1188,9 +1370,9 @@ bool is_map_proto_iterator(clang::QualType qual_type) {
   return std::regex_match(type_str, m, p);
 }
 
-bool is_repeated_action_info(clang::QualType qual_type) {
+static bool is_repeated_action_info_uncached(clang::QualType qual_type) {
   if (is_repeated_proto(qual_type)) {
-    std::string type_str = qual_type.getAsString();
+    std::string type_str = TypeCategoryCache::type_str(qual_type);
     static std::regex p("(const )?::google::protobuf::Repeated(Ptr)?Field< ?(.*)::(.*)> ?\\&?");
     std::smatch m;
     if (std::regex_match(type_str, m, p)) {
@@ -1205,8 +1387,12 @@ bool is_repeated_action_info(clang::QualType qual_type) {
   return false;
 }
 
-bool is_action_detail_map(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_repeated_action_info(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::REPEATED_ACTION_INFO, is_repeated_action_info_uncached);
+}
+
+static bool is_action_detail_map_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   if (type_str.find("google::protobuf::Map") != std::string::npos) {
     if (type_str.find("ad::algorithm::AdActionInfoList") != std::string::npos ||
@@ -1220,8 +1406,12 @@ bool is_action_detail_map(clang::QualType qual_type) {
   return false;
 }
 
+bool is_action_detail_map(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::ACTION_DETAIL_MAP, is_action_detail_map_uncached);
+}
+
 std::string get_bs_type_str(clang::QualType qual_type, bool is_combine_user) {
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   if (is_reco_proto(qual_type)) {
     return type_str;
@@ -1246,7 +1436,7 @@ std::string get_bs_type_str(clang::QualType qual_type, bool is_combine_user) {
 }
 
 absl::optional<std::string> get_repeated_proto_inner_type(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   static std::regex p("(const )?(::)?google::protobuf::Repeated(Ptr)?Field< ?(.*)> ?[\\&\\*]?");
   std::smatch m;
   if (std::regex_match(type_str, m, p)) {
@@ -1269,7 +1459,7 @@ absl::optional<std::string> get_repeated_proto_inner_type(clang::QualType qual_t
 }
 
 absl::optional<std::string> get_repeated_proto_iterator_inner_type(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   static std::regex p("(const )?(::)?google::protobuf::Repeated(Ptr)?Field< ?(.*)>::const_iterator");
   std::smatch m;
   if (std::regex_match(type_str, m, p)) {
@@ -1287,7 +1477,7 @@ absl::optional<std::string> get_repeated_proto_iterator_inner_type(clang::QualTy
 }
 
 absl::optional<std::pair<std::string, std::string>> get_map_proto_inner_type(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   static std::regex p("(const )?(class )?(::)?google::protobuf::Map< ?(.*), (.*) ?> ?(\\&\\*)?");
   std::smatch m;
 
@@ -1336,8 +1526,8 @@ std::string get_bs_map_field_type(const std::string &key_type_str,
   return oss.str();
 }
 
-bool is_repeated_proto_ptr(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+static bool is_repeated_proto_ptr_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("(const )?(class )?(::)?google::protobuf::Repeated(Ptr)?Field< ?.*> ?\\*");
   std::smatch m;
@@ -1349,38 +1539,53 @@ bool is_repeated_proto_ptr(clang::QualType qual_type) {
   return std::regex_match(type_str, m, p_mapped_type);
 }
 
-bool is_reco_proto(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_repeated_proto_ptr(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::REPEATED_PROTO_PTR, is_repeated_proto_ptr_uncached);
+}
+
+static bool is_reco_proto_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   return type_str.find("google::protobuf") != std::string::npos &&
     type_str.find("ks::reco") != std::string::npos;
 }
 
+bool is_reco_proto(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::RECO_PROTO, is_reco_proto_uncached);
+}
+
 bool is_reco_proto_type(clang::QualType qual_type) {
   return is_reco_proto(qual_type);
 }
 
 std::string replace_adlog_to_bslog(const std::string &s) {
-  static std::regex p("(adlog|ad_log)");
-  std::string new_str = std::regex_replace(s, p, "bslog");
-  return new_str;
+  static const TextReplacer replacer({{"(adlog|ad_log)", "bslog"}});
+  return replacer.replace(s);
 }
 
-bool is_map_repeated_int_list_type(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+static bool is_map_repeated_int_list_type_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("std::(unordered_)?map<int,[ \\n]?(const )?google::protobuf::RepeatedField< ?::google::protobuf::int64> ?\\*>");
   std::smatch m;
   return std::regex_match(type_str, m, p);
 }
 
-bool is_map_int_int_type(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+bool is_map_repeated_int_list_type(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::MAP_REPEATED_INT_LIST_TYPE, is_map_repeated_int_list_type_uncached);
+}
+
+static bool is_map_int_int_type_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("std::(unordered_)?map<int, int>");
   std::smatch m;
   return std::regex_match(type_str, m, p);
 }
 
+bool is_map_int_int_type(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::MAP_INT_INT_TYPE, is_map_int_int_type_uncached);
+}
+
 clang::Expr* get_inner_expr(clang::Expr* expr) {
   if (expr == nullptr) {
     return expr;
@@ -1398,14 +1603,9 @@ clang::Expr* get_inner_expr(clang::Expr* expr) {
   return expr;
 }
 
-std::string rm_empty_line(const std::string& s) {
-  static std::regex p_empty_line("\n *;");
-  return std::regex_replace(s, p_empty_line, "");
-}
-
 std::string trim_tail_underscore(const std::string& s) {
-  static std::regex p("_+$");
-  return std::regex_replace(s, p, "");
+  static const TextReplacer replacer({{"_+$", ""}});
+  return replacer.replace(s);
 }
 
 bool is_common_info_list_or_map_loop_stmt(clang::Stmt* stmt) {
@@ -1452,14 +1652,18 @@ bool contains_var(const std::string& expr_str, const std::string& var_name) {
   return false;
 }
 
-bool is_map_item_type_int_type(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+static bool is_map_item_type_int_type_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("std::(unordered_)?map<ItemType, int>");
   std::smatch m;
   return std::regex_match(type_str, m, p);
 }
 
+bool is_map_item_type_int_type(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::MAP_ITEM_TYPE_INT_TYPE, is_map_item_type_int_type_uncached);
+}
+
 std::string get_last_type_str(const std::string& s) {
   size_t pos = s.find("::");
   if (pos != std::string::npos) {
@@ -1478,11 +1682,15 @@ bool has_cc_file(const std::string& filename) {
   return false;
 }
 
-bool is_pointer(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+static bool is_pointer_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
   return ends_with(type_str, "*");
 }
 
+bool is_pointer(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::POINTER, is_pointer_uncached);
+}
+
 bool is_proto_map_string_float(clang::QualType qual_type) {
   if (auto inner_type = get_map_proto_inner_type(qual_type)) {
     if (inner_type->first == "absl::string_view" && inner_type->second == "float") {
@@ -1497,14 +1705,18 @@ bool is_proto_map_string_float_ptr(clang::QualType qual_type) {
   return is_proto_map_string_float(qual_type) && is_pointer(qual_type);
 }
 
-bool is_proto_map_string_float_iter(clang::QualType qual_type) {
-  std::string type_str = qual_type.getAsString();
+static bool is_proto_map_string_float_iter_uncached(clang::QualType qual_type) {
+  std::string type_str = TypeCategoryCache::type_str(qual_type);
 
   static std::regex p("(const )?(class )?(::)?google::protobuf::Map< ?(::)?std::string, float ?>::(const_)?iterator");
   std::smatch m;
   return std::regex_match(type_str, m, p);
 }
 
+bool is_proto_map_string_float_iter(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::PROTO_MAP_STRING_FLOAT_ITER, is_proto_map_string_float_iter_uncached);
+}
+
 std::string trim_exists(const std::string& s) {
   if (ends_with(s, ".exists")) {
     return s.substr(0, s.size() - 7);
@@ -1514,13 +1726,13 @@ std::string trim_exists(const std::string& s) {
 }
 
 bool is_int_type(const std::string& type_str) {
-  static std::regex p("(::)?google::protobuf::");
-  static std::regex p_const("const ?");
+  static const TextReplacer replacer_protobuf({{"(::)?google::protobuf::", ""}});
+  static const TextReplacer replacer_const({{"const ?", ""}});
 
   static std::regex p_int("u?int(32|64)_?t?");
 
-  std::string s = std::regex_replace(lower(type_str), p, "");
-  s = std::regex_replace(s, p_const, "");
+  std::string s = replacer_protobuf.replace(lower(type_str));
+  s = replacer_const.replace(s);
 
   if (s == "size_t") {
     return true;
@@ -1546,7 +1758,7 @@ bool is_float_type(const std::string& type_str) {
   return false;
 }
 
-bool is_repeated_proto_list_leaf_type(clang::QualType qual_type) {
+static bool is_repeated_proto_list_leaf_type_uncached(clang::QualType qual_type) {
   if (is_var_proto_list(qual_type)) {
     if (absl::optional<std::string> inner_type = get_repeated_proto_inner_type(qual_type)) {
       if (is_string(*inner_type)) {
@@ -1561,8 +1773,12 @@ bool is_repeated_proto_list_leaf_type(clang::QualType qual_type) {
   return false;
 }
 
+bool is_repeated_proto_list_leaf_type(clang::QualType qual_type) {
+  return TypeCategoryCache::get(qual_type, TypeCategory::REPEATED_PROTO_LIST_LEAF_TYPE, is_repeated_proto_list_leaf_type_uncached);
+}
+
 std::vector<int> get_int_list_values_from_init_str(const std::string& s) {
-  static std::regex p_space(" +");
+  static const TextReplacer replacer_space({{" +", ""}});
   static std::regex p("\\{([\\d ,]+)\\}");
 
   std::vector<int> res;
@@ -1574,7 +1790,7 @@ std::vector<int> get_int_list_values_from_init_str(const std::string& s) {
       std::string value_str = m[m.size() - 1];
       LOG(INFO) << "match value: " << value_str;
 
-      value_str = std::regex_replace(value_str, p_space, "");
+      value_str = replacer_space.replace(value_str);
       if (value_str.size() == 0) {
         LOG(INFO) << "cannot find init values from: " << s;
         return  res;
@@ -1607,17 +1823,6 @@ bool is_str_from_reco_user_info(const std::string& bs_enum_str) {
   return bs_enum_str.find("reco_user_info") != std::string::npos;
 }
 
-std::string replace_simple_text(const std::string &s) {
-  static std::regex p("_Bool");
-  static std::regex p_empty_line("\n *\n");
-  static std::regex p_empty_line_semicoln("\n *;");
-
-  std::string s1 = std::regex_replace(s, p, "bool");
-  s1 = std::regex_replace(s1, p_empty_line_semicoln, "");
-
-  return s1;
-}
-
 std::string insert_str_at_block_begin(const std::string& s, const std::string& new_str) {
   std::ostringstream oss;
 
@@ -35,6 +35,8 @@
 #include "llvm/ADT/StringRef.h"
 
 #include "Config.h"
+#include "TextReplacer.h"
+#include "TextRewrite.h"
 
 namespace ks {
 namespace ad_algorithm {
@@ -47,8 +49,12 @@ class Env;
 
 clang::SourceRange find_source_range(clang::Stmt* stmt);
 
+/// 结果会缓存，同一个源文件中每个 stmt 只打印一次。
 std::string stmt_to_string(clang::Stmt* stmt, unsigned suppressTagKeyword = 0);
 
+/// 清空 stmt_to_string 的缓存，每个源文件开始处理时调用。
+void clear_stmt_string_cache();
+
 clang::Expr* get_first_caller(clang::Expr* initExpr, const Env* env_ptr = nullptr);
 
 const clang::TemplateArgumentList* get_proto_map_args_list(clang::QualType qualType);
@@ -170,19 +176,30 @@ bool is_action_detail_map(clang::QualType qual_type);
 
 std::string get_exists_name(const std::string& name);
 
-std::string fix_std_string(const std::string& s);
-
 std::string fix_string_view(const std::string& s);
 
 std::string get_bs_correspond_path(const std::string& filename);
 
+/// xxx.h 对应的 xxx.cc。
+std::string get_cc_filename(const std::string& filename);
+
 std::string read_file_to_string(const std::string& filename);
 
 bool is_bs_already_rewritten(const std::string& filename);
 
 bool is_file_exists(const std::string& name);
 
-std::string rm_continue_break(const std::string& s);
+/// 将 ast 遍历范围限制为主文件以及路径包含 allowed_paths 中任意一个的文件中的顶层 decl,
+/// 跳过系统头文件、pb.h 以及 third_party 等。allowed_paths 为空则不做限制。
+void restrict_traversal_scope(clang::ASTContext* ast_context, const std::vector<std::string>& allowed_paths);
+
+/// 使用 libclangFormat 在内存中格式化代码，风格同
+/// `clang-format --style="{BasedOnStyle: Google, ColumnLimit: 110, IndentCaseLabels: true}"`。
+/// 格式化失败则返回原始内容。
+std::string format_code(const std::string& code, const std::string& filename);
+
+/// 格式化后写入文件。
+bool write_formatted_file(const std::string& filename, const std::string& content);
 
 std::string find_last_include(const std::string& content);
 
@@ -265,8 +282,6 @@ bool is_map_int_int_type(clang::QualType qual_type);
 
 clang::Expr* get_inner_expr(clang::Expr* expr);
 
-std::string rm_empty_line(const std::string& s);
-
 std::string trim_tail_underscore(const std::string& s);
 
 bool is_common_info_list_or_map_loop_stmt(clang::Stmt* stmt);
@@ -300,8 +315,6 @@ std::string add_filename_suffix(const std::string& filename, const std::string&
 
 bool is_str_from_reco_user_info(const std::string& bs_enum_str);
 
-std::string replace_simple_text(const std::string &s);
-
 std::string insert_str_at_block_begin(const std::string &s, const std::string &new_str);
 
 std::string strip_suffix_semicolon_newline(const std::string& s);
@@ -0,0 +1,49 @@
+#include "TypeCategory.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+thread_local std::unordered_map<void*, TypeCategoryCache::Entry> TypeCategoryCache::entries_;
+
+const std::string& TypeCategoryCache::type_str(clang::QualType qual_type) {
+  Entry& entry = find_entry(qual_type);
+  if (!entry.has_type_str) {
+    entry.type_str = qual_type.getAsString();
+    entry.has_type_str = true;
+  }
+
+  return entry.type_str;
+}
+
+bool TypeCategoryCache::get(clang::QualType qual_type,
+                            TypeCategory category,
+                            bool (*compute)(clang::QualType)) {
+  uint64_t mask = uint64_t(1) << static_cast<int>(category);
+
+  Entry& entry = find_entry(qual_type);
+  if (entry.computed & mask) {
+    return entry.value & mask;
+  }
+
+  // compute 中可能会判断其他类型而插入新的 entry, unordered_map 插入不会使已有元素的引用失效。
+  bool res = compute(qual_type);
+  entry.computed |= mask;
+  if (res) {
+    entry.value |= mask;
+  }
+
+  return res;
+}
+
+void TypeCategoryCache::clear() {
+  entries_.clear();
+}
+
+TypeCategoryCache::Entry& TypeCategoryCache::find_entry(clang::QualType qual_type) {
+  return entries_[qual_type.getAsOpaquePtr()];
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
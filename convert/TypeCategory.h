@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "clang/AST/Type.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// 类型的分类，对应 `Tool.h` 中各个类型判断函数。
+enum class TypeCategory {
+  BASIC_TYPE,
+  COMMON_INFO_VECTOR,
+  COMMON_INFO_ENUM,
+  COMMON_INFO_STRUCT,
+  REPEATED_COMMON_INFO,
+  AD_CALLBACK_LOG_ENUM,
+  AD_ACTION_TYPE_ENUM,
+  AD_ENUM,
+  BASIC_ARRAY,
+  BUILTIN_SIMPLE_TYPE,
+  STRING,
+  CHAR_ARR,
+  VAR_PROTO_LIST,
+  VAR_PROTO_MAP,
+  VAR_PROTO_MESSAGE,
+  REPEATED_PROTO_MESSAGE,
+  INT_VECTOR,
+  ACTION_INFO,
+  REPEATED_PROTO,
+  REPEATED_PROTO_ITERATOR,
+  MAP_PROTO,
+  REPEATED_ACTION_INFO,
+  ACTION_DETAIL_MAP,
+  REPEATED_PROTO_PTR,
+  RECO_PROTO,
+  MAP_REPEATED_INT_LIST_TYPE,
+  MAP_INT_INT_TYPE,
+  MAP_ITEM_TYPE_INT_TYPE,
+  POINTER,
+  PROTO_MAP_STRING_FLOAT_ITER,
+  REPEATED_PROTO_LIST_LEAF_TYPE,
+  COUNT
+};
+
+static_assert(static_cast<int>(TypeCategory::COUNT) <= 64, "TypeCategory must fit in uint64_t");
+
+/// 类型判断结果的缓存。
+///
+/// 类型判断都是基于 `getAsString()` 的结果做字符串查找或者正则匹配，每个表达式都会判断很多次。
+/// 以 `QualType` 为 key 缓存类型的字符串以及每一种分类的结果，同一个类型只转一次字符串，每种分类只计算一次。
+///
+/// key 是包含 typedef 等信息的 `QualType` 本身而不是 canonical type, 因为判断逻辑依赖类型的写法，
+/// 如 `int64_t` 和 `long` 的结果不同。`QualType` 的地址只在当前源文件中有效，每个源文件开始处理时需要清空。
+class TypeCategoryCache {
+ public:
+  /// 等价于 `qual_type.getAsString()`。
+  static const std::string& type_str(clang::QualType qual_type);
+
+  /// 返回类型是否属于 category, 第一次判断时调用 compute 计算。
+  static bool get(clang::QualType qual_type, TypeCategory category, bool (*compute)(clang::QualType));
+
+  static void clear();
+
+ private:
+  struct Entry {
+    bool has_type_str = false;
+    std::string type_str;
+
+    /// 每一位对应一种 TypeCategory。
+    uint64_t computed = 0;
+    uint64_t value = 0;
+  };
+
+  static Entry& find_entry(clang::QualType qual_type);
+
+  static thread_local std::unordered_map<void*, Entry> entries_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -44,7 +44,8 @@ void update_env_query_token_field_def(ExprInfo* expr_info_ptr, Env* env_ptr) {
                                         "GetPhotoText",
                                         oss.str(),
                                         NewVarType::MAP,
-                                        AdlogVarType::GET_PHOTO_TEXT);
+                                        AdlogVarType::GET_PHOTO_TEXT,
+                                        env_ptr->is_in_loop());
           }
         } else {
           LOG(INFO) << "cannot find int_value from photo text call: " << expr_info_ptr->origin_expr_str();
@@ -3,11 +3,14 @@
 #include <glog/logging.h>
 #include <gflags/gflags.h>
 
+#include <type_traits>
+
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "clang/Basic/SourceLocation.h"
 
 #include "../Tool.h"
 #include "../Env.h"
+#include "../ExprParser.h"
 #include "../rule/PreRule.h"
 #include "../rule/GeneralRule.h"
 #include "../rule/CommonInfoRule.h"
@@ -45,23 +48,36 @@ class AdlogFieldHandler {
     query_token_rule_(rewriter),
     str_rule_(rewriter) {}
 
+  /// 每种节点只分发给重载了对应 process 的规则，在编译期确定，见 rule_overrides_process。
   template<typename T>
   void process(T t, Env* env_ptr) {
-    pre_rule_.process(t, env_ptr);
-
-    common_info_rule_.process(t, env_ptr);
-    middle_node_rule_.process(t, env_ptr);
-    action_detail_rule_.process(t, env_ptr);
-    double_list_rule_.process(t, env_ptr);
-    seq_list_rule_.process(t, env_ptr);
-    proto_list_rule_.process(t, env_ptr);
-    add_feature_method_rule_.process(t, env_ptr);
-    hash_fn_rule_.process(t, env_ptr);
-    query_token_rule_.process(t, env_ptr);
-    str_rule_.process(t, env_ptr);
+    // 所有规则共用同一次解析的结果。
+    ParseExprScope parse_expr_scope;
+
+    dispatch(&pre_rule_, t, env_ptr);
+
+    dispatch(&common_info_rule_, t, env_ptr);
+    dispatch(&middle_node_rule_, t, env_ptr);
+    dispatch(&action_detail_rule_, t, env_ptr);
+    dispatch(&double_list_rule_, t, env_ptr);
+    dispatch(&seq_list_rule_, t, env_ptr);
+    dispatch(&proto_list_rule_, t, env_ptr);
+    dispatch(&add_feature_method_rule_, t, env_ptr);
+    dispatch(&hash_fn_rule_, t, env_ptr);
+    dispatch(&query_token_rule_, t, env_ptr);
+    dispatch(&str_rule_, t, env_ptr);
 
     /// 由于一些插入变量等逻辑, general_rule_ 必须放到最后一个。
-    general_rule_.process(t, env_ptr);
+    dispatch(&general_rule_, t, env_ptr);
+  }
+
+ private:
+  template<typename Rule, typename T>
+  void dispatch(Rule* rule, T t, Env* env_ptr) {
+    if constexpr (rule_overrides_process<Rule, typename std::remove_pointer<T>::type>::value) {
+      ParseExprRuleScope rule_scope;
+      rule->process(t, env_ptr);
+    }
   }
 
  private:
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <glog/logging.h>
+
+#include "clang/Lex/Lexer.h"
+
+#include "EditLedger.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+namespace {
+
+thread_local EditLedger* current_ledger = nullptr;
+
+const char* edit_kind_str(EditLedger::EditKind kind) {
+  switch (kind) {
+    case EditLedger::EditKind::REPLACE:
+      return "replace";
+    case EditLedger::EditKind::REMOVE:
+      return "remove";
+    case EditLedger::EditKind::INSERT_BEFORE:
+      return "insert_before";
+    case EditLedger::EditKind::WRAP:
+      return "wrap";
+    case EditLedger::EditKind::INSERT:
+      return "insert";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace
+
+EditLedger* EditLedger::current() {
+  return current_ledger;
+}
+
+bool EditLedger::record(const clang::SourceManager& source_manager,
+                        const clang::LangOptions& lang_opts,
+                        clang::SourceRange range,
+                        EditKind kind,
+                        const void* owner,
+                        const std::string& rule_name,
+                        const std::function<bool()>& is_wrap) {
+  if (range.isInvalid()) {
+    return false;
+  }
+
+  clang::SourceLocation begin_loc = source_manager.getFileLoc(range.getBegin());
+  clang::SourceLocation end_loc = source_manager.getFileLoc(range.getEnd());
+  if (begin_loc.isInvalid() || end_loc.isInvalid()) {
+    return false;
+  }
+
+  std::pair<clang::FileID, unsigned> begin = source_manager.getDecomposedLoc(begin_loc);
+  std::pair<clang::FileID, unsigned> end = source_manager.getDecomposedLoc(end_loc);
+  if (begin.first != end.first) {
+    return false;
+  }
+
+  // SourceRange 的结束位置是最后一个 token 的开始位置。
+  Edit edit;
+  edit.begin = begin.second;
+  edit.end = end.second + clang::Lexer::MeasureTokenLength(end_loc, source_manager, lang_opts);
+  edit.kind = kind;
+  edit.owner = owner;
+  edit.rule_name = rule_name;
+
+  return add(begin.first, edit, is_wrap);
+}
+
+bool EditLedger::record_insert(const clang::SourceManager& source_manager,
+                               clang::SourceLocation loc,
+                               const void* owner,
+                               const std::string& rule_name) {
+  if (loc.isInvalid()) {
+    return false;
+  }
+
+  clang::SourceLocation file_loc = source_manager.getFileLoc(loc);
+  if (file_loc.isInvalid()) {
+    return false;
+  }
+
+  std::pair<clang::FileID, unsigned> pos = source_manager.getDecomposedLoc(file_loc);
+
+  Edit edit;
+  edit.begin = pos.second;
+  edit.end = pos.second;
+  edit.kind = EditKind::INSERT;
+  edit.owner = owner;
+  edit.rule_name = rule_name;
+
+  return add(pos.first, edit, nullptr);
+}
+
+bool EditLedger::add(clang::FileID file_id, Edit edit, const std::function<bool()>& is_wrap) {
+  FileIndex& index = file_indexes_[file_id];
+  bool has_conflict = false;
+
+  if (edit.begin == edit.end) {
+    // 插入的位置只可能在开始位置更靠前的编辑内部，并且距离不超过最长编辑的长度。
+    unsigned from = edit.begin > index.max_len ? edit.begin - index.max_len : 0;
+    for (auto it = index.by_begin.lower_bound(from);
+         it != index.by_begin.end() && it->first < edit.begin;
+         ++it) {
+      if (is_conflict(*it->second, edit)) {
+        log_conflict(*it->second, edit);
+        has_conflict = true;
+      }
+    }
+  } else {
+    // 开始位置落在 [begin, end) 内的编辑，包括范围完全相同、和新范围后半部分交叉的编辑以及范围内的插入。
+    for (auto it = index.by_begin.lower_bound(edit.begin);
+         it != index.by_begin.end() && it->first < edit.end;
+         ++it) {
+      // 范围完全相同时才需要区分 REPLACE 和 WRAP, 没有 is_wrap 时无法判断，按 WRAP 处理。
+      const Edit& prev = *it->second;
+      if (edit.kind == EditKind::REPLACE &&
+          prev.begin == edit.begin &&
+          prev.end == edit.end &&
+          prev.owner != edit.owner &&
+          (!is_wrap || is_wrap())) {
+        edit.kind = EditKind::WRAP;
+      }
+
+      if (is_conflict(prev, edit)) {
+        log_conflict(prev, edit);
+        has_conflict = true;
+      }
+    }
+
+    // 结束位置落在 (begin, end) 内并且在新范围之前开始的编辑，即和新范围前半部分交叉的编辑。
+    for (auto it = index.by_end.upper_bound(edit.begin);
+         it != index.by_end.end() && it->first < edit.end;
+         ++it) {
+      if (it->second->begin < edit.begin && is_conflict(*it->second, edit)) {
+        log_conflict(*it->second, edit);
+        has_conflict = true;
+      }
+    }
+  }
+
+  edits_.push_back(edit);
+  const Edit* edit_ptr = &edits_.back();
+  index.by_begin.emplace(edit_ptr->begin, edit_ptr);
+  index.by_end.emplace(edit_ptr->end, edit_ptr);
+  index.max_len = std::max(index.max_len, edit_ptr->end - edit_ptr->begin);
+
+  if (has_conflict) {
+    conflict_count_++;
+  }
+
+  return has_conflict;
+}
+
+bool EditLedger::is_conflict(const Edit& a, const Edit& b) const {
+  // 替换和删除会丢掉范围内已有的改写，其他编辑都会保留。
+  auto is_lossy = [](EditKind kind) { return kind == EditKind::REPLACE || kind == EditKind::REMOVE; };
+
+  if (a.begin == a.end || b.begin == b.end) {
+    const Edit& point = a.begin == a.end ? a : b;
+    const Edit& range = a.begin == a.end ? b : a;
+    return range.begin < range.end &&
+           is_lossy(range.kind) &&
+           range.begin < point.begin &&
+           point.begin < range.end;
+  }
+
+  if (a.begin == b.begin && a.end == b.end) {
+    // 在语句前插入以及 WRAP 会读取已经改写的内容，因此可以在其他规则的替换之后进行。
+    return a.owner != b.owner && is_lossy(b.kind);
+  }
+
+  // 有重叠但互不包含则交叉。
+  return (a.begin > b.begin && a.begin < b.end && a.end > b.end) ||
+         (a.begin < b.begin && a.end > b.begin && a.end < b.end);
+}
+
+void EditLedger::log_conflict(const Edit& a, const Edit& b) const {
+  LOG(INFO) << "find rewrite conflict, prev: " << a.rule_name << " " << edit_kind_str(a.kind)
+            << " [" << a.begin << ", " << a.end << ")"
+            << ", cur: " << b.rule_name << " " << edit_kind_str(b.kind)
+            << " [" << b.begin << ", " << b.end << ")";
+}
+
+EditLedgerScope::EditLedgerScope(const std::string& method_name):
+  method_name_(method_name),
+  prev_(current_ledger) {
+  current_ledger = &ledger_;
+}
+
+EditLedgerScope::~EditLedgerScope() {
+  if (ledger_.conflict_count() > 0) {
+    LOG(INFO) << "method: " << method_name_ << ", rewrite conflict count: " << ledger_.conflict_count();
+  }
+
+  current_ledger = prev_;
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
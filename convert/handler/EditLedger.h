@@ -0,0 +1,121 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/SourceManager.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// 一个方法处理过程中所有 StrictRewriter 的编辑记录。
+///
+/// 每个规则都有自己的 StrictRewriter, 各自只能保证同一个表达式不被自己替换两次，不同规则之间替换同一个
+/// 表达式或者替换的范围交叉时，`clang::Rewriter` 的结果是错乱的，并且很难定位。EditLedger 按源文件中的
+/// offset 记录每次替换和删除的范围，新的编辑和已有编辑冲突时打印日志，指出是哪两个规则。
+///
+/// 冲突是指:
+/// - 不同的 StrictRewriter 替换或者删除完全相同的范围，并且丢掉了之前的改写。替换后的内容包含之前改写的
+///   结果时是正常的，如用另一个 StrictRewriter 在外面再包一层，见 EditKind::WRAP。
+/// - 两个范围交叉，即有重叠但互不包含。互相包含是正常的，如先替换子表达式，再在整个语句前插入。
+/// - 在某个位置插入，但是该位置在另一个替换或者删除的范围内部，插入的内容会丢失。
+///
+/// 每个文件按编辑的开始和结束位置各建一个有序索引，查询交叉的范围只需要扫描开始或者结束位置落在新范围
+/// 内的编辑。插入只需要扫描开始位置在插入位置之前、最长编辑长度以内的编辑。
+///
+/// 只做检查，不会拒绝编辑，因此不影响改写的结果。区间检查每次编辑是 O(log n + k), 默认启用。范围完全相同
+/// 的 REPLACE 是否是 WRAP 需要读取改写后的内容，只在 --check-rewrite-conflict 时判断，否则都按 WRAP 处理，
+/// 不报告冲突。
+class EditLedger {
+ public:
+  enum class EditKind {
+    REPLACE,
+    REMOVE,
+    INSERT_BEFORE,
+
+    /// 替换后的内容包含该范围当前改写后的内容，不会丢失之前的改写。
+    WRAP,
+
+    /// 在某个位置插入，范围长度为 0。
+    INSERT
+  };
+
+  EditLedger() = default;
+  EditLedger(const EditLedger&) = delete;
+  EditLedger& operator=(const EditLedger&) = delete;
+
+  /// 当前线程正在使用的 ledger, 不在任何 EditLedgerScope 中时返回 nullptr。
+  static EditLedger* current();
+
+  /// 记录一次编辑, owner 用于区分不同的 StrictRewriter。返回是否和已有的编辑冲突。
+  ///
+  /// is_wrap 只在 REPLACE 和其他规则的编辑范围完全相同时才调用，返回 true 则按 WRAP 处理。判断需要
+  /// 读取改写后的内容，开销较大，因此不在每次替换时都判断。is_wrap 为空时按 WRAP 处理。
+  bool record(const clang::SourceManager& source_manager,
+              const clang::LangOptions& lang_opts,
+              clang::SourceRange range,
+              EditKind kind,
+              const void* owner,
+              const std::string& rule_name,
+              const std::function<bool()>& is_wrap = nullptr);
+
+  /// 记录在 loc 处的插入。
+  bool record_insert(const clang::SourceManager& source_manager,
+                     clang::SourceLocation loc,
+                     const void* owner,
+                     const std::string& rule_name);
+
+  size_t conflict_count() const { return conflict_count_; }
+
+ private:
+  struct Edit {
+    unsigned begin = 0;
+    unsigned end = 0;
+    EditKind kind = EditKind::REPLACE;
+    const void* owner = nullptr;
+    std::string rule_name;
+  };
+
+  struct FileIndex {
+    std::multimap<unsigned, const Edit*> by_begin;
+    std::multimap<unsigned, const Edit*> by_end;
+
+    /// 最长编辑的长度，用于限制插入时扫描的范围。
+    unsigned max_len = 0;
+  };
+
+  bool add(clang::FileID file_id, Edit edit, const std::function<bool()>& is_wrap);
+
+  /// a 是已有的编辑，b 是新的编辑。
+  bool is_conflict(const Edit& a, const Edit& b) const;
+  void log_conflict(const Edit& a, const Edit& b) const;
+
+ private:
+  std::deque<Edit> edits_;
+  std::map<clang::FileID, FileIndex> file_indexes_;
+  size_t conflict_count_ = 0;
+};
+
+/// 在该范围内 StrictRewriter 的编辑都记录到一个新的 ledger 中，结束时打印冲突的数量。
+class EditLedgerScope {
+ public:
+  explicit EditLedgerScope(const std::string& method_name);
+  ~EditLedgerScope();
+
+  EditLedgerScope(const EditLedgerScope&) = delete;
+  EditLedgerScope& operator=(const EditLedgerScope&) = delete;
+
+ private:
+  std::string method_name_;
+  EditLedger ledger_;
+  EditLedger* prev_ = nullptr;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
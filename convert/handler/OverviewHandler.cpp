@@ -1,4 +1,3 @@
-#include <regex>
 #include <glog/logging.h>
 #include <gflags/gflags.h>
 #include "../Tool.h"
@@ -39,10 +38,10 @@ void OverviewHandler::process(clang::CXXMemberCallExpr* cxx_member_call_expr, En
                     << ", name: size, new_name: " << name;
         }
       } else if (expr_info_ptr->is_parent_action_info()) {
-        std::regex p("(.*?)\\[(\\w+)\\]\\.(\\w+)\\(\\)");
-        std::string origin_name = std::regex_replace(expr_info_ptr->raw_expr_str(), p, "$1");
-        std::string name = std::regex_replace(expr_info_ptr->raw_expr_str(), p, "$1_$3");
-        std::string new_text = std::regex_replace(expr_info_ptr->raw_expr_str(), p, "$1_$3.Get($2)");
+        static const tool::TextReplacer replacer({{"(.*?)\\[(\\w+)\\]\\.(\\w+)\\(\\)", ""}});
+        std::string origin_name = replacer.replace(expr_info_ptr->raw_expr_str(), "$1");
+        std::string name = replacer.replace(expr_info_ptr->raw_expr_str(), "$1_$3");
+        std::string new_text = replacer.replace(expr_info_ptr->raw_expr_str(), "$1_$3.Get($2)");
         std::string type_str = tool::get_builtin_type_str(expr_info_ptr->expr()->getType());
         method_info.add_new_action_field_param(origin_name,
                                                expr_info_ptr->callee_name(),
@@ -1,3 +1,8 @@
+#include <functional>
+
+#include "clang/Lex/Lexer.h"
+
+#include "../Config.h"
 #include "../ExprInfo.h"
 #include "../Tool.h"
 #include "StrictRewriter.h"
@@ -11,11 +16,26 @@ bool StrictRewriter::ReplaceText(clang::Stmt* stmt, const std::string& s) {
     return false;
   }
 
-  visited_.insert(pointer_to_str(stmt));
-  return rewriter_.ReplaceText(find_source_range(stmt), s);
+  visited_.insert(stmt);
+  return ReplaceText(find_source_range(stmt), s);
 }
 
 bool StrictRewriter::ReplaceText(clang::SourceRange range, const std::string& s) {
+  if (EditLedger* ledger = EditLedger::current()) {
+    // 判断 WRAP 需要读取改写后的内容，只在 --check-rewrite-conflict 时判断。
+    std::function<bool()> is_wrap_func;
+    if (GlobalConfig::Instance()->check_rewrite_conflict) {
+      is_wrap_func = [this, range, &s]() { return is_wrap(range, s); };
+    }
+
+    ledger->record(rewriter_.getSourceMgr(),
+                   rewriter_.getLangOpts(),
+                   range,
+                   EditLedger::EditKind::REPLACE,
+                   this,
+                   rule_name_,
+                   is_wrap_func);
+  }
   return rewriter_.ReplaceText(range, s);
 }
 
@@ -24,20 +44,31 @@ bool StrictRewriter::InsertTextBefore(clang::Stmt* stmt, const std::string& s) {
     return false;
   }
 
-  visited_insert_before_.insert(pointer_to_str(stmt));
-  std::string origin_text = rewriter_.getRewrittenText(find_source_range(stmt));
-  return rewriter_.ReplaceText(find_source_range(stmt), s + origin_text);
+  visited_insert_before_.insert(stmt);
+  clang::SourceRange range = find_source_range(stmt);
+  record_edit(range, EditLedger::EditKind::INSERT_BEFORE);
+  std::string origin_text = rewriter_.getRewrittenText(range);
+  return rewriter_.ReplaceText(range, s + origin_text);
 }
 
 bool StrictRewriter::InsertTextBefore(clang::SourceLocation loc, const std::string& s) {
+  record_insert(loc);
   return rewriter_.InsertTextBefore(loc, s);
 }
 
 bool StrictRewriter::InsertTextAfter(clang::SourceLocation loc, const std::string& s) {
+  record_insert(loc);
   return rewriter_.InsertTextAfter(loc, s);
 }
 
 bool StrictRewriter::InsertTextAfterToken(clang::SourceLocation loc, const std::string& s) {
+  if (loc.isValid()) {
+    const clang::SourceManager& source_manager = rewriter_.getSourceMgr();
+    clang::SourceLocation file_loc = source_manager.getFileLoc(loc);
+    unsigned len = clang::Lexer::MeasureTokenLength(file_loc, source_manager, rewriter_.getLangOpts());
+    record_insert(file_loc.getLocWithOffset(len));
+  }
+
   return rewriter_.InsertTextAfterToken(loc, s);
 }
 
@@ -46,11 +77,12 @@ bool StrictRewriter::RemoveText(clang::Stmt* stmt) {
     return false;
   }
 
-  visited_delete_.insert(pointer_to_str(stmt));
-  return rewriter_.RemoveText(find_source_range(stmt));
+  visited_delete_.insert(stmt);
+  return RemoveText(find_source_range(stmt));
 }
 
 bool StrictRewriter::RemoveText(clang::SourceRange range) {
+  record_edit(range, EditLedger::EditKind::REMOVE);
   return rewriter_.RemoveText(range);
 }
 
@@ -89,6 +121,29 @@ bool StrictRewriter::is_replace_visited(clang::Stmt* stmt) {
   return is_visited(visited_, stmt);
 }
 
+void StrictRewriter::record_edit(clang::SourceRange range, EditLedger::EditKind kind) {
+  EditLedger* ledger = EditLedger::current();
+  if (ledger == nullptr) {
+    return;
+  }
+
+  ledger->record(rewriter_.getSourceMgr(), rewriter_.getLangOpts(), range, kind, this, rule_name_);
+}
+
+void StrictRewriter::record_insert(clang::SourceLocation loc) {
+  EditLedger* ledger = EditLedger::current();
+  if (ledger == nullptr) {
+    return;
+  }
+
+  ledger->record_insert(rewriter_.getSourceMgr(), loc, this, rule_name_);
+}
+
+bool StrictRewriter::is_wrap(clang::SourceRange range, const std::string& s) const {
+  std::string origin_text = rewriter_.getRewrittenText(range);
+  return origin_text.size() > 0 && s.find(origin_text) != std::string::npos;
+}
+
 }  // namespace convert
 }  // namespace ad_algorithm
 }  // namespace ks
@@ -15,6 +15,7 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 
 #include "../Tool.h"
+#include "EditLedger.h"
 #include "LazyReplace.h"
 #include "RewriteAction.h"
 
@@ -25,6 +26,8 @@ namespace ad_algorithm {
 namespace convert {
 
 /// 不能被替换两次，需要严格记录被替换的表达式。
+///
+/// 替换、删除以及插入会同时记录到当前方法的 EditLedger 中，用于检查不同规则之间的冲突。
 class StrictRewriter {
  public:
   explicit StrictRewriter(clang::Rewriter &rewriter): rewriter_(rewriter) {}      // NOLINT
@@ -57,17 +60,24 @@ class StrictRewriter {
   bool is_replace_visited(clang::Stmt* stmt);
 
  private:
-  template<typename T>
-  bool is_visited(const T& v, clang::Stmt* stmt) {
-    return v.find(pointer_to_str(stmt)) != v.end();
+  bool is_visited(const std::unordered_set<const clang::Stmt*>& v, const clang::Stmt* stmt) const {
+    return v.find(stmt) != v.end();
   }
 
+  /// 记录到当前方法的 EditLedger, 不在任何 EditLedgerScope 中时忽略。
+  void record_edit(clang::SourceRange range, EditLedger::EditKind kind);
+  void record_insert(clang::SourceLocation loc);
+
+  /// 替换后的内容包含当前改写后的内容时是 WRAP, 只在 --check-rewrite-conflict 时并且 EditLedger 发现
+  /// 范围完全相同的编辑时调用。
+  bool is_wrap(clang::SourceRange range, const std::string& s) const;
+
  private:
   clang::Rewriter& rewriter_;
   std::string rule_name_;
-  std::unordered_set<std::string> visited_;
-  std::unordered_set<std::string> visited_delete_;
-  std::unordered_set<std::string> visited_insert_before_;
+  std::unordered_set<const clang::Stmt*> visited_;
+  std::unordered_set<const clang::Stmt*> visited_delete_;
+  std::unordered_set<const clang::Stmt*> visited_insert_before_;
   std::vector<LazyReplace> lazy_replaces_;
   std::vector<RewriteAction> rewrite_actions_;
 };
@@ -1,4 +1,3 @@
-#include <regex>
 #include <string>
 #include <sstream>
 #include <absl/strings/str_split.h>
@@ -109,8 +108,8 @@ std::string ActionDetailFixedInfo::get_functor_name(const std::string& field_nam
 
 std::string ActionDetailFixedInfo::get_exists_functor_name(const std::string& field_name) const {
   std::string functor_name = get_functor_name(field_name);
-  static std::regex p("BSGet");
-  return std::regex_replace(functor_name, p, "BSHas");
+  static const tool::TextReplacer replacer({{"BSGet", "BSHas"}});
+  return replacer.replace(functor_name);
 }
 
 std::string ActionDetailFixedInfo::user_template_param(Env* env_ptr,
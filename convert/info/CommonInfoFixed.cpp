@@ -272,8 +272,8 @@ std::string CommonInfoFixed::get_functor_name() const {
 
 std::string CommonInfoFixed::get_exists_functor_name() const {
   std::string functor_name = get_functor_name();
-  static std::regex p("BSGet");
-  return std::regex_replace(functor_name, p, "BSHas");
+  static const tool::TextReplacer replacer({{"BSGet", "BSHas"}});
+  return replacer.replace(functor_name);
 }
 
 // BSFixedCommonInfo<int64_t> BSGetItemAdDspInfoCommonInfoAttr(no);
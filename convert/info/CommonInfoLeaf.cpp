@@ -1,4 +1,3 @@
-#include <regex>
 #include <string>
 
 #include "absl/strings/str_split.h"
@@ -215,8 +214,8 @@ std::string CommonInfoLeaf::get_functor_name() const {
 
 std::string CommonInfoLeaf::get_exists_functor_name() const {
   std::string functor_name = get_functor_name();
-  static std::regex p("BSGet");
-  return std::regex_replace(functor_name, p, "BSHas");
+  static const tool::TextReplacer replacer({{"BSGet", "BSHas"}});
+  return replacer.replace(functor_name);
 }
 
 // BSFixedCommonInfo<int64_t> BSGetItemAdDspInfoCommonInfoAttr(no);
@@ -307,9 +306,9 @@ void CommonInfoLeaf::copy_except_int_value(CommonInfoLeaf* common_info_leaf) {
 }
 
 std::string CommonInfoLeaf::replace_value_key(const std::string& s, int common_info_value) const {
-  std::regex p("key_" + std::to_string(common_info_value) + "([^\\d\\w_])?");
-  std::string text = std::string("key_") + std::to_string(common_info_value_) + "$1";
-  return std::regex_replace(s, p, text);
+  tool::TextReplacer replacer({{"key_" + std::to_string(common_info_value) + "([^\\d\\w_])?",
+                                std::string("key_") + std::to_string(common_info_value_) + "$1"}});
+  return replacer.replace(s);
 }
 
 }  // namespace convert
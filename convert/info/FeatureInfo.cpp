@@ -1,5 +1,4 @@
 #include <absl/types/optional.h>
-#include <regex>
 
 #include "MiddleNodeInfo.h"
 #include "NewVarDef.h"
@@ -29,9 +28,11 @@ void FeatureInfo::add_field_def(const std::string& bs_enum_str,
                                 const std::string& name,
                                 const std::string& new_def,
                                 NewVarType new_var_type,
-                                AdlogVarType adlog_var_type) {
+                                AdlogVarType adlog_var_type,
+                                bool is_in_loop) {
   NewVarDef new_var_def(bs_enum_str, name, new_def, new_var_type, adlog_var_type);
   new_field_defs_.emplace(bs_enum_str, new_var_def);
+  add_field_access(bs_enum_str, new_var_type, is_in_loop);
 }
 
 void FeatureInfo::add_field_def(const std::string& bs_enum_str,
@@ -39,10 +40,12 @@ void FeatureInfo::add_field_def(const std::string& bs_enum_str,
                                 const std::string& new_def,
                                 NewVarType new_var_type,
                                 ExprType expr_type,
-                                AdlogVarType adlog_var_type) {
+                                AdlogVarType adlog_var_type,
+                                bool is_in_loop) {
   NewVarDef new_var_def(bs_enum_str, name, new_def, new_var_type, adlog_var_type);
   new_var_def.set_expr_type(expr_type);
   new_field_defs_.emplace(bs_enum_str, new_var_def);
+  add_field_access(bs_enum_str, new_var_type, is_in_loop);
 }
 
 void FeatureInfo::add_field_def(const std::string& bs_enum_str,
@@ -51,10 +54,26 @@ void FeatureInfo::add_field_def(const std::string& bs_enum_str,
                                 const std::string& exists_name,
                                 const std::string& new_exists_def,
                                 NewVarType new_var_type,
-                                AdlogVarType adlog_var_type) {
+                                AdlogVarType adlog_var_type,
+                                bool is_in_loop) {
   NewVarDef new_var_def(bs_enum_str, name, new_def, new_var_type, adlog_var_type);
   new_var_def.set_exists_var_def(exists_name, new_exists_def);
   new_field_defs_.emplace(bs_enum_str, new_var_def);
+  add_field_access(bs_enum_str, new_var_type, is_in_loop);
+}
+
+void FeatureInfo::add_field_access(const std::string& bs_enum_str,
+                                   absl::optional<NewVarType> new_var_type,
+                                   bool is_in_loop) {
+  auto it = field_accesses_.find(bs_enum_str);
+  if (it == field_accesses_.end()) {
+    it = field_accesses_.emplace(bs_enum_str, FieldAccess(bs_enum_str)).first;
+  }
+
+  if (new_var_type && !it->second.new_var_type()) {
+    it->second.set_new_var_type(*new_var_type);
+  }
+  it->second.set_is_in_loop(is_in_loop);
 }
 
 void FeatureInfo::set_middle_node_info(const std::string& bs_enum_str,
@@ -107,7 +126,8 @@ clang::BinaryOperator* FeatureInfo::find_update_action_stmt() const {
   for (size_t i = 0; i < binary_op_stmts_.size(); i++) {
     std::vector<std::string> arr = absl::StrSplit(stmt_to_string(binary_op_stmts_[i]), "=");
     if (arr.size() == 2) {
-      std::string s = std::regex_replace(arr[0], std::regex(" "), "");
+      static const tool::TextReplacer replacer_space({{" ", ""}});
+      std::string s = replacer_space.replace(arr[0]);
       if (s == *action_) {
         return binary_op_stmts_[i];
       }
@@ -236,7 +256,8 @@ void FeatureInfo::gen_output() {
   {"exists_field_def", json::array()},
   {"is_template", is_template_},
   {"specialization_class_names", json::object()},
-  {"all_field", json::array()}};
+  {"all_field", json::array()},
+  {"field_access", json::array()}};
 
   output_["h_file"] = origin_file_;
   output_["cc_file"] = "";
@@ -288,10 +309,10 @@ void FeatureInfo::gen_output() {
       last["adlog_field_type"] = "normal";
 
       if (field_info.adlog_field_type() == AdlogFieldType::COMMON_INFO) {
-        static std::regex p("key:\\d+$");
+        static const tool::TextReplacer replacer({{"key:\\d+$", ""}});
         if (const auto& enum_name = field_info.common_info_enum_name()) {
           last["adlog_field_with_enum_name"] =
-            std::regex_replace(last["adlog_field"].get<std::string>(), p, *enum_name);
+            replacer.replace(last["adlog_field"].get<std::string>(), *enum_name);
           last["common_info_enum_name"] = *enum_name;
         } else {
           LOG(INFO) << "missing common_info_enum_name, bs_enum_str: " << bs_field_enum;
@@ -352,6 +373,45 @@ void FeatureInfo::gen_output() {
     }
   }
 
+  // 每个 bs 字段的访问方式，线上可以据此在一次扫描样本时提前解码需要的字段。
+  for (auto it = field_accesses_.begin(); it != field_accesses_.end(); it++) {
+    const std::string& bs_enum_str = it->first;
+    FieldAccess field_access = it->second;
+
+    // 只通过 add_attr_meta 访问的字段没有类型，list 可以从 bs_enum_var_type_ 中找到。
+    if (!field_access.new_var_type()) {
+      absl::optional<Symbol> symbol = Symbol::find(bs_enum_str);
+      if (symbol) {
+        auto it_type = bs_enum_var_type_.find(*symbol);
+        if (it_type != bs_enum_var_type_.end()) {
+          field_access.set_new_var_type(it_type->second);
+        }
+      }
+    }
+
+    const NewVarDef* new_var_def = nullptr;
+    auto it_def = new_field_defs_.find(bs_enum_str);
+    if (it_def != new_field_defs_.end()) {
+      new_var_def = &(it_def->second);
+    }
+
+    std::string adlog_field;
+    auto it_field = adlog_field_infos.find(bs_enum_str);
+    if (it_field != adlog_field_infos.end()) {
+      adlog_field = it_field->second.adlog_field();
+    }
+
+    json access = json::object({{"name", bs_enum_str}});
+    if (adlog_field.size() > 0) {
+      access["adlog_field"] = adlog_field;
+    }
+    access["access"] = field_access_kind_name(field_access.kind(new_var_def));
+    access["in_loop"] = field_access.is_in_loop();
+    access["side"] = field_side_name(field_access.side(new_var_def, adlog_field));
+
+    output_["field_access"].push_back(std::move(access));
+  }
+
   // 统一写到 all_field 中，保存 bs_field_enum 和 adlog_field, 中间节点都展开
   for (size_t i = 0; i < output_["normal_field"].size(); i++) {
     output_["all_field"].push_back(output_["normal_field"][i]);
@@ -383,7 +443,7 @@ void FeatureInfo::add_middle_node_bs_enum_var_type(const std::string& middle_nod
   new_var_def.set_new_var_type(new_var_type);
   new_var_def.set_adlog_field(adlog_field);
 
-  middle_node_bs_enum_var_type_.insert({middle_node_bs_enum_str, new_var_def});
+  middle_node_bs_enum_var_type_.insert({Symbol::intern(middle_node_bs_enum_str), new_var_def});
 }
 
 void FeatureInfo::add_middle_node_bs_enum_var_type(const std::string& middle_node_bs_enum_str,
@@ -396,7 +456,21 @@ void FeatureInfo::add_middle_node_bs_enum_var_type(const std::string& middle_nod
   new_var_def.set_adlog_field(adlog_field);
   new_var_def.set_list_inner_type(list_inner_type);
 
-  middle_node_bs_enum_var_type_.insert({middle_node_bs_enum_str, new_var_def});
+  middle_node_bs_enum_var_type_.insert({Symbol::intern(middle_node_bs_enum_str), new_var_def});
+}
+
+const NewVarDef* FeatureInfo::find_middle_node_bs_enum_var_type(const std::string& middle_node_bs_enum_str) const {
+  absl::optional<Symbol> symbol = Symbol::find(middle_node_bs_enum_str);
+  if (!symbol) {
+    return nullptr;
+  }
+
+  auto it = middle_node_bs_enum_var_type_.find(*symbol);
+  if (it != middle_node_bs_enum_var_type_.end()) {
+    return &(it->second);
+  }
+
+  return nullptr;
 }
 
 void FeatureInfo::add_specialization_class(const std::string& name) {
@@ -9,10 +9,12 @@
 #include <vector>
 #include <unordered_map>
 
+#include "../Symbol.h"
 #include "../Type.h"
 #include "CommonInfoMultiIntList.h"
 #include "CommonInfoPrepare.h"
 #include "ConstructorInfo.h"
+#include "FieldAccess.h"
 #include "MethodInfo.h"
 #include "NewVarDef.h"
 #include "clang/AST/AST.h"
@@ -73,24 +75,30 @@ class FeatureInfo {
   void set_file_id(const clang::FileID& file_id) { file_id_ = file_id; }
   const clang::FileID& file_id() const { return file_id_; }
 
+  /// 添加字段定义，同时记录字段的访问方式，见 add_field_access。
+  ///
+  /// is_in_loop 必须由表达式所在的 env 判断，见 Env::add_field_access。
   void add_field_def(const std::string& bs_enum_str,
                      const std::string& name,
                      const std::string& new_def,
                      NewVarType new_var_type,
-                     AdlogVarType adlog_var_type);
+                     AdlogVarType adlog_var_type,
+                     bool is_in_loop);
   void add_field_def(const std::string& bs_enum_str,
                      const std::string& name,
                      const std::string& new_def,
                      NewVarType new_var_type,
                      ExprType expr_type,
-                     AdlogVarType adlog_var_type);
+                     AdlogVarType adlog_var_type,
+                     bool is_in_loop);
   void add_field_def(const std::string& bs_enum_str,
                      const std::string& name,
                      const std::string& new_def,
                      const std::string& exists_name,
                      const std::string& new_exists_def,
                      NewVarType new_var_type,
-                     AdlogVarType adlog_var_type);
+                     AdlogVarType adlog_var_type,
+                     bool is_in_loop);
   const std::unordered_map<std::string, NewVarDef>& new_field_defs() const { return new_field_defs_; }
 
   void set_middle_node_info(const std::string& bs_enum_str,
@@ -103,6 +111,12 @@ class FeatureInfo {
 
   void set_action_var_name(const std::string& bs_enum_str, const std::string& action_var_name);
 
+  /// 记录 bs 字段的访问方式，new_var_type 为空时只记录是否在循环中。
+  void add_field_access(const std::string& bs_enum_str,
+                        absl::optional<NewVarType> new_var_type,
+                        bool is_in_loop);
+  const std::map<std::string, FieldAccess>& field_accesses() const { return field_accesses_; }
+
   /// OverviewHandler 后执行
   void clear_new_field_defs() { new_field_defs_.clear(); }
 
@@ -177,18 +191,23 @@ class FeatureInfo {
   bool has_hash_fn_str() const { return has_hash_fn_str_; }
   void set_has_hash_fn_str(bool v) { has_hash_fn_str_ = v; }
 
-  const std::unordered_map<std::string, NewVarType>& bs_enum_var_type() const { return (bs_enum_var_type_); }
+  const std::unordered_map<Symbol, NewVarType>& bs_enum_var_type() const { return (bs_enum_var_type_); }
   void add_bs_enum_var_type(const std::string& bs_enum_str, NewVarType new_var_type) {
-    bs_enum_var_type_.insert({bs_enum_str, new_var_type});
+    bs_enum_var_type_.insert({Symbol::intern(bs_enum_str), new_var_type});
   }
 
   bool is_in_bs_enum_var_type(const std::string& bs_enum_str) const {
-    return bs_enum_var_type_.find(bs_enum_str) != bs_enum_var_type_.end();
+    absl::optional<Symbol> symbol = Symbol::find(bs_enum_str);
+    return symbol && bs_enum_var_type_.find(*symbol) != bs_enum_var_type_.end();
   }
 
   bool has_cc_file() const { return has_cc_file_; }
   void set_has_cc_file(bool v) { has_cc_file_ = v; }
 
+  /// 是否已经在某个源文件处理结束时写入过结果，写入过的特征在后续源文件中不再处理。
+  bool is_emitted() const { return is_emitted_; }
+  void set_is_emitted(bool v) { is_emitted_ = v; }
+
   bool has_query_token() const { return has_query_token_; }
   void set_has_query_token(bool v) { has_query_token_ = v; }
 
@@ -198,9 +217,8 @@ class FeatureInfo {
   bool has_common_info_multi_map() const {return has_common_info_multi_map_;}
   void set_has_common_info_multi_map(bool v) {has_common_info_multi_map_ = v;}
 
-  const std::unordered_map<std::string, NewVarDef>& middle_node_bs_enum_var_type() const {
-    return (middle_node_bs_enum_var_type_);
-  }
+  /// 不存在则返回 nullptr。
+  const NewVarDef* find_middle_node_bs_enum_var_type(const std::string& middle_node_bs_enum_str) const;
 
   /// scalar
   void add_middle_node_bs_enum_var_type(const std::string& middle_node_bs_enum_str,
@@ -212,7 +230,7 @@ class FeatureInfo {
                                         const std::string& adlog_field,
                                         const std::string& list_inner_type);
   bool is_in_middle_node_bs_enum_var_type(const std::string& middle_node_bs_enum_str) const {
-    return middle_node_bs_enum_var_type_.find(middle_node_bs_enum_str) != middle_node_bs_enum_var_type_.end();
+    return find_middle_node_bs_enum_var_type(middle_node_bs_enum_str) != nullptr;
   }
 
   void add_specialization_class(const std::string& name);
@@ -287,13 +305,17 @@ class FeatureInfo {
 
   // 普通叶子节点的 list 对应的 bs_enum, 不包括 action detail, common info 等。
   // 用于判断 for 循环中的 size method 是否是叶子节点。
-  std::unordered_map<std::string, NewVarType> bs_enum_var_type_;
+  std::unordered_map<Symbol, NewVarType> bs_enum_var_type_;
   // 中间节点的叶子节点 list 或者对应的 bs_enum。不以 adlog 开头。需要保存 adlog_field, type,
   // list_inner_type 等信息。
   // 单独存一个 map 和普通节点区分开。
-  std::unordered_map<std::string, NewVarDef> middle_node_bs_enum_var_type_;
+  std::unordered_map<Symbol, NewVarDef> middle_node_bs_enum_var_type_;
+
+  /// bs 字段的访问方式，按 bs_enum_str 排序，保证输出稳定。
+  std::map<std::string, FieldAccess> field_accesses_;
 
   bool has_cc_file_ = false;
+  bool is_emitted_ = false;
   bool has_query_token_ = false;
   bool has_common_info_multi_int_list_ = false;
   bool has_common_info_multi_map_ = false;
@@ -0,0 +1,83 @@
+#include "../Tool.h"
+#include "FieldAccess.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+const char* field_access_kind_name(FieldAccessKind kind) {
+  switch (kind) {
+    case FieldAccessKind::SINGULAR: return "singular";
+    case FieldAccessKind::REPEATED: return "repeated";
+    case FieldAccessKind::MAP: return "map";
+    case FieldAccessKind::COMMON_INFO_FIXED: return "common_info_fixed";
+    case FieldAccessKind::ACTION_DETAIL: return "action_detail";
+    default: return "unknown";
+  }
+}
+
+const char* field_side_name(FieldSide side) {
+  switch (side) {
+    case FieldSide::USER: return "user";
+    case FieldSide::ITEM: return "item";
+    default: return "other";
+  }
+}
+
+FieldAccessKind FieldAccess::kind(const NewVarDef* new_var_def) const {
+  absl::optional<NewVarType> new_var_type = new_var_type_;
+
+  if (new_var_def != nullptr) {
+    switch (new_var_def->adlog_var_type()) {
+      case AdlogVarType::COMMON_INFO_FIXED:
+        return FieldAccessKind::COMMON_INFO_FIXED;
+      case AdlogVarType::ACTION_DETAIL_FIELD:
+      case AdlogVarType::ACTION_DETAIL_FIXED:
+        return FieldAccessKind::ACTION_DETAIL;
+      default:
+        break;
+    }
+
+    if (!new_var_type) {
+      new_var_type = new_var_def->new_var_type();
+    }
+  }
+
+  if (!new_var_type) {
+    return FieldAccessKind::SINGULAR;
+  }
+
+  switch (*new_var_type) {
+    case NewVarType::LIST: return FieldAccessKind::REPEATED;
+    case NewVarType::MAP: return FieldAccessKind::MAP;
+    default: return FieldAccessKind::SINGULAR;
+  }
+}
+
+FieldSide FieldAccess::side(const NewVarDef* new_var_def, const std::string& adlog_field) const {
+  // 中间节点都来自 item, 如 photo_info、live_info。
+  if (new_var_def != nullptr && new_var_def->middle_node_root()) {
+    return FieldSide::ITEM;
+  }
+
+  std::string s = adlog_field.size() > 0 ? tool::adlog_to_bs_enum_str(adlog_field) : bs_enum_str_;
+  if (new_var_def != nullptr) {
+    if (const auto& common_info_prefix_adlog = new_var_def->common_info_prefix_adlog()) {
+      s = tool::adlog_to_bs_enum_str(*common_info_prefix_adlog);
+    }
+  }
+
+  if (tool::is_item_field(s)) {
+    return FieldSide::ITEM;
+  }
+
+  if (tool::is_adlog_user_field(s) || tool::is_reco_user_field(s)) {
+    return FieldSide::USER;
+  }
+
+  return FieldSide::OTHER;
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
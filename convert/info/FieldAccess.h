@@ -0,0 +1,63 @@
+#pragma once
+
+#include <absl/types/optional.h>
+#include <string>
+
+#include "NewVarDef.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// bs 字段的访问方式。
+enum class FieldAccessKind {
+  SINGULAR,
+  REPEATED,
+  MAP,
+  COMMON_INFO_FIXED,
+  ACTION_DETAIL
+};
+
+/// bs 字段属于 user 侧还是 item 侧, 其他如 context、llsid 等都是 OTHER。
+enum class FieldSide {
+  USER,
+  ITEM,
+  OTHER
+};
+
+const char* field_access_kind_name(FieldAccessKind kind);
+const char* field_side_name(FieldSide side);
+
+/// 特征中每个 bs 字段的访问信息, 写到 field detail json 的 field_access 中。
+///
+/// 线上可以根据特征集合中所有特征的 field_access, 在一次扫描样本时提前解码需要的字段,
+/// 而不是每次访问时再去查找。
+class FieldAccess {
+ public:
+  FieldAccess() = default;
+  explicit FieldAccess(const std::string& bs_enum_str): bs_enum_str_(bs_enum_str) {}
+
+  const std::string& bs_enum_str() const { return bs_enum_str_; }
+
+  const absl::optional<NewVarType>& new_var_type() const { return (new_var_type_); }
+  void set_new_var_type(NewVarType new_var_type) { new_var_type_.emplace(new_var_type); }
+
+  /// 只要有一次访问在循环中就是 true。
+  bool is_in_loop() const { return is_in_loop_; }
+  void set_is_in_loop(bool v) { is_in_loop_ = is_in_loop_ || v; }
+
+  /// new_var_def 是 field_def 中对应的定义, 可能为 nullptr。
+  FieldAccessKind kind(const NewVarDef* new_var_def) const;
+
+  /// adlog_field 为空时根据 bs_enum_str 判断。
+  FieldSide side(const NewVarDef* new_var_def, const std::string& adlog_field) const;
+
+ private:
+  std::string bs_enum_str_;
+  absl::optional<NewVarType> new_var_type_;
+  bool is_in_loop_ = false;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
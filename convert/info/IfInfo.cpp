@@ -32,7 +32,7 @@ bool IfInfo::is_body_only_break() const {
   }
 
   std::string body_text = tool::rm_surround_big_parantheses(stmt_to_string(if_stmt_->getThen()));
-  std::regex p("[ \\n]*break;[ \\n]*");
+  static const std::regex p("[ \\n]*break;[ \\n]*");
   if (std::regex_match(body_text, p)) {
     return true;
   }
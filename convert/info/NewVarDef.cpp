@@ -1,5 +1,4 @@
 #include <string>
-#include <regex>
 #include <algorithm>
 
 #include <glog/logging.h>
@@ -7,6 +6,7 @@
 #include <absl/strings/str_split.h>
 #include <absl/strings/str_join.h>
 
+#include "../TextReplacer.h"
 #include "NewVarDef.h"
 
 namespace ks {
@@ -15,9 +15,9 @@ namespace convert {
 
 void NewVarDef::set_name(const std::string& name) {
   if (name != name_) {
-    std::regex p_name(std::string(" ") + name_ + " ");
     if (var_def_.size() > 0) {
-      var_def_ = std::regex_replace(var_def_, p_name, std::string( " ") + name + std::string(" "));
+      tool::TextReplacer replacer({{std::string(" ") + name_ + " ", std::string(" ") + name + " "}});
+      var_def_ = replacer.replace(var_def_);
     }
 
     name_ = name;
@@ -36,6 +36,12 @@ void BSFeatureDeclCallback::run(const clang::ast_matchers::MatchFinder::MatchRes
       return;
     }
 
+    if (feature_info_ptr->is_emitted()) {
+      LOG(INFO) << "already converted in other file, skip, feature_name: " << feature_name;
+      return;
+    }
+    config->cur_file_features.insert(feature_name);
+
     std::string origin_file = Result.SourceManager->getFilename(cxx_record_decl->getBeginLoc()).str();
 
     feature_info_ptr->set_feature_name(feature_name);
@@ -51,7 +57,7 @@ void BSFeatureDeclCallback::run(const clang::ast_matchers::MatchFinder::MatchRes
               << ", origin_file: " << origin_file;
 
     if (feature_info_ptr->has_cc_file()) {
-      std::string cc_filename = std::regex_replace(origin_file, std::regex("\\.h"), ".cc");
+      std::string cc_filename = tool::get_cc_filename(origin_file);
       feature_info_ptr->set_cc_filename(cc_filename);
     }
 
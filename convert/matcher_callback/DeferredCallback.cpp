@@ -0,0 +1,21 @@
+#include "DeferredCallback.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+void DeferredCallback::run(const clang::ast_matchers::MatchFinder::MatchResult &Result) {
+  results_.push_back(Result);
+}
+
+void DeferredCallback::flush() {
+  for (const auto& result : results_) {
+    callback_->run(result);
+  }
+
+  results_.clear();
+}
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
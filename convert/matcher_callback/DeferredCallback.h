@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+
+/// 延迟执行的 MatchCallback。
+///
+/// 多个 matcher 放在同一个 `MatchFinder` 中只需要遍历一次 ast, 但是各个 callback 的执行顺序就由节点在 ast
+/// 中的位置决定了。对于有依赖关系的 callback, 如 `FeatureDeclCallback` 依赖 `TypeAliasCallback` 解析出的
+/// 模板参数，遍历时只保存匹配结果，遍历结束后再调用 `flush` 按顺序执行。
+class DeferredCallback : public clang::ast_matchers::MatchFinder::MatchCallback {
+ public:
+  explicit DeferredCallback(clang::ast_matchers::MatchFinder::MatchCallback* callback): callback_(callback) {}
+
+  void run(const clang::ast_matchers::MatchFinder::MatchResult &Result) override;
+
+  /// 按匹配顺序执行所有保存的结果，执行完后清空。
+  void flush();
+
+ private:
+  clang::ast_matchers::MatchFinder::MatchCallback* callback_ = nullptr;
+  std::vector<clang::ast_matchers::MatchFinder::MatchResult> results_;
+};
+
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
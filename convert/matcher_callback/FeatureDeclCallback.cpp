@@ -7,6 +7,7 @@
 
 #include "../Tool.h"
 #include "../Config.h"
+#include "../ConvertCache.h"
 #include "../info/FeatureInfo.h"
 #include "../visitor/CtorVisitor.h"
 #include "../visitor/FieldDeclVisitor.h"
@@ -37,6 +38,24 @@ void FeatureDeclCallback::run(const clang::ast_matchers::MatchFinder::MatchResul
       return;
     }
 
+    if (feature_info_ptr->is_emitted()) {
+      LOG(INFO) << "already converted in other file, skip, feature_name: " << feature_name;
+      return;
+    }
+
+    // 类所在头文件及其依赖都没有变化时不需要再改写，字段信息从缓存中获取。
+    const clang::SourceManager& source_manager = *Result.SourceManager;
+    const clang::FileEntry* main_file = source_manager.getFileEntryForID(source_manager.getMainFileID());
+    if (main_file != nullptr &&
+        ConvertCache::Instance()->use_cached_feature(
+          feature_name, ConvertCache::to_absolute_path(main_file->getName().str()))) {
+      LOG(INFO) << "feature is up to date, use cache, feature_name: " << feature_name;
+      config->cur_file_cached_features.insert(feature_name);
+      return;
+    }
+
+    config->cur_file_features.insert(feature_name);
+
     LOG(INFO) << "find class, start process, feature_name: " << feature_name
               << ", is_template: " << cxx_record_decl->isTemplated()
               << ", template_common_info_int_values: "
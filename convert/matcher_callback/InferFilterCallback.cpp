@@ -31,6 +31,12 @@ void InferFilterCallback::run(const clang::ast_matchers::MatchFinder::MatchResul
       return;
     }
 
+    if (feature_info_ptr->is_emitted()) {
+      LOG(INFO) << "already converted in other file, skip, feature_name: " << feature_name;
+      return;
+    }
+    config->cur_file_features.insert(feature_name);
+
     LOG(INFO) << "find class, start process, feature_name: " << feature_name
               << ", is_template: " << cxx_record_decl->isTemplated()
               << ", template_common_info_int_values: "
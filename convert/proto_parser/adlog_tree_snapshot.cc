@@ -0,0 +1,506 @@
+#include <glog/logging.h>               // NOLINT
+#include <google/protobuf/descriptor.pb.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./adlog_tree_snapshot.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace proto_parser {
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'A', 'D', 'L', 'O', 'G', 'T', 'R', 'E'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+constexpr uint32_t kNodeFlagEnum = 1u << 0;
+constexpr uint32_t kNodeFlagCommonInfoList = 1u << 1;
+constexpr uint32_t kNodeFlagCommonInfoMap = 1u << 2;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t node_count;
+  uint64_t fingerprint;
+  uint32_t edge_count;
+  uint32_t action_type_count;
+  uint32_t string_table_size;
+  uint32_t reserved;
+};
+
+/// 字符串都是 strings 中的偏移。
+struct SnapshotNode {
+  uint32_t name;
+  uint32_t type_str;
+  uint32_t comment;
+  int32_t index;
+  uint32_t flags;
+  uint32_t first_edge;
+  uint32_t edge_count;
+  uint32_t first_action_type;
+  uint32_t action_type_count;
+};
+
+struct SnapshotEdge {
+  uint32_t key;
+  uint32_t node;
+  uint32_t is_alias;
+};
+
+struct SnapshotActionType {
+  uint32_t field_name;
+  uint32_t type_str;
+};
+
+static_assert(std::is_trivially_copyable<SnapshotHeader>::value, "SnapshotHeader must be pod");
+static_assert(std::is_trivially_copyable<SnapshotNode>::value, "SnapshotNode must be pod");
+static_assert(std::is_trivially_copyable<SnapshotEdge>::value, "SnapshotEdge must be pod");
+static_assert(std::is_trivially_copyable<SnapshotActionType>::value, "SnapshotActionType must be pod");
+
+uint64_t fnv1a(uint64_t h, const std::string& s) {
+  for (size_t i = 0; i < s.size(); i++) {
+    h ^= static_cast<unsigned char>(s[i]);
+    h *= 1099511628211ULL;
+  }
+
+  return h;
+}
+
+void collect_files(const google::protobuf::FileDescriptor* file,
+                   std::unordered_set<const google::protobuf::FileDescriptor*>* visited,
+                   std::vector<const google::protobuf::FileDescriptor*>* files) {
+  if (file == nullptr || !visited->insert(file).second) {
+    return;
+  }
+
+  for (int i = 0; i < file->dependency_count(); i++) {
+    collect_files(file->dependency(i), visited, files);
+  }
+
+  files->push_back(file);
+}
+
+}  // namespace
+
+/// 将 AdlogNode 树按先序展开。
+class AdlogTreeSnapshot::Writer {
+ public:
+  void add_tree(const AdlogNode& root) { add_node(root); }
+
+  bool write(const std::string& filename, uint64_t fingerprint) const;
+
+ private:
+  uint32_t add_string(const std::string& s);
+  uint32_t add_node(const AdlogNode& node);
+
+ private:
+  std::vector<SnapshotNode> nodes_;
+  std::vector<SnapshotEdge> edges_;
+  std::vector<SnapshotActionType> action_types_;
+  std::string strings_;
+  std::unordered_map<std::string, uint32_t> string_offsets_;
+};
+
+uint32_t AdlogTreeSnapshot::Writer::add_string(const std::string& s) {
+  auto it = string_offsets_.find(s);
+  if (it != string_offsets_.end()) {
+    return it->second;
+  }
+
+  uint32_t offset = static_cast<uint32_t>(strings_.size());
+  uint32_t len = static_cast<uint32_t>(s.size());
+  strings_.append(reinterpret_cast<const char*>(&len), sizeof(len));
+  strings_.append(s);
+  string_offsets_[s] = offset;
+
+  return offset;
+}
+
+uint32_t AdlogTreeSnapshot::Writer::add_node(const AdlogNode& node) {
+  uint32_t id = static_cast<uint32_t>(nodes_.size());
+  nodes_.emplace_back();
+
+  SnapshotNode snapshot_node;
+  snapshot_node.name = add_string(node.name_);
+  snapshot_node.type_str = add_string(node.type_str_);
+  snapshot_node.comment = add_string(node.comment_);
+  snapshot_node.index = node.index_;
+  snapshot_node.flags = (node.is_enum_ ? kNodeFlagEnum : 0) |
+                        (node.is_common_info_list_ ? kNodeFlagCommonInfoList : 0) |
+                        (node.is_common_info_map_ ? kNodeFlagCommonInfoMap : 0);
+
+  std::vector<std::pair<std::string, const AdlogNode*>> children;
+  for (auto it = node.children_.begin(); it != node.children_.end(); it++) {
+    children.emplace_back(it->first, it->second.get());
+  }
+  std::sort(children.begin(), children.end());
+
+  // 子节点先展开，之后才知道其 id。
+  std::unordered_map<const AdlogNode*, uint32_t> child_ids;
+  for (size_t i = 0; i < children.size(); i++) {
+    child_ids[children[i].second] = add_node(*children[i].second);
+  }
+
+  std::vector<std::pair<std::string, SnapshotEdge>> edges;
+  for (size_t i = 0; i < children.size(); i++) {
+    edges.emplace_back(children[i].first,
+                       SnapshotEdge{add_string(children[i].first), child_ids[children[i].second], 0});
+  }
+
+  for (auto it = node.child_aliases_.begin(); it != node.child_aliases_.end(); it++) {
+    auto it_index = node.child_index_.find(*it);
+    if (it_index == node.child_index_.end() || child_ids.find(it_index->second) == child_ids.end()) {
+      LOG(ERROR) << "cannot find alias child, alias: " << *it << ", node: " << node.name_;
+      continue;
+    }
+
+    edges.emplace_back(*it, SnapshotEdge{add_string(*it), child_ids[it_index->second], 1});
+  }
+
+  std::sort(edges.begin(), edges.end(),
+            [](const std::pair<std::string, SnapshotEdge>& a, const std::pair<std::string, SnapshotEdge>& b) {
+              return a.first < b.first;
+            });
+
+  snapshot_node.first_edge = static_cast<uint32_t>(edges_.size());
+  snapshot_node.edge_count = static_cast<uint32_t>(edges.size());
+  for (size_t i = 0; i < edges.size(); i++) {
+    edges_.push_back(edges[i].second);
+  }
+
+  std::vector<std::pair<std::string, std::string>> action_types(node.action_detail_field_types_.begin(),
+                                                                node.action_detail_field_types_.end());
+  std::sort(action_types.begin(), action_types.end());
+
+  snapshot_node.first_action_type = static_cast<uint32_t>(action_types_.size());
+  snapshot_node.action_type_count = static_cast<uint32_t>(action_types.size());
+  for (size_t i = 0; i < action_types.size(); i++) {
+    action_types_.push_back(SnapshotActionType{add_string(action_types[i].first),
+                                               add_string(action_types[i].second)});
+  }
+
+  nodes_[id] = snapshot_node;
+
+  return id;
+}
+
+bool AdlogTreeSnapshot::Writer::write(const std::string& filename, uint64_t fingerprint) const {
+  SnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+  header.version = kSnapshotVersion;
+  header.node_count = static_cast<uint32_t>(nodes_.size());
+  header.fingerprint = fingerprint;
+  header.edge_count = static_cast<uint32_t>(edges_.size());
+  header.action_type_count = static_cast<uint32_t>(action_types_.size());
+  header.string_table_size = static_cast<uint32_t>(strings_.size());
+
+  std::string tmp_filename = filename + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream ofs(tmp_filename, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+      LOG(ERROR) << "open snapshot file failed: " << tmp_filename;
+      return false;
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(nodes_.data()), nodes_.size() * sizeof(SnapshotNode));
+    ofs.write(reinterpret_cast<const char*>(edges_.data()), edges_.size() * sizeof(SnapshotEdge));
+    ofs.write(reinterpret_cast<const char*>(action_types_.data()),
+              action_types_.size() * sizeof(SnapshotActionType));
+    ofs.write(strings_.data(), strings_.size());
+
+    if (!ofs) {
+      LOG(ERROR) << "write snapshot file failed: " << tmp_filename;
+      std::remove(tmp_filename.c_str());
+      return false;
+    }
+  }
+
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    LOG(ERROR) << "rename snapshot file failed: " << tmp_filename << " -> " << filename;
+    std::remove(tmp_filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+
+/// 只读 mmap 的文件，析构时 munmap。
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data_ = static_cast<const char*>(addr);
+        size_ = static_cast<size_t>(st.st_size);
+      }
+    }
+
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace
+
+/// 访问 mmap 的快照，所有偏移都会检查是否越界。
+class AdlogTreeSnapshot::Reader {
+ public:
+  Reader(const char* data, size_t size): data_(data), size_(size) {}
+
+  bool init(uint64_t fingerprint);
+
+  std::unique_ptr<AdlogNode> build_tree() const;
+
+ private:
+  absl::optional<std::string> get_string(uint32_t offset) const;
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+
+  SnapshotHeader header_;
+  const SnapshotNode* nodes_ = nullptr;
+  const SnapshotEdge* edges_ = nullptr;
+  const SnapshotActionType* action_types_ = nullptr;
+  const char* strings_ = nullptr;
+};
+
+bool AdlogTreeSnapshot::Reader::init(uint64_t fingerprint) {
+  if (size_ < sizeof(SnapshotHeader)) {
+    LOG(ERROR) << "snapshot file is too small, size: " << size_;
+    return false;
+  }
+
+  std::memcpy(&header_, data_, sizeof(header_));
+  if (std::memcmp(header_.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0) {
+    LOG(ERROR) << "wrong snapshot magic";
+    return false;
+  }
+
+  if (header_.version != kSnapshotVersion) {
+    LOG(INFO) << "snapshot version changed, snapshot version: " << header_.version
+              << ", current version: " << kSnapshotVersion;
+    return false;
+  }
+
+  if (header_.fingerprint != fingerprint) {
+    LOG(INFO) << "proto changed, snapshot fingerprint: " << header_.fingerprint
+              << ", current fingerprint: " << fingerprint;
+    return false;
+  }
+
+  size_t expected_size = sizeof(SnapshotHeader) +
+                         static_cast<size_t>(header_.node_count) * sizeof(SnapshotNode) +
+                         static_cast<size_t>(header_.edge_count) * sizeof(SnapshotEdge) +
+                         static_cast<size_t>(header_.action_type_count) * sizeof(SnapshotActionType) +
+                         header_.string_table_size;
+  if (header_.node_count == 0 || expected_size != size_) {
+    LOG(ERROR) << "wrong snapshot size, expected: " << expected_size << ", actual: " << size_;
+    return false;
+  }
+
+  const char* p = data_ + sizeof(SnapshotHeader);
+  nodes_ = reinterpret_cast<const SnapshotNode*>(p);
+  p += header_.node_count * sizeof(SnapshotNode);
+  edges_ = reinterpret_cast<const SnapshotEdge*>(p);
+  p += header_.edge_count * sizeof(SnapshotEdge);
+  action_types_ = reinterpret_cast<const SnapshotActionType*>(p);
+  p += header_.action_type_count * sizeof(SnapshotActionType);
+  strings_ = p;
+
+  return true;
+}
+
+absl::optional<std::string> AdlogTreeSnapshot::Reader::get_string(uint32_t offset) const {
+  if (static_cast<size_t>(offset) + sizeof(uint32_t) > header_.string_table_size) {
+    return absl::nullopt;
+  }
+
+  uint32_t len = 0;
+  std::memcpy(&len, strings_ + offset, sizeof(len));
+  if (static_cast<size_t>(offset) + sizeof(uint32_t) + len > header_.string_table_size) {
+    return absl::nullopt;
+  }
+
+  return absl::make_optional<std::string>(strings_ + offset + sizeof(uint32_t), len);
+}
+
+std::unique_ptr<AdlogNode> AdlogTreeSnapshot::Reader::build_tree() const {
+  std::vector<std::unique_ptr<AdlogNode>> nodes(header_.node_count);
+  std::vector<AdlogNode*> node_ptrs(header_.node_count, nullptr);
+
+  for (uint32_t i = 0; i < header_.node_count; i++) {
+    const SnapshotNode& snapshot_node = nodes_[i];
+
+    absl::optional<std::string> name = get_string(snapshot_node.name);
+    absl::optional<std::string> type_str = get_string(snapshot_node.type_str);
+    absl::optional<std::string> comment = get_string(snapshot_node.comment);
+    if (!name || !type_str || !comment) {
+      LOG(ERROR) << "wrong string offset in snapshot, node: " << i;
+      return nullptr;
+    }
+
+    nodes[i] = std::make_unique<AdlogNode>(*name, *type_str, snapshot_node.index);
+    node_ptrs[i] = nodes[i].get();
+
+    AdlogNode* node = node_ptrs[i];
+    node->comment_ = *comment;
+    node->is_enum_ = (snapshot_node.flags & kNodeFlagEnum) != 0;
+    node->is_common_info_list_ = (snapshot_node.flags & kNodeFlagCommonInfoList) != 0;
+    node->is_common_info_map_ = (snapshot_node.flags & kNodeFlagCommonInfoMap) != 0;
+
+    if (static_cast<size_t>(snapshot_node.first_action_type) + snapshot_node.action_type_count >
+        header_.action_type_count) {
+      LOG(ERROR) << "wrong action type range in snapshot, node: " << i;
+      return nullptr;
+    }
+
+    for (uint32_t j = 0; j < snapshot_node.action_type_count; j++) {
+      const SnapshotActionType& action_type = action_types_[snapshot_node.first_action_type + j];
+      absl::optional<std::string> field_name = get_string(action_type.field_name);
+      absl::optional<std::string> field_type_str = get_string(action_type.type_str);
+      if (!field_name || !field_type_str) {
+        LOG(ERROR) << "wrong string offset in snapshot, node: " << i;
+        return nullptr;
+      }
+
+      node->insert_action_detail_field_type(*field_name, *field_type_str);
+    }
+  }
+
+  // 子节点的 id 一定大于父节点，先挂上拥有的子节点，再添加别名。
+  std::vector<std::string> owner_keys(header_.node_count);
+  for (uint32_t i = 0; i < header_.node_count; i++) {
+    const SnapshotNode& snapshot_node = nodes_[i];
+    if (static_cast<size_t>(snapshot_node.first_edge) + snapshot_node.edge_count > header_.edge_count) {
+      LOG(ERROR) << "wrong edge range in snapshot, node: " << i;
+      return nullptr;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+      for (uint32_t j = 0; j < snapshot_node.edge_count; j++) {
+        const SnapshotEdge& edge = edges_[snapshot_node.first_edge + j];
+        if ((edge.is_alias != 0) != (pass == 1)) {
+          continue;
+        }
+
+        absl::optional<std::string> key = get_string(edge.key);
+        if (!key || edge.node <= i || edge.node >= header_.node_count) {
+          LOG(ERROR) << "wrong edge in snapshot, node: " << i;
+          return nullptr;
+        }
+
+        if (edge.is_alias != 0) {
+          if (node_ptrs[edge.node]->parent() != node_ptrs[i]) {
+            LOG(ERROR) << "alias must point to child in snapshot, node: " << i << ", alias: " << *key;
+            return nullptr;
+          }
+
+          node_ptrs[i]->add_child_alias(*key, owner_keys[edge.node]);
+        } else {
+          if (nodes[edge.node] == nullptr) {
+            LOG(ERROR) << "node has more than one parent in snapshot, node: " << edge.node;
+            return nullptr;
+          }
+
+          owner_keys[edge.node] = *key;
+          node_ptrs[i]->add_child(*key, std::move(nodes[edge.node]));
+        }
+      }
+    }
+  }
+
+  return std::move(nodes[0]);
+}
+
+uint64_t AdlogTreeSnapshot::fingerprint(const google::protobuf::Descriptor* descriptor) {
+  if (descriptor == nullptr) {
+    return 0;
+  }
+
+  std::unordered_set<const google::protobuf::FileDescriptor*> visited;
+  std::vector<const google::protobuf::FileDescriptor*> files;
+  collect_files(descriptor->file(), &visited, &files);
+
+  uint64_t h = 14695981039346656037ULL;
+  h = fnv1a(h, descriptor->full_name());
+
+  for (size_t i = 0; i < files.size(); i++) {
+    google::protobuf::FileDescriptorProto file_proto;
+    files[i]->CopyTo(&file_proto);
+
+    std::string content;
+    file_proto.SerializeToString(&content);
+
+    h = fnv1a(h, files[i]->name());
+    h = fnv1a(h, content);
+  }
+
+  return h;
+}
+
+std::unique_ptr<AdlogNode> AdlogTreeSnapshot::load(const std::string& filename, uint64_t fingerprint) {
+  MappedFile file(filename);
+  if (file.data() == nullptr) {
+    LOG(INFO) << "cannot open snapshot file: " << filename;
+    return nullptr;
+  }
+
+  Reader reader(file.data(), file.size());
+  if (!reader.init(fingerprint)) {
+    return nullptr;
+  }
+
+  return reader.build_tree();
+}
+
+bool AdlogTreeSnapshot::save(const std::string& filename, uint64_t fingerprint, const AdlogNode& root) {
+  Writer writer;
+  writer.add_tree(root);
+
+  return writer.write(filename, fingerprint);
+}
+
+}  // namespace proto_parser
+}  // namespace ad_algorithm
+}  // namespace ks
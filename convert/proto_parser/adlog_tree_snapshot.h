@@ -0,0 +1,53 @@
+#pragma once
+
+#include <google/protobuf/descriptor.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "./proto_node.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace proto_parser {
+
+/// adlog proto 树的二进制快照。
+///
+/// 通过反射建树需要遍历 AdJointLabeledLog 的所有 descriptor, 线上的 proto 中 CommonInfo 枚举很多，
+/// 每次启动都要花不少时间。proto 不变时可以直接从快照恢复，proto 变化后 fingerprint 不同，快照失效，
+/// 重新通过反射建树并覆盖快照。通过 --adlog_tree_snapshot 指定快照文件。
+///
+/// 查找都是通过 AdlogNode 指针进行的，因此 load 时仍然会在堆上重建所有 AdlogNode, 省掉的是遍历
+/// descriptor 和拼接类型、路径字符串的开销，并不是零拷贝的直接访问。
+///
+/// 文件格式如下，按本机字节序保存，所有的数组都是连续的定长结构，读取时 mmap 整个文件并检查越界:
+///
+///   header | nodes | edges | action_types | strings
+///
+/// 1. header: magic、格式版本、fingerprint 以及后面各部分的长度。
+/// 2. nodes: 按先序遍历保存，0 是根节点，父节点一定在子节点之前。每个节点的子节点是 edges 中连续的一段。
+/// 3. edges: 每个节点的子节点按名字排序，别名 (如枚举的 int 值) 也是一条边，指向同一个节点。
+/// 4. action_types: ActionDetail 节点的字段类型。
+/// 5. strings: 字符串表，每个字符串只保存一次，格式是 4 字节长度加上内容，其他部分通过偏移引用。
+///
+/// 建树逻辑变化时需要修改 snapshot 格式版本，使旧的快照失效。
+class AdlogTreeSnapshot {
+ public:
+  /// descriptor 所在的 proto 文件及其依赖的所有文件内容的 hash。
+  static uint64_t fingerprint(const google::protobuf::Descriptor* descriptor);
+
+  /// 文件不存在、格式错误或者 fingerprint 不一致时返回 nullptr。
+  static std::unique_ptr<AdlogNode> load(const std::string& filename, uint64_t fingerprint);
+
+  /// 先写临时文件再 rename, 多个进程同时写不会读到写了一半的快照。
+  static bool save(const std::string& filename, uint64_t fingerprint, const AdlogNode& root);
+
+ private:
+  class Writer;
+  class Reader;
+};
+
+}  // namespace proto_parser
+}  // namespace ad_algorithm
+}  // namespace ks
@@ -1,7 +1,6 @@
 #include <glog/logging.h>               // NOLINT
-#include <absl/strings/str_join.h>
-#include <absl/strings/str_split.h>
 #include <absl/strings/match.h>
+#include <absl/strings/string_view.h>
 #include <absl/types/optional.h>
 #include <sstream>
 #include <string>
@@ -45,8 +44,24 @@ void AdlogNode::set_parent(const AdlogNode* parent) {
   parent_ = parent;
 }
 
+void AdlogNode::add_child_alias(const std::string& alias, const std::string& child_name) {
+  if (child_index_.find(alias) != child_index_.end()) {
+    return;
+  }
+
+  auto it = child_index_.find(child_name);
+  if (it == child_index_.end()) {
+    LOG(ERROR) << "cannot find child: " << child_name << ", alias: " << alias << ", node: " << name_;
+    return;
+  }
+
+  const AdlogNode* child = it->second;
+  auto res = child_aliases_.insert(alias);
+  child_index_[absl::string_view(*res.first)] = child;
+}
+
 bool AdlogNode::has_child(const std::string& child_name) const {
-  return children_.find(child_name) != children_.end();
+  return child_index_.find(child_name) != child_index_.end();
 }
 
 std::string AdlogNode::get_adlog_path() const {
@@ -130,7 +145,7 @@ std::string AdlogNode::get_bslog_path(int key) const {
 absl::optional<int> AdlogNode::get_int_value_from_path(const std::string& bs_enum_str) const {
   // 注意: 只能包含一组 key:int, 如果有多个会有问题。
   // 目前 CommonInfo, ActionDetail, LabelAttr 都是一组 key:int。
-  std::regex p("^key[_:](\\d+)([_\\.]key|[_\\.]value)?");
+  static const std::regex p("^key[_:](\\d+)([_\\.]key|[_\\.]value)?");
   std::smatch m;
   if (std::regex_search(bs_enum_str, m, p)) {
     if (m.size() > 1) {
@@ -180,7 +195,7 @@ void AdlogNode::find_middle_node_root(const std::string& middle_node_root,
   }
 }
 
-bool AdlogNode::is_str_all_uppercase(const std::string& s) const {
+bool AdlogNode::is_str_all_uppercase(absl::string_view s) const {
   if (s.size() == 0) {
     return false;
   }
@@ -202,21 +217,18 @@ bool AdlogNode::is_str_all_uppercase(const std::string& s) const {
 // 另一种是中间的 ActionDetail map, 如 adlog.user_info.ad_dsp_action_detail.key:3.list.photo_id。
 //
 // 可以按如下逻辑进行处理:
-// 1. 按冒号拆分 adlog_field_str。
-// 2. 判断拆分后的最后一个 str 是否是类型，所有的类型可以提前列举出来。
-// 3. 如果最后一个 str 是类型，则将之前的 str 作为 find_proto_node_helper 的参数，否则将 adlog_field_str
-//    整体作为 find_proto_node_helper 的参数。
+// 1. 找到最后一个冒号。
+// 2. 判断冒号之后的 str 是否是类型，所有的类型可以提前列举出来。
+// 3. 如果是类型，则将冒号之前的 str 作为 find_proto_path_detail_view 的参数，否则将 adlog_field_str
+//    整体作为 find_proto_path_detail_view 的参数。
+//
+// 结果按 adlog_field_str 缓存，CommonInfo 新建的 enum_node 也保存在缓存中，find_proto_node 返回的指针一直有效。
 const AdlogNode* AdlogNode::find_proto_node(const std::string& adlog_field_str) const {
-  std::vector<std::string> arr = absl::StrSplit(adlog_field_str, ":");
-  if (arr.size() == 0) {
-    return nullptr;
-  }
-
-  if (is_unified_type_str(arr[arr.size() - 1])) {
-    return find_proto_node_helper(absl::StrJoin(arr.begin(), arr.end() - 1, ":"));
-  } else {
-    return find_proto_node_helper(adlog_field_str);
+  auto adlog_path_detail = find_proto_path_detail(adlog_field_str);
+  if (adlog_path_detail) {
+    return adlog_path_detail->adlog_node;
   }
+  return nullptr;
 }
 
 const AdlogNode* AdlogNode::find_proto_node_helper(const std::string& adlog_field_str) const {
@@ -229,24 +241,63 @@ const AdlogNode* AdlogNode::find_proto_node_helper(const std::string& adlog_fiel
 
 absl::optional<AdlogPathDetail>
 AdlogNode::find_proto_path_detail(const std::string& adlog_field_str) const {
-  std::vector<std::string> arr = absl::StrSplit(adlog_field_str, ":");
-  if (arr.size() == 0) {
-    return absl::nullopt;
-  }
-
-  if (is_unified_type_str(arr.back())) {
-    auto res = find_proto_path_detail_helper(absl::StrJoin(arr.begin(), arr.end() - 1, ":"));
-    if (res.has_value()) {
-      res->type_str = arr.back();
+  return ProtoParser::instance().find_path_detail_memo(this, adlog_field_str, [this, &adlog_field_str]() {
+    absl::optional<AdlogPathDetail> res;
+
+    absl::string_view path(adlog_field_str);
+    size_t pos = path.rfind(':');
+    if (pos != absl::string_view::npos && is_unified_type_str(std::string(path.substr(pos + 1)))) {
+      res = find_proto_path_detail_view(path.substr(0, pos));
+      if (res.has_value()) {
+        res->type_str = std::string(path.substr(pos + 1));
+      }
+    } else {
+      res = find_proto_path_detail_view(path);
     }
+
     return res;
-  } else {
-    return find_proto_path_detail_helper(adlog_field_str);
-  }
+  });
 }
 
 absl::optional<AdlogPathDetail>
 AdlogNode::find_proto_path_detail_helper(const std::string& adlog_field_str) const {
+  return find_proto_path_detail_view(adlog_field_str);
+}
+
+namespace {
+
+// 去掉所有的 key:xxx., 如 ad_dsp_action_detail.key:3.list.photo_id 变为 ad_dsp_action_detail.list.photo_id。
+std::string remove_action_key(absl::string_view s) {
+  static const absl::string_view prefix = "key:";
+
+  std::string res;
+  res.reserve(s.size());
+
+  size_t i = 0;
+  while (i < s.size()) {
+    if (s.substr(i, prefix.size()) == prefix) {
+      size_t j = i + prefix.size();
+      while (j < s.size() && std::isdigit(static_cast<unsigned char>(s[j]))) {
+        j++;
+      }
+
+      if (j > i + prefix.size() && j < s.size() && s[j] == '.') {
+        i = j + 1;
+        continue;
+      }
+    }
+
+    res.push_back(s[i]);
+    i++;
+  }
+
+  return res;
+}
+
+}  // namespace
+
+absl::optional<AdlogPathDetail>
+AdlogNode::find_proto_path_detail_view(absl::string_view adlog_field_str) const {
   if (adlog_field_str.size() == 0) {
     return absl::nullopt;
   }
@@ -259,38 +310,39 @@ AdlogNode::find_proto_path_detail_helper(const std::string& adlog_field_str) con
     return absl::make_optional<AdlogPathDetail>(this);
   }
 
-  if (!is_str_starts_with(adlog_field_str, name_)) {
+  if (!absl::StartsWith(adlog_field_str, name_)) {
     LOG(ERROR) << "adlog_field_str should starts with: " << name_ << ", but is : " << adlog_field_str;
     return absl::nullopt;
   }
 
-  std::string field_name = "";
-  std::string suffix = "";
+  absl::string_view field_name;
+  absl::string_view suffix;
 
   if (name_.size() + 1 >= adlog_field_str.size()) {
     return absl::nullopt;
   }
 
-  std::string child_field_str = adlog_field_str.substr(name_.size() + 1);
+  absl::string_view child_field_str = adlog_field_str.substr(name_.size() + 1);
 
-  size_t pos = child_field_str.find(".");
-  if (pos != std::string::npos) {
+  size_t pos = child_field_str.find('.');
+  if (pos != absl::string_view::npos) {
     field_name = child_field_str.substr(0, pos);
     if (pos + 1 < child_field_str.size()) {
       suffix = child_field_str.substr(pos + 1);
     }
   } else {
     field_name = child_field_str;
-    suffix = "";
   }
 
-  auto it = children_.find(field_name);
-  if (it != children_.end() && it->second != nullptr) {
+  auto it = child_index_.find(field_name);
+  if (it != child_index_.end() && it->second != nullptr) {
+    const AdlogNode* child = it->second;
+
     // 可能是 action_detail 或者 common_info
-    if (it->second->is_common_info_list()) {
-      if (is_str_starts_with(suffix, "key:")) {
-        if (absl::optional<int> int_value = get_int_value_from_path(suffix)) {
-          if (const AdlogNode* node = it->second->find_common_info_leaf_by_enum_value(*int_value)) {
+    if (child->is_common_info_list()) {
+      if (absl::StartsWith(suffix, "key:")) {
+        if (absl::optional<int> int_value = get_int_value_from_path(std::string(suffix))) {
+          if (const AdlogNode* node = child->find_common_info_leaf_by_enum_value(*int_value)) {
             return absl::make_optional<AdlogPathDetail>(node, AdlogPathType::COMMON_INFO);
           } else {
             // 如果 use_name_value = false, 则返回 absl::nullopt。
@@ -299,7 +351,7 @@ AdlogNode::find_proto_path_detail_helper(const std::string& adlog_field_str) con
 
             if (use_name_value) {
               absl::optional<AdlogPathDetail> res = absl::make_optional<AdlogPathDetail>();
-              res->add_common_info_node(it->second.get(), *int_value);
+              res->add_common_info_node(child, *int_value);
               return res;
             } else {
               return absl::nullopt;
@@ -308,21 +360,17 @@ AdlogNode::find_proto_path_detail_helper(const std::string& adlog_field_str) con
         }
       } else if (suffix.size() == 0) {
         // CommonInfo 列表
-        if (const AdlogNode* node = it->second.get()) {
-          return absl::make_optional<AdlogPathDetail>(node, AdlogPathType::COMMON_INFO);
-        } else {
-          return absl::nullopt;
-        }
+        return absl::make_optional<AdlogPathDetail>(child, AdlogPathType::COMMON_INFO);
       } else if (suffix.size() > 0 && is_str_all_uppercase(suffix)) {
         // 枚举名
-        if (const AdlogNode* node = it->second->find_common_info_leaf_by_enum_str(suffix)) {
+        if (const AdlogNode* node = child->find_common_info_leaf_by_enum_str(std::string(suffix))) {
           return absl::make_optional<AdlogPathDetail>(node, AdlogPathType::COMMON_INFO);
         } else {
           return absl::nullopt;
         }
-      } else if (is_nonstd_common_info_enum(suffix)) {
+      } else if (is_nonstd_common_info_enum(std::string(suffix))) {
         // 少量枚举名不规范，包含小写字母，单独处理。
-        if (const AdlogNode* node = it->second->find_common_info_leaf_by_enum_str(suffix)) {
+        if (const AdlogNode* node = child->find_common_info_leaf_by_enum_str(std::string(suffix))) {
           return absl::make_optional<AdlogPathDetail>(node, AdlogPathType::COMMON_INFO);
         } else {
           return absl::nullopt;
@@ -331,14 +379,13 @@ AdlogNode::find_proto_path_detail_helper(const std::string& adlog_field_str) con
         LOG(ERROR) << "wrong format, should be enum str or enum value, but is: " << suffix;
         return absl::nullopt;
       }
-    } else if (it->second->is_action_detail_map()) {
-      if (is_str_starts_with(suffix, "key:")) {
+    } else if (child->is_action_detail_map()) {
+      if (absl::StartsWith(suffix, "key:")) {
         // action_detail
         // 需要去掉 .key:xxx, ActionDetail node 不包含 key，只有 value
-        if (absl::optional<int> int_value = get_int_value_from_path(suffix)) {
-          std::regex p_action("key:\\d+\\.");
-          child_field_str = std::regex_replace(child_field_str, p_action, "");
-          if (auto res = it->second->find_proto_path_detail_helper(child_field_str)) {
+        if (absl::optional<int> int_value = get_int_value_from_path(std::string(suffix))) {
+          std::string action_field_str = remove_action_key(child_field_str);
+          if (auto res = child->find_proto_path_detail_view(action_field_str)) {
             res->action.emplace(int_value.value());
             res->adlog_path_type = AdlogPathType::ACTION_DETAIL_LEAF;
             return res;
@@ -350,21 +397,16 @@ AdlogNode::find_proto_path_detail_helper(const std::string& adlog_field_str) con
           return absl::nullopt;
         }
       } else if (suffix.size() == 0) {
-        if (const AdlogNode* node = it->second.get()) {
-          return absl::make_optional<AdlogPathDetail>(node, AdlogPathType::ACTION_DETAIL_LIST);
-        } else {
-          LOG(ERROR) << "cannot find adlog node: " << adlog_field_str;
-          return absl::nullopt;
-        }
+        return absl::make_optional<AdlogPathDetail>(child, AdlogPathType::ACTION_DETAIL_LIST);
       } else {
         LOG(ERROR) << "wrong format for action, should be .key:xxx, but is: " << suffix;
         return absl::nullopt;
       }
-    } else if (it->second->is_label_infos_map()) {
+    } else if (child->is_label_infos_map()) {
       if (absl::StartsWith(suffix, "key:")) {
-        if (absl::optional<int> int_value = get_int_value_from_path(suffix)) {
+        if (absl::optional<int> int_value = get_int_value_from_path(std::string(suffix))) {
           // 固定是 0: UNKNOW_NAME
-          if (const AdlogNode* node = it->second->find_common_info_leaf_by_enum_value(0)) {
+          if (const AdlogNode* node = child->find_common_info_leaf_by_enum_value(0)) {
             auto res = absl::make_optional<AdlogPathDetail>(node, AdlogPathType::LABEL_INFO_LEAF);
             res->label_info_value.emplace(*int_value);
             return res;
@@ -378,24 +420,19 @@ AdlogNode::find_proto_path_detail_helper(const std::string& adlog_field_str) con
           return absl::nullopt;
         }
       } else if (suffix.size() == 0) {
-        if (const AdlogNode* node = it->second.get()) {
-          return absl::make_optional<AdlogPathDetail>(node, AdlogPathType::LABEL_INFO_MAP);
-        } else {
-          LOG(ERROR) << "cannot find label info node, adlog_field_str: " << adlog_field_str;
-          return absl::nullopt;
-        }
+        return absl::make_optional<AdlogPathDetail>(child, AdlogPathType::LABEL_INFO_MAP);
       } else {
         LOG(ERROR) << "wrong format for label_infos, should be .key:xxx, but is: " << suffix;
         return absl::nullopt;
       }
-    } else if (it->second->is_enum()) {
-      return absl::make_optional<AdlogPathDetail>(it->second.get(), AdlogPathType::ENUM);
+    } else if (child->is_enum()) {
+      return absl::make_optional<AdlogPathDetail>(child, AdlogPathType::ENUM);
     } else {
-      return it->second->find_proto_path_detail_helper(child_field_str);
+      return child->find_proto_path_detail_view(child_field_str);
     }
   }
 
-  if (!is_field_non_proto(adlog_field_str)) {
+  if (!is_field_non_proto(std::string(adlog_field_str))) {
     LOG(ERROR) << "cannot find proto path detail, wrong format of adlog_field_str: " << adlog_field_str
                << ", field_name: " << field_name;
   }
@@ -555,18 +592,18 @@ bool AdlogNode::is_from_user_action_detail_list() const {
 
 // 枚举字段不会有 chidlren_，只会有嵌套定义的枚举
 const AdlogNode* AdlogNode::find_common_info_leaf_by_enum_value(int enum_value) const {
-  auto it_child = children_.find(std::to_string(enum_value));
-  if (it_child != children_.end()) {
-    return it_child->second.get();
+  auto it_child = child_index_.find(std::to_string(enum_value));
+  if (it_child != child_index_.end()) {
+    return it_child->second;
   }
 
   return nullptr;
 }
 
 const AdlogNode* AdlogNode::find_common_info_leaf_by_enum_str(const std::string& enum_str) const {
-  auto it_child = children_.find(enum_str);
-  if (it_child != children_.end()) {
-    return it_child->second.get();
+  auto it_child = child_index_.find(enum_str);
+  if (it_child != child_index_.end()) {
+    return it_child->second;
   }
 
   return nullptr;
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <nlohmann/json.hpp>
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/string_view.h>
 #include <absl/types/optional.h>
 #include <string>
 #include <memory>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <unordered_set>
@@ -101,10 +104,18 @@ class AdlogNode {
 
   std::unordered_map<std::string, std::unique_ptr<AdlogNode>> children_;
 
+  /// 子节点的其他名字，如枚举的 int 值，不拥有节点。
+  std::unordered_set<std::string> child_aliases_;
+
+  /// children_ 和 child_aliases_ 的索引，key 指向其中的名字，按路径逐段查找时不需要构造 std::string。
+  absl::flat_hash_map<absl::string_view, const AdlogNode*> child_index_;
+
   const AdlogNode* parent_ = nullptr;
 
   std::unordered_map<std::string, std::string> action_detail_field_types_;
 
+  friend class AdlogTreeSnapshot;
+
  public:
   AdlogNode() = default;
   explicit AdlogNode(const std::string& name, const std::string& type_str, int index);
@@ -205,11 +216,20 @@ class AdlogNode {
   /// 当前类型是否是 LabelAttr
   bool is_type_str_label_attr() const { return type_str_ == "LabelAttr"; }
 
+  /// 名字已经存在时不做处理。
   void add_child(const std::string& child_name, std::unique_ptr<AdlogNode> child) {
+    if (child_index_.find(child_name) != child_index_.end()) {
+      return;
+    }
+
     child->set_parent(this);
-    children_.insert({child_name, std::move(child)});
+    auto res = children_.insert({child_name, std::move(child)});
+    child_index_[absl::string_view(res.first->first)] = res.first->second.get();
   }
 
+  /// 为已有的子节点 child_name 添加另一个名字 alias, 如枚举按 int 值查找。alias 已经存在时不做处理。
+  void add_child_alias(const std::string& alias, const std::string& child_name);
+
   bool has_child(const std::string& child_name) const;
 
   /// 寻找 path 中的 key int, 如 key:2, key_2, key:2.key
@@ -223,7 +243,7 @@ class AdlogNode {
   void find_middle_node_root(const std::string& middle_node_root,
                              std::vector<const AdlogNode*>* root_arr) const;
 
-  bool is_str_all_uppercase(const std::string& s) const;
+  bool is_str_all_uppercase(absl::string_view s) const;
 
   /// 可能包含类型，需要去掉类型, 如 adlog.user_info.common_info_attr.APP_LIST:int64_list
   const AdlogNode* find_proto_node(const std::string& adlog_field_str) const;
@@ -231,9 +251,13 @@ class AdlogNode {
   /// 查找 node
   const AdlogNode* find_proto_node_helper(const std::string& adlog_field_str) const;
 
+  /// 结果缓存在 ProtoParser 中，见 ProtoParser::find_path_detail_memo。
   absl::optional<AdlogPathDetail> find_proto_path_detail(const std::string& adlog_field_str) const;
   absl::optional<AdlogPathDetail> find_proto_path_detail_helper(const std::string& adlog_field_str) const;
 
+  /// 按 `.` 逐段在 child_index_ 中查找，只有 CommonInfo、ActionDetail 等带 key 的路径需要构造新的字符串。
+  absl::optional<AdlogPathDetail> find_proto_path_detail_view(absl::string_view adlog_field_str) const;
+
   /// 返回叶子节点完整的 CommonInfo 枚举名, 如 CommonInfoAttr::APP_LIST。
   /// field_path 是 adlog 路径，如 adlog.user_info.common_info_attr.APP_LIST:int64_list
   absl::optional<std::string> find_common_info_leaf_enum_name(const std::string& adlog_field_str) const;
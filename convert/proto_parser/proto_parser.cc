@@ -1,5 +1,6 @@
 #include <absl/strings/str_join.h>       // NOLINT
 #include <absl/strings/str_split.h>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <google/protobuf/arena.h>
 #include <google/protobuf/repeated_field.h>
@@ -16,10 +17,14 @@
 #include <vector>
 
 #include "./util.h"
+#include "./adlog_tree_snapshot.h"
 #include "./proto_node.h"
 #include "./proto_parser.h"
 #include "proto/ad_joint_labeled_log.pb.h"
 
+DEFINE_string(adlog_tree_snapshot, "",
+              "snapshot file of adlog tree, empty means building adlog tree using reflection every time");
+
 namespace ks {
 namespace ad_algorithm {
 namespace proto_parser {
@@ -40,6 +45,49 @@ const AdlogNode* ProtoParser::adlog_root() const {
   return adlog_root_.get();
 }
 
+absl::optional<AdlogPathDetail> ProtoParser::find_path_detail_memo(
+  const AdlogNode* node,
+  const std::string& adlog_field_str,
+  const std::function<absl::optional<AdlogPathDetail>()>& find_fn) {
+  auto& memo = path_detail_memo_[use_name_value_ ? 1 : 0];
+  auto key = std::make_pair(node, adlog_field_str);
+
+  {
+    std::lock_guard<std::mutex> lock(path_detail_memo_mutex_);
+    auto it = memo.find(key);
+    if (it != memo.end()) {
+      return it->second;
+    }
+  }
+
+  absl::optional<AdlogPathDetail> res = find_fn();
+
+  std::lock_guard<std::mutex> lock(path_detail_memo_mutex_);
+  auto insert_res = memo.emplace(std::move(key), std::move(res));
+
+  return insert_res.first->second;
+}
+
+std::unique_ptr<AdlogNode> ProtoParser::load_or_build_adlog_tree() {
+  const std::string& snapshot_filename = FLAGS_adlog_tree_snapshot;
+  if (snapshot_filename.size() == 0) {
+    return build_adlog_tree_using_reflection();
+  }
+
+  uint64_t fingerprint = AdlogTreeSnapshot::fingerprint(AdJointLabeledLog::descriptor());
+  if (auto root = AdlogTreeSnapshot::load(snapshot_filename, fingerprint)) {
+    LOG(INFO) << "load adlog tree from snapshot: " << snapshot_filename;
+    return root;
+  }
+
+  auto root = build_adlog_tree_using_reflection();
+  if (root != nullptr && AdlogTreeSnapshot::save(snapshot_filename, fingerprint, *root)) {
+    LOG(INFO) << "save adlog tree snapshot: " << snapshot_filename << ", fingerprint: " << fingerprint;
+  }
+
+  return root;
+}
+
 std::unique_ptr<AdlogNode> ProtoParser::build_adlog_tree_using_reflection() {
   AdJointLabeledLog adlog;
   return build_adlog_tree_from_descriptor(adlog.GetDescriptor(), "adlog", 0, 0, "adlog", false);
@@ -66,12 +114,12 @@ void ProtoParser::add_enum(AdlogNode* root,
     return;
   }
 
-  // 分别根据枚举名和 int 值建索引,
+  // 分别根据枚举名和 int 值建索引, int 值只是同一个节点的别名。
   std::string name = enum_type->name();
   for (int j = 0; j < enum_type->value_count(); j++) {
     const auto enum_value = enum_type->value(j);
     add_single_enum(root, enum_value->name(), enum_value, type_str);
-    add_single_enum(root, std::to_string(enum_value->number()), enum_value, type_str);
+    root->add_child_alias(std::to_string(enum_value->number()), enum_value->name());
   }
 
   if (field_name.size() > 0) {
@@ -237,7 +285,7 @@ bool ProtoParser::is_common_info(const Descriptor* descriptor) {
 
 ProtoParser::ProtoParser() {
   LOG(INFO) << "start build adlog tree";
-  adlog_root_ = std::move(build_adlog_tree_using_reflection());
+  adlog_root_ = std::move(load_or_build_adlog_tree());
   if (adlog_root_ == nullptr) {
     LOG(ERROR) << "build adlog tree failed!";
   }
@@ -3,16 +3,24 @@
 #include <google/protobuf/arena.h>
 #include <google/protobuf/repeated_field.h>
 #include <google/protobuf/descriptor.h>
+#include <gflags/gflags.h>
 
 #include <nlohmann/json.hpp>
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/optional.h>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "./proto_node.h"
 
+DECLARE_string(adlog_tree_snapshot);
+
 namespace ks {
 namespace ad_algorithm {
 namespace proto_parser {
@@ -32,6 +40,14 @@ class ProtoParser {
   /// 则新建一个 adlogNode，包含 int value 为值的枚举。
   bool use_name_value_ = false;
 
+  /// AdlogNode::find_proto_path_detail 的结果，包括找不到的结果。key 是查找的起点节点和路径，
+  /// 下标是 use_name_value, 两种情况下结果不同。
+  ///
+  /// 每个 adlog 表达式改写时都会查找，同一个路径会被查找很多次。整棵树共用这一份缓存。
+  std::mutex path_detail_memo_mutex_;
+  absl::flat_hash_map<std::pair<const AdlogNode*, std::string>,
+                      absl::optional<AdlogPathDetail>> path_detail_memo_[2];
+
  public:
   static ProtoParser& instance() {
     static ProtoParser proto_parser;
@@ -62,6 +78,13 @@ class ProtoParser {
   bool use_name_value() const { return use_name_value_; }
   void set_use_name_value(bool v) { use_name_value_ = v; }
 
+  /// 查找 node 下 adlog_field_str 的缓存结果，没有则调用 find_fn 并缓存。find_fn 在锁外执行。
+  /// CommonInfo 新建的 enum_node 由缓存的 AdlogPathDetail 持有，返回的 adlog_node 一直有效。
+  absl::optional<AdlogPathDetail> find_path_detail_memo(
+    const AdlogNode* node,
+    const std::string& adlog_field_str,
+    const std::function<absl::optional<AdlogPathDetail>()>& find_fn);
+
   void add_single_enum(AdlogNode* root,
                        const std::string& name,
                        const EnumValueDescriptor* enum_value,
@@ -72,6 +95,10 @@ class ProtoParser {
                 const std::string& type_str,
                 const std::string& field_name);
 
+  // 设置了 --adlog_tree_snapshot 时优先从快照恢复 adlog tree, 快照不存在或者 proto 变化时通过反射建树
+  // 并写入快照。必须在第一次调用 instance() 之前解析 flag。
+  std::unique_ptr<AdlogNode> load_or_build_adlog_tree();
+
   // 通过反射构建 adlog tree。
   std::unique_ptr<AdlogNode> build_adlog_tree_using_reflection();
   std::unique_ptr<AdlogNode> build_adlog_tree_from_descriptor(const Descriptor* descriptor,
@@ -1,4 +1,3 @@
-#include <regex>
 #include <sstream>
 
 #include "../Env.h"
@@ -136,16 +135,17 @@ void ActionDetailRule::process_action_detail_int_list(clang::SourceRange source_
 
   std::vector<std::string> new_bs_field_enums;
 
-  std::regex p(std::string("_key_") + std::to_string(int_list_member_values[0]) + std::string("_"));
+  std::string old_str = std::string("_key_") + std::to_string(int_list_member_values[0]) + std::string("_");
+  tool::TextReplacer replacer({{old_str, ""}});
   for (size_t i = 0; i < int_list_member_values.size(); i++) {
     std::string new_str = std::string("_key_") + std::to_string(int_list_member_values[i]) + std::string("_");
     oss << "auto process_action_" << int_list_member_values[i] << " = [&]"
-        << std::regex_replace(body_str, p, new_str) << ";\n\n    ";
+        << replacer.replace(body_str, new_str) << ";\n\n    ";
 
     if (const auto ctor_info = env_ptr->get_constructor_info()) {
       const std::unordered_set<std::string>& bs_field_enums = ctor_info->bs_field_enums();
       for (const auto& x : bs_field_enums) {
-        std::string new_bs_field_enum = std::regex_replace(x, p, new_str);
+        std::string new_bs_field_enum = replacer.replace(x, new_str);
         if (new_bs_field_enum != x) {
           new_bs_field_enums.push_back(new_bs_field_enum);
         }
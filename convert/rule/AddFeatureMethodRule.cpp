@@ -1,4 +1,3 @@
-#include <regex>
 #include <sstream>
 #include <absl/strings/str_join.h>
 
@@ -16,7 +15,7 @@ namespace ad_algorithm {
 namespace convert {
 
 void AddFeatureMethodRule::process(clang::CallExpr *call_expr, Env *env_ptr) {
-  std::shared_ptr<ExprInfo> expr_info_ptr = parse_expr(call_expr, env_ptr);
+  ExprInfo* expr_info_ptr = parse_expr(call_expr, env_ptr);
   if (expr_info_ptr == nullptr) {
     LOG(INFO) << "expr_info_ptr is nullptr!";
   }
@@ -48,9 +47,9 @@ void AddFeatureMethodRule::process(clang::CallExpr *call_expr, Env *env_ptr) {
       }
 
       std::string s = rewriter_.getRewrittenText(expr_info_ptr->expr());
-      std::string new_s = std::regex_replace(
-          s, std::regex("ks::ad_algorithm::get_value_from_Action"),
-          "bs_get_value_from_action");
+      static const tool::TextReplacer replacer({
+          {"ks::ad_algorithm::get_value_from_Action", "bs_get_value_from_action"}});
+      std::string new_s = replacer.replace(s);
       rewriter_.ReplaceText(call_expr, new_s);
     }
 
@@ -60,7 +59,7 @@ void AddFeatureMethodRule::process(clang::CallExpr *call_expr, Env *env_ptr) {
 
 void AddFeatureMethodRule::process(clang::CXXMemberCallExpr* cxx_member_call_expr,
                                    Env* env_ptr) {
-  std::shared_ptr<ExprInfo> expr_info_ptr = parse_expr(cxx_member_call_expr, env_ptr);
+  ExprInfo* expr_info_ptr = parse_expr(cxx_member_call_expr, env_ptr);
   if (expr_info_ptr == nullptr) {
     LOG(INFO) << "expr_info_ptr is nullptr!";
   }
@@ -76,9 +75,9 @@ void AddFeatureMethodRule::process(clang::CXXMemberCallExpr* cxx_member_call_exp
     }
   } else if (expr_info_ptr->is_parent_action_info()) {
     if (env_ptr->get_method_name() != "Extract") {
-      std::regex p("(.*?)\\[(\\w+)\\]\\.(\\w+)\\(\\)");
-      std::string name = std::regex_replace(expr_info_ptr->raw_expr_str(), p, "$1_$3");
-      std::string new_text = std::regex_replace(expr_info_ptr->raw_expr_str(), p, "$1_$3.Get($2)");
+      static const tool::TextReplacer replacer({{"(.*?)\\[(\\w+)\\]\\.(\\w+)\\(\\)", ""}});
+      std::string name = replacer.replace(expr_info_ptr->raw_expr_str(), "$1_$3");
+      std::string new_text = replacer.replace(expr_info_ptr->raw_expr_str(), "$1_$3.Get($2)");
       rewriter_.ReplaceText(cxx_member_call_expr, new_text);
 
       return;
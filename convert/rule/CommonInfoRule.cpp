@@ -1,4 +1,3 @@
-#include <regex>
 #include <sstream>
 #include "../Env.h"
 #include "../Tool.h"
@@ -343,6 +342,7 @@ void CommonInfoRule::process(clang::CaseStmt* case_stmt, Env* env_ptr) {
 
             detail->copy_except_int_value(common_info_detail.get());
             env_ptr->add_common_info_detail_def(*detail);
+            env_ptr->add_common_info_field_access(*detail);
           }
         }
       }
@@ -376,8 +376,8 @@ void CommonInfoRule::process(clang::DeclStmt* decl_stmt, Env* env_ptr) {
     // teams/ad/ad_algorithm/feature/fast/impl/extract_user_rtl_product_name_shallow_action_7d.h
     // auto action_list = action_name2list[action_name];
     if (tool::is_repeated_proto_ptr(var_decl->getType())) {
-      static std::regex p("auto ");
-      rewriter_.ReplaceText(decl_stmt, std::regex_replace(stmt_to_string(decl_stmt), p, "auto&"));
+      static const tool::TextReplacer replacer({{"auto ", "auto&"}});
+      rewriter_.ReplaceText(decl_stmt, replacer.replace(stmt_to_string(decl_stmt)));
     }
 
     if (auto& common_info_prepare = env_ptr->cur_mutable_common_info_prepare()) {
@@ -403,8 +403,8 @@ void CommonInfoRule::process(clang::CXXMemberCallExpr* cxx_member_call_expr, Env
   if (expr_info_ptr->parent() != nullptr &&
       expr_info_ptr->parent()->is_repeated_proto_ptr()) {
     std::string parent_str = expr_info_ptr->parent()->origin_expr_str();
-    std::regex p(parent_str + "\\->");
-    std::string s = std::regex_replace(expr_info_ptr->origin_expr_str(), p, parent_str + ".");
+    tool::TextReplacer replacer({{parent_str + "\\->", parent_str + "."}});
+    std::string s = replacer.replace(expr_info_ptr->origin_expr_str());
     rewriter_.ReplaceText(cxx_member_call_expr, s);
   }
 
@@ -1,5 +1,4 @@
 #include <cstdio>
-#include <regex>
 #include <absl/strings/str_join.h>
 #include <sstream>
 #include "../Env.h"
@@ -81,8 +80,8 @@ void GeneralRule::process(clang::DeclStmt* decl_stmt, Env* env_ptr) {
 
       // 替换变量声明中的 ad 枚举类型
       if (tool::is_ad_enum(init_expr->getType())) {
-        static std::regex p_ad_enum("(::)?([^ ]+) ([^ ]+) =");
-        s = std::regex_replace(s, p_ad_enum, std::string("::bs::") + "$2 $3 =");
+        static const tool::TextReplacer replacer_ad_enum({{"(::)?([^ ]+) ([^ ]+) =", "::bs::$2 $3 ="}});
+        s = replacer_ad_enum.replace(s);
         rewriter_.ReplaceText(decl_stmt, s);
       }
 
@@ -105,7 +104,7 @@ void GeneralRule::process(clang::DeclStmt* decl_stmt, Env* env_ptr) {
       if (tool::is_common_info_vector(var_decl->getType())) {
         // common info 对应的类型确定后才能替换
         auto f_replace = [](Env* env_ptr, clang::Stmt* stmt) {
-          static std::regex p("std::vector<.*>");
+          static const tool::TextReplacer replacer({{"std::vector<.*>", ""}});
 
           if (clang::DeclStmt* decl_stmt = dyn_cast<clang::DeclStmt>(stmt)) {
             if (clang::VarDecl* var_decl = dyn_cast<clang::VarDecl>(decl_stmt->getSingleDecl())) {
@@ -116,9 +115,9 @@ void GeneralRule::process(clang::DeclStmt* decl_stmt, Env* env_ptr) {
 
                 std::string new_decl;
                 if (env_ptr->is_combine_feature() && !expr_info_ptr->is_item_field()) {
-                  new_decl = std::regex_replace(stmt_to_string(decl_stmt), p, "std::vector<BSRepeatedField<int64_t, true>>");
+                  new_decl = replacer.replace(stmt_to_string(decl_stmt), "std::vector<BSRepeatedField<int64_t, true>>");
                 } else {
-                  new_decl = std::regex_replace(stmt_to_string(decl_stmt), p, "std::vector<BSRepeatedField<int64_t>>");
+                  new_decl = replacer.replace(stmt_to_string(decl_stmt), "std::vector<BSRepeatedField<int64_t>>");
                 }
 
                 return StmtReplacement{stmt, new_decl};
@@ -134,8 +133,8 @@ void GeneralRule::process(clang::DeclStmt* decl_stmt, Env* env_ptr) {
 
       std::string stmt_str = rewriter_.getRewrittenText(decl_stmt);
       if (starts_with(stmt_str, "string ")) {
-        static std::regex p_string("string ");
-        std::string s = std::regex_replace(stmt_str, p_string, "std::string ");
+        static const tool::TextReplacer replacer_string({{"string ", "std::string "}});
+        std::string s = replacer_string.replace(stmt_str);
         rewriter_.ReplaceText(decl_stmt, s);
       }
     }
@@ -143,17 +142,17 @@ void GeneralRule::process(clang::DeclStmt* decl_stmt, Env* env_ptr) {
 
   std::string stmt_str = stmt_to_string(decl_stmt);
   if (starts_with(stmt_str, "vector")) {
-    static std::regex p_vector("vector<(.*)>");
-    static std::regex p_string("vector<string>");
-    std::string s = std::regex_replace(stmt_str, p_vector, "std::vector<$1>");
-    s = std::regex_replace(s, p_string, "vector<std::string>");
+    static const tool::TextReplacer replacer_vector({{"vector<(.*)>", "std::vector<$1>"}});
+    static const tool::TextReplacer replacer_string({{"vector<string>", "vector<std::string>"}});
+    std::string s = replacer_vector.replace(stmt_str);
+    s = replacer_string.replace(s);
     LOG(INFO) << "replace decl_stmt: " << stmt_str << ", text: " << s;
     rewriter_.ReplaceText(decl_stmt, s);
   }
 }
 
 void GeneralRule::process(clang::CallExpr* call_expr, Env* env_ptr) {
-  std::shared_ptr<ExprInfo> expr_info_ptr = parse_expr(call_expr, env_ptr);
+  ExprInfo* expr_info_ptr = parse_expr(call_expr, env_ptr);
   if (expr_info_ptr == nullptr) {
     LOG(INFO) << "expr_info_ptr is nullptr!";
   }
@@ -193,7 +192,7 @@ void GeneralRule::process(clang::CallExpr* call_expr, Env* env_ptr) {
 }
 
 void GeneralRule::process(clang::CXXMemberCallExpr* cxx_member_call_expr, Env* env_ptr) {
-  std::shared_ptr<ExprInfo> expr_info_ptr = parse_expr(cxx_member_call_expr, env_ptr);
+  ExprInfo* expr_info_ptr = parse_expr(cxx_member_call_expr, env_ptr);
   if (expr_info_ptr == nullptr) {
     LOG(INFO) << "expr_info_ptr is nullptr!";
   }
@@ -366,7 +365,7 @@ void GeneralRule::process(clang::CXXMemberCallExpr* cxx_member_call_expr, Env* e
 }
 
 void GeneralRule::process(clang::MemberExpr* member_expr, Env* env_ptr) {
-  std::shared_ptr<ExprInfo> expr_info_ptr = parse_expr(member_expr, env_ptr);
+  ExprInfo* expr_info_ptr = parse_expr(member_expr, env_ptr);
   if (!expr_info_ptr->is_from_adlog()) {
     return;
   }
@@ -540,21 +539,22 @@ void GeneralRule::replace_decl_ref_var(ExprInfo* expr_info_ptr, Env* env_ptr) {
   }
 
   if (expr_info_ptr->parent() != nullptr) {
-    replace_decl_ref_var(expr_info_ptr->parent().get(), env_ptr);
+    replace_decl_ref_var(expr_info_ptr->parent(), env_ptr);
   }
 }
 
 std::string GeneralRule::replace_get_norm_query(clang::CXXMemberCallExpr* cxx_member_call_expr) {
   std::string s = stmt_to_string(cxx_member_call_expr);
 
-  static std::regex p("this\\->GetNormQuery\\(adlog, \\&(\\w+)\\)");
-  return std::regex_replace(s, p, "bs_util.BSGetNormQuery(bs, pos, &$1)");
+  static const tool::TextReplacer replacer({
+      {"this\\->GetNormQuery\\(adlog, \\&(\\w+)\\)", "bs_util.BSGetNormQuery(bs, pos, &$1)"}});
+  return replacer.replace(s);
 }
 
 std::string GeneralRule::rm_decl_type(clang::DeclStmt* decl_stmt) {
   std::string decl_stmt_str = rewriter_.getRewrittenText(decl_stmt);
-  static std::regex p("([^ ]*) +([^ ]*) ?=");
-  return std::regex_replace(decl_stmt_str, p, "$2 =");
+  static const tool::TextReplacer replacer({{"([^ ]*) +([^ ]*) ?=", "$2 ="}});
+  return replacer.replace(decl_stmt_str);
 }
 
 }  // namespace convert
@@ -112,8 +112,8 @@ void GeneralRule::process_loop(T* loop_stmt,
     if (leaf_fields.size() > 0) {
       std::string origin_size_var = loop_info->origin_size_var();
       if (origin_size_var.size() > 0) {
-        std::regex p(origin_size_var);
-        s = std::regex_replace(s, p, leaf_fields[0] + ".size()");
+        tool::TextReplacer replacer({{origin_size_var, leaf_fields[0] + ".size()"}});
+        s = replacer.replace(s);
 
         rewriter_.ReplaceText(loop_stmt, s);
       } else {
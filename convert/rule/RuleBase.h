@@ -109,6 +109,23 @@ class RuleBase {
   std::string name_;
 };
 
+/// 只用于推导 `&Rule::process` 中参数为 T* 的重载是在哪个类中定义的，不需要实现。
+template<typename T, typename Class>
+Class rule_process_owner(void (Class::*)(T*, Env*));
+
+/// 规则是否重载了参数为 T* 的 process。没有重载时调用的是 RuleBase 中的空实现，可以直接跳过。
+///
+/// 规则都通过 `using RuleBase::process` 引入基类的重载，`&Rule::process` 中参数为 T* 的重载要么是规则
+/// 自己定义的，要么是 RuleBase 的。RuleBase 中没有 T* 的重载时 (如 clang::ConditionalOperator) 推导失败，
+/// 保守地认为规则需要处理。
+template<typename Rule, typename T, typename = void>
+struct rule_overrides_process : std::true_type {};
+
+template<typename Rule, typename T>
+struct rule_overrides_process<Rule, T, std::void_t<decltype(rule_process_owner<T>(&Rule::process))>>
+  : std::integral_constant<bool,
+                           !std::is_same<decltype(rule_process_owner<T>(&Rule::process)), RuleBase>::value> {};
+
 }  // namespace convert
 }  // namespace ad_algorithm
 }  // namespace ks
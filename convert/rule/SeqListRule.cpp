@@ -147,7 +147,7 @@ void SeqListRule::process(clang::BinaryOperator* binary_operator, Env *env_ptr)
 }
 
 void SeqListRule::process(clang::CallExpr *call_expr, Env *env_ptr) {
-  std::shared_ptr<ExprInfo> expr_info_ptr = parse_expr(call_expr, env_ptr);
+  ExprInfo* expr_info_ptr = parse_expr(call_expr, env_ptr);
   if (expr_info_ptr == nullptr) {
     LOG(INFO) << "expr_info_ptr is nullptr!";
   }
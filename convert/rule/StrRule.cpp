@@ -19,7 +19,7 @@ void StrRule::process(clang::CallExpr *call_expr, Env *env_ptr) {
   // SplitString 参数需要从 absl::string_view 替换成 std::string
   // 示例: teams/ad/ad_algorithm/feature/fast/impl/extract_user_offline_retailer_keyword.h
   // base::SplitString(userAttr.string_value(), std::string(","), &userKeywordCnt);
-  process_str_param_call(expr_info_ptr.get(), env_ptr);
+  process_str_param_call(expr_info_ptr, env_ptr);
 }
 
 void StrRule::process(clang::CXXMemberCallExpr* cxx_member_call_expr, Env* env_ptr) {
@@ -29,7 +29,7 @@ void StrRule::process(clang::CXXMemberCallExpr* cxx_member_call_expr, Env* env_p
   }
 
  // 示例: teams/ad/ad_algorithm/feature/fast/impl/extract_combine_region.h
-  process_str_param_call(expr_info_ptr.get(), env_ptr);
+  process_str_param_call(expr_info_ptr, env_ptr);
 }
 
 void StrRule::process_str_param_call(ExprInfo* expr_info_ptr, Env* env_ptr) {
@@ -76,7 +76,7 @@ void StrRule::process(clang::BinaryOperator* binary_operator, Env *env_ptr) {
     if (left_expr_info != nullptr && right_expr_info != nullptr) {
       if (!right_expr_info->is_cxx_operator_call_expr()) {
         clang::SourceRange source_range = find_source_range(binary_operator);
-        process_str_assign(source_range, left_expr_info.get(), right_expr_info.get());
+        process_str_assign(source_range, left_expr_info, right_expr_info);
       }
     }
   }
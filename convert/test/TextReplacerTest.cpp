@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../TextReplacer.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+namespace tool {
+
+namespace {
+
+/// 代码中用到的规则及替换格式。
+const std::vector<std::pair<std::string, std::string>>& used_rules() {
+  static const std::vector<std::pair<std::string, std::string>> rules = {
+      {" ?\\&$", ""},
+      {"ad::class ", "ad::"},
+      {"(adlog|ad_log)", "bslog"},
+      {"^(adlog|ad_log)", "bslog"},
+      {"(adlog\\.|ad_log\\.)", "bslog."},
+      {"\n *;", ""},
+      {"_+$", ""},
+      {"(::)?google::protobuf::", ""},
+      {"const ?", ""},
+      {" +", ""},
+      {" ", ""},
+      {"_Bool", "bool"},
+      {"private ?:", "private:\n  "},
+      {"(.*?)\\[(\\w+)\\]\\.(\\w+)\\(\\)", "$1"},
+      {"(.*?)\\[(\\w+)\\]\\.(\\w+)\\(\\)", "$1_$3"},
+      {"(.*?)\\[(\\w+)\\]\\.(\\w+)\\(\\)", "$1_$3.Get($2)"},
+      {"if (bs == nullptr) \\{[\\s\\S.]*?\\}", "if (bs == nullptr) {\n    return;\n  }\n\n"},
+      {"operator", ""},
+      {"_size$", ".size"},
+      {"\\.size$", ""},
+      {"(.*)_key_(.*)", "$1"},
+      {"(.*)\\.key:(.*)", "$1"},
+      {"key:\\d+$", "ENUM"},
+      {"_key_1_", "_key_2_"},
+      {"key_1([^\\d\\w_])?", "key_2$1"},
+      {"(::)?([^ ]+) ([^ ]+) =", "::bs::$2 $3 ="},
+      {"std::vector<.*>", "std::vector<BSRepeatedField<int64_t>>"},
+      {"string ", "std::string "},
+      {"vector<(.*)>", "std::vector<$1>"},
+      {"vector<string>", "vector<std::string>"},
+      {"this\\->GetNormQuery\\(adlog, \\&(\\w+)\\)", "bs_util.BSGetNormQuery(bs, pos, &$1)"},
+      {"([^ ]*) +([^ ]*) ?=", "$2 ="},
+      {"ks::ad_algorithm::get_value_from_Action", "bs_get_value_from_action"},
+      {"auto ", "auto&"},
+      {"a.b\\->", "a.b."},
+      {"BSGet", "BSHas"},
+      {" x ", " y "},
+      {"([ <]?)string([ >,])", "$1std::string$2"},
+      {"std::string", "absl::string_view"},
+      {".*teams/ad/ad_algorithm/feature/fast/impl/", "teams/ad/ad_algorithm/bs_feature/fast/impl/bs_"},
+      {"\\.h", ".cc"},
+      {"continue ?;", ""},
+      {"break ?;", ""},
+      {"\\.", "_"},
+      {":", "_"},
+      {"this\\->", ""},
+      {"class (Extract.*) ?: ?public", "class BS$1: public"},
+      {": *;", ";"},
+      {"const AdLog ?\\& ?(adlog|ad_log)", "const BSLog& bslog"},
+      {"template ?<ItemType", "template<bs::ItemType"},
+      // 替换格式。
+      {"(a)(b)?", "[$$][$&][$`][$'][$1][$2][$3][$12][$x][$"},
+      {"a{2,3}?(b|c)+", "<$1>"},
+      {"(?:ab|a)(c*)d", "<$1>"},
+      {"[^a-c\\]]+", "_"},
+  };
+
+  return rules;
+}
+
+/// 随机拼接规则中出现的片段，保证有足够多的匹配以及边界情况。
+std::string gen_text(std::mt19937* rng, const std::vector<std::string>& tokens, size_t max_tokens) {
+  std::uniform_int_distribution<size_t> len_dist(0, max_tokens);
+  std::uniform_int_distribution<size_t> token_dist(0, tokens.size() - 1);
+
+  std::string s;
+  size_t len = len_dist(*rng);
+  for (size_t i = 0; i < len; i++) {
+    s += tokens[token_dist(*rng)];
+  }
+
+  return s;
+}
+
+std::vector<std::string> gen_tokens() {
+  std::vector<std::string> tokens = {
+    " ", "  ", "\n", "\r", "\t", ";", ":", "::", "<", ">", ",", ".", "_", "__", "[", "]", "(", ")", "{", "}",
+    "&", "$", "-", "=", "*", "\\", "/", "0", "1", "12", "a", "b", "c", "d", "x", "ab", "abc",
+    "adlog", "ad_log", "bs", "class", "Extract", "Foo", "public", "const", "AdLog", "string", "vector",
+    "std", "google", "protobuf", "private", "operator", "size", "key", "_key_", "key_1", "BSGet", "auto",
+    "this->", "GetNormQuery", "teams/ad/ad_algorithm/feature/fast/impl/", ".h", "continue", "break",
+    "_Bool", "if (bs == nullptr) ", "ItemType", "template", "ks::ad_algorithm::", "get_value_from_Action",
+  };
+
+  for (const auto& rule : used_rules()) {
+    tokens.push_back(rule.first);
+    tokens.push_back(rule.second);
+  }
+
+  return tokens;
+}
+
+}  // namespace
+
+TEST(TextReplacerTest, SameAsRegexReplace) {
+  std::mt19937 rng(20261017);
+  std::vector<std::string> tokens = gen_tokens();
+
+  for (const auto& rule : used_rules()) {
+    TextReplacer replacer({rule});
+    std::regex p(rule.first);
+
+    for (int i = 0; i < 3000; i++) {
+      std::string s = gen_text(&rng, tokens, 12);
+      ASSERT_EQ(std::regex_replace(s, p, rule.second), replacer.replace(s))
+        << "pattern: " << rule.first << ", text: " << s;
+      ASSERT_EQ(std::regex_replace(s, p, rule.second, std::regex_constants::format_first_only),
+                replacer.replace_first(s, rule.second))
+        << "pattern: " << rule.first << ", text: " << s;
+    }
+  }
+}
+
+TEST(TextReplacerTest, FirstRuleWins) {
+  TextReplacer replacer({{"ab", "1"}, {"a", "2"}, {"b", "3"}});
+  EXPECT_EQ("1213", replacer.replace("abaabb"));
+}
+
+TEST(TextReplacerTest, OutputIsNotRescanned) {
+  TextReplacer replacer({{"a", "b"}, {"b", "c"}});
+  EXPECT_EQ("bc", replacer.replace("ab"));
+}
+
+TEST(TextReplacerTest, ReplaceWithFormat) {
+  TextReplacer replacer({{"(\\w+)_key_(\\w+)", ""}});
+  EXPECT_EQ("x.y + x.z", replacer.replace("x_key_y + x_key_z", "$1.$2"));
+}
+
+}  // namespace tool
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
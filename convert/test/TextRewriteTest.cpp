@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "../TextRewrite.h"
+
+namespace ks {
+namespace ad_algorithm {
+namespace convert {
+namespace tool {
+
+namespace {
+
+/// 以下是改为 TextReplacer 之前依次调用 std::regex_replace 的实现，作为对比。
+std::string regex_replace_feature_text(const std::string& content, const std::string& class_name) {
+  std::string s = std::regex_replace(content, std::regex(class_name), std::string("BS") + class_name);
+  s = std::regex_replace(s, std::regex("class (Extract.*) ?: ?public"), "class BS$1: public");
+  s = std::regex_replace(s, std::regex("\n *;"), "");
+  s = std::regex_replace(s, std::regex(": *;"), ";");
+  s = std::regex_replace(s, std::regex("const AdLog ?\\& ?(adlog|ad_log)"), "const BSLog& bslog");
+  s = std::regex_replace(s, std::regex("FastFeature"), "BSFastFeature");
+  s = std::regex_replace(s, std::regex("REGISTER_EXTRACTOR"), "REGISTER_BS_EXTRACTOR");
+  s = std::regex_replace(s, std::regex("REGISTER_SEQUENCE_EXTRACTOR"), "REGISTER_BS_SEQUENCE_EXTRACTOR");
+  s = std::regex_replace(s, std::regex("using Extract"), "using BSExtract");
+  s = std::regex_replace(s, std::regex("EXTRACTOR\\(Extract"), "EXTRACTOR(BSExtract");
+  s = std::regex_replace(s,
+                         std::regex("(::)?auto_cpp_rewriter::AdCallbackLog"),
+                         "::bs::auto_cpp_rewriter::AdCallbackLog");
+  s = std::regex_replace(s,
+                         std::regex("(::)?auto_cpp_rewriter::CommonInfoAttr"),
+                         "::bs::auto_cpp_rewriter::CommonInfoAttr");
+  s = std::regex_replace(s, std::regex("template ?<ItemType"), "template<bs::ItemType");
+  s = std::regex_replace(s,
+                         std::regex("ExtractMultiAttrBSFastFeatureNoPrefix"),
+                         "BSExtractMultiAttrFastFeatureNoPrefix");
+
+  if (s.find("include<") != std::string::npos ||
+      s.find("include <") != std::string::npos ||
+      s.find("std::string") != std::string::npos) {
+    return s;
+  }
+
+  return std::regex_replace(s, std::regex("([ <]?)string([ >,])"), "$1std::string$2");
+}
+
+std::string regex_replace_infer_filter_text(const std::string& content) {
+  std::string s = std::regex_replace(content, std::regex("ItemFilter"), "BSItemFilter");
+  s = std::regex_replace(s, std::regex("BSFieldEnum::item"), "BSFieldEnum::adlog_item");
+  s = std::regex_replace(s, std::regex("\\(\\*bs"), "(bs");
+  return std::regex_replace(s, std::regex("static inline bool"), "static bool");
+}
+
+std::string regex_rm_continue_break(const std::string& s) {
+  std::string res = std::regex_replace(s, std::regex("continue ?;"), "");
+  return std::regex_replace(res, std::regex("break ?;"), "");
+}
+
+std::string regex_replace_simple_text(const std::string& s) {
+  std::string s1 = std::regex_replace(s, std::regex("_Bool"), "bool");
+  return std::regex_replace(s1, std::regex("\n *;"), "");
+}
+
+/// 规则的片段以及替换结果的片段，随机拼接后能覆盖规则之间相互影响的情况。
+const std::vector<std::string>& tokens() {
+  static const std::vector<std::string> res = {
+    " ", "  ", "\n", "\n ", ";", ":", "::", ": ", "<", ">", ",", "(", ")", "*", "&", "&",
+    "class ", "class", "Extract", "ExtractUserId", "UserId", "public", "BS", "BSExtract",
+    "const AdLog", "AdLog", "const ", "adlog", "ad_log", "bslog",
+    "FastFeature", "BSFastFeature", "Fast", "Feature", "ExtractMultiAttr", "MultiAttr", "NoPrefix",
+    "ExtractMultiAttrFastFeatureNoPrefix", "ExtractMultiAttrBSFastFeatureNoPrefix",
+    "REGISTER_", "REGISTER_EXTRACTOR", "REGISTER_SEQUENCE_EXTRACTOR", "SEQUENCE_", "EXTRACTOR", "EXTRACTOR(",
+    "using ", "using", "auto_cpp_rewriter", "auto_cpp_rewriter::", "AdCallbackLog", "CommonInfoAttr", "bs::",
+    "template", "template ", "<ItemType", "ItemType", "string", "std::string", "include <",
+    "ItemFilter", "BSFieldEnum::item", "BSFieldEnum::", "item", "Filter", "(*bs", "(*", "bs",
+    "static inline bool", "static ", "inline ", "bool",
+    "continue", "continue;", "brea", "break", "k;", "break ;", "cont", "inue;",
+    "_Bool", "_B", "ool",
+  };
+
+  return res;
+}
+
+std::string gen_text(std::mt19937* rng) {
+  std::uniform_int_distribution<size_t> len_dist(0, 16);
+  std::uniform_int_distribution<size_t> token_dist(0, tokens().size() - 1);
+
+  std::string s;
+  size_t len = len_dist(*rng);
+  for (size_t i = 0; i < len; i++) {
+    s += tokens()[token_dist(*rng)];
+  }
+
+  return s;
+}
+
+}  // namespace
+
+TEST(TextRewriteTest, ReplaceFeatureText) {
+  std::mt19937 rng(20261017);
+  for (int i = 0; i < 100000; i++) {
+    std::string s = gen_text(&rng);
+    ASSERT_EQ(regex_replace_feature_text(s, "ExtractUserId"), replace_feature_text(s, "ExtractUserId"))
+      << "text: " << s;
+  }
+}
+
+TEST(TextRewriteTest, ReplaceFeatureTextExample) {
+  std::string s =
+    "#include \"teams/ad/ad_algorithm/feature/fast/frame/fast_feature.h\"\n"
+    "class ExtractUserId : public FastFeature {\n"
+    " public:\n"
+    "  void Extract(const AdLog & adlog, size_t pos, std::vector<ExtractResult>* result) {\n"
+    "    x:\n ;;\n"
+    "  }\n"
+    "};\n"
+    "REGISTER_EXTRACTOR(ExtractUserId);\n"
+    "using ExtractMultiAttrFastFeatureNoPrefix = int;\n";
+
+  EXPECT_EQ(regex_replace_feature_text(s, "ExtractUserId"), replace_feature_text(s, "ExtractUserId"));
+}
+
+TEST(TextRewriteTest, ReplaceInferFilterText) {
+  std::mt19937 rng(20261017);
+  for (int i = 0; i < 100000; i++) {
+    std::string s = gen_text(&rng);
+    ASSERT_EQ(regex_replace_infer_filter_text(s), replace_infer_filter_text(s)) << "text: " << s;
+  }
+}
+
+TEST(TextRewriteTest, RmContinueBreak) {
+  std::mt19937 rng(20261017);
+  for (int i = 0; i < 100000; i++) {
+    std::string s = gen_text(&rng);
+    ASSERT_EQ(regex_rm_continue_break(s), rm_continue_break(s)) << "text: " << s;
+  }
+
+  EXPECT_EQ("", rm_continue_break("breacontinue;k;"));
+}
+
+TEST(TextRewriteTest, ReplaceSimpleText) {
+  std::mt19937 rng(20261017);
+  for (int i = 0; i < 100000; i++) {
+    std::string s = gen_text(&rng);
+    ASSERT_EQ(regex_replace_simple_text(s), replace_simple_text(s)) << "text: " << s;
+  }
+}
+
+}  // namespace tool
+}  // namespace convert
+}  // namespace ad_algorithm
+}  // namespace ks
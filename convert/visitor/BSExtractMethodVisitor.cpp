@@ -7,6 +7,8 @@
 #include <sstream>
 #include "../Env.h"
 #include "../Tool.h"
+#include "../ExprInfoArena.h"
+#include "../handler/EditLedger.h"
 #include "../handler/LogicHandler.h"
 #include "../handler/BSFieldHandler.h"
 #include "./BSExtractMethodVisitor.h"
@@ -21,6 +23,9 @@ using tool::insert_str_after_bs_equal_end;
 
 json BSExtractMethodVisitor::visit(const clang::CXXMethodDecl* cxx_method_decl,
                                     FeatureInfo* feature_info_ptr) {
+  // 该方法中解析的 ExprInfo 在方法处理完后统一释放, 必须在 Handler 之前定义。
+  ExprInfoArenaScope expr_info_arena_scope;
+
   auto config = GlobalConfig::Instance();
 
   std::string method_name = cxx_method_decl->getNameAsString();
@@ -45,6 +50,9 @@ json BSExtractMethodVisitor::visit(const clang::CXXMethodDecl* cxx_method_decl,
 
   clang::Stmt *body = cxx_method_decl->getBody();
 
+  // 记录该方法中所有规则的改写，检查规则之间的冲突。
+  EditLedgerScope edit_ledger_scope(method_name);
+
   BSFieldHandler bs_field_handler(rewriter_);
   recursive_visit(body, &bs_field_handler, &env);
 
@@ -15,6 +15,7 @@
 #include "clang/Basic/SourceLocation.h"
 
 #include "../Env.h"
+#include "../TextReplacer.h"
 
 namespace ks {
 namespace ad_algorithm {
@@ -138,15 +139,15 @@ json BSExtractMethodVisitor::recursive_visit(
 
     std::string op = stmt_to_string(cxx_operator_call_expr->getCallee());
     json root = json::array();
-    static std::regex p("operator");
+    static const tool::TextReplacer replacer({{"operator", ""}});
 
     if (op == "operator=") {
       // root = std::move(std::make_unique<AssignOp>());
     } else if (op == "operator==" || op == "operator<" || op == "operator>"
                || op == "operator<=" || op == "operator>=") {
-      root = json::array({std::regex_replace(op, p, "")});
+      root = json::array({replacer.replace(op)});
     } else if (op == "operator+" || op == "operator-" || op == "operator*" || op == "operator/") {
-      root = json::array({std::regex_replace(op, p, "")});
+      root = json::array({replacer.replace(op)});
     } else if (op == "operator()") {
       // 通过 CXXOperatorCallExpr 无法判断，只能通过字符串判断是否是 bs 中间节点函数。
       if (absl::StartsWith(stmt_str, "this->bs_util") || absl::StartsWith(stmt_str, "BS")) {
@@ -1,11 +1,12 @@
 #include <ostream>
-#include <regex>
 #include <glog/logging.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 #include <sstream>
 #include "../Env.h"
 #include "../Tool.h"
+#include "../ExprInfoArena.h"
+#include "../handler/EditLedger.h"
 #include "../handler/OverviewHandler.h"
 #include "../handler/AdlogFieldHandler.h"
 #include "ExtractMethodVisitor.h"
@@ -15,6 +16,9 @@ namespace ad_algorithm {
 namespace convert {
 
 void ExtractMethodVisitor::visit(const clang::CXXMethodDecl* cxx_method_decl, FeatureInfo* feature_info_ptr) {
+  // 该方法中解析的 ExprInfo 在方法处理完后统一释放, 必须在 Handler 之前定义。
+  ExprInfoArenaScope expr_info_arena_scope;
+
   auto config = GlobalConfig::Instance();
 
   std::string method_name = cxx_method_decl->getNameAsString();
@@ -34,6 +38,9 @@ void ExtractMethodVisitor::visit(const clang::CXXMethodDecl* cxx_method_decl, Fe
     return;
   }
 
+  // 记录该方法中所有规则的改写，检查规则之间的冲突。
+  EditLedgerScope edit_ledger_scope(method_name);
+
   StrictRewriter strict_rewriter(rewriter_);
   // LazyReplace 里会保存 Env*, 所以 Handler 必须是局部变量，否则会 core
   AdlogFieldHandler adlog_field_handler(rewriter_);
@@ -98,15 +105,15 @@ void ExtractMethodVisitor::visit(const clang::CXXMethodDecl* cxx_method_decl, Fe
                << env.get_all_new_defs()
                << "\n";
 
-      std::regex p_bs("if (bs == nullptr) \\{[\\s\\S.]*?\\}");
-      reco_body_str = std::regex_replace(reco_body_str, p_bs, oss_reco.str());
+      static const tool::TextReplacer replacer_bs({{"if (bs == nullptr) \\{[\\s\\S.]*?\\}", ""}});
+      reco_body_str = replacer_bs.replace(reco_body_str, oss_reco.str());
 
       feature_info.set_reco_extract_body(reco_body_str);
 
       std::string normal_body_str = feature_info.extract_method_content();
 
-      std::regex p("(adlog\\.|ad_log\\.)");
-      normal_body_str = std::regex_replace(normal_body_str, p, "bslog.");
+      static const tool::TextReplacer replacer({{"(adlog\\.|ad_log\\.)", "bslog."}});
+      normal_body_str = replacer.replace(normal_body_str);
 
       size_t pos = normal_body_str.find("{");
       if (pos != std::string::npos) {
@@ -464,7 +471,8 @@ void ExtractMethodVisitor::process_update_action(StrictRewriter* rewriter_ptr, E
     if (update_action_stmt != nullptr) {
       std::vector<std::string> arr = absl::StrSplit(stmt_to_string(update_action_stmt), "=");
       if (arr.size() == 2) {
-        std::string x = std::regex_replace(arr[1], std::regex(" "), "");
+        static const tool::TextReplacer replacer_space({{" ", ""}});
+        std::string x = replacer_space.replace(arr[1]);
         if (is_integer(x)) {
           int action = std::stoi(x);
           LOG(INFO) << "find action: " << action